@@ -0,0 +1,112 @@
+/**
+ * Microbenchmark for NumberFormat.h against the formatting it replaced.
+ *
+ * Formats telemetry-like doubles (altitudes, accelerations, small angles) at
+ * precision 3 with each method and prints the mean time per value. It also
+ * checks that formatFixed() matches snprintf("%.*f") on every value.
+ *
+ * Build and run from the repo root (not part of the PlatformIO library):
+ *
+ *   g++ -std=c++17 -O2 -DNATIVE=1 -Inative-support/include \
+ *       native-support/bench/number_format_bench.cpp \
+ *       native-support/src/Arduino.cpp native-support/src/Print.cpp \
+ *       native-support/src/SITLSocket.cpp -o number_format_bench
+ *   ./number_format_bench [values] [precision]
+ */
+
+#include "Arduino.h"
+#include "NumberFormat.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+// Counts bytes so the formatting cannot be optimized away.
+class NullPrint : public Print
+{
+public:
+    size_t bytes = 0;
+    size_t write(uint8_t) override { return ++bytes, 1; }
+    size_t write(const uint8_t *, size_t n) override { return bytes += n, n; }
+};
+
+std::vector<double> telemetryValues(size_t count)
+{
+    std::mt19937_64 rng(20240611);
+    std::normal_distribution<double> accel(0.0, 30.0);
+    std::uniform_real_distribution<double> altitude(-5.0, 3500.0);
+    std::uniform_real_distribution<double> angle(-3.2, 3.2);
+    std::vector<double> values;
+    values.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        switch (i % 3)
+        {
+        case 0: values.push_back(altitude(rng)); break;
+        case 1: values.push_back(accel(rng)); break;
+        default: values.push_back(angle(rng)); break;
+        }
+    }
+    return values;
+}
+
+template <typename Fn>
+void run(const char *name, const std::vector<double> &values, Fn &&format)
+{
+    size_t sink = 0;
+    for (double value : values) // warm-up
+        sink += format(value);
+    const int rounds = 5;
+    const auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round)
+        for (double value : values)
+            sink += format(value);
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%-28s %8.1f ns/value  (%zu bytes)\n", name, ns / (rounds * values.size()), sink);
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 35000;
+    const int precision = argc > 2 ? std::atoi(argv[2]) : 3;
+    const std::vector<double> values = telemetryValues(count);
+
+    size_t mismatches = 0;
+    for (double value : values)
+    {
+        char expected[NUMBER_FORMAT_BUFFER_SIZE];
+        char actual[NUMBER_FORMAT_BUFFER_SIZE];
+        const int n = std::snprintf(expected, sizeof(expected), "%.*f", precision, value);
+        const size_t m = formatFixed(actual, value, precision);
+        mismatches += static_cast<size_t>(n) != m || std::memcmp(expected, actual, m) != 0;
+    }
+    std::printf("%zu values, precision %d, %zu mismatches against snprintf\n\n", count, precision, mismatches);
+
+    run("snprintf(\"%.*f\")", values, [&](double value)
+        {
+            char buf[NUMBER_FORMAT_BUFFER_SIZE];
+            return static_cast<size_t>(std::snprintf(buf, sizeof(buf), "%.*f", precision, value)); });
+    run("ostringstream (old String)", values, [&](double value)
+        {
+            std::ostringstream out;
+            out << std::fixed << std::setprecision(precision) << value;
+            return out.str().size(); });
+    run("formatFixed", values, [&](double value)
+        {
+            char buf[NUMBER_FORMAT_BUFFER_SIZE];
+            return formatFixed(buf, value, precision); });
+    NullPrint print;
+    run("Print::print(double)", values, [&](double value)
+        { return print.print(value, precision); });
+    run("String(double)", values, [&](double value)
+        { return String(value, static_cast<unsigned char>(precision)).length(); });
+    return mismatches == 0 ? 0 : 1;
+}
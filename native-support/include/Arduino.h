@@ -6,9 +6,14 @@
 #include <cstdint>
 #include <cstdio>
 #include <cmath>
+#include <string>
+// <chrono>, <iomanip> and <sstream> are only needed by the .cpp files; define this
+// for sketches that relied on Arduino.h pulling them in.
+#ifdef NATIVE_ARDUINO_FULL_INCLUDES
 #include <chrono>
 #include <iomanip>
 #include <sstream>
+#endif
 #else
 #include <stdint.h>
 #include <stdio.h>
@@ -19,6 +24,9 @@
 #include <stdarg.h>
 #include "Wire.h"
 #include "Print.h"
+#include "SerialCapture.h"
+#include "UartModel.h"
+#include "SitlSequencer.h"
 #define SS 10 // random ass numbers lol
 
 #define HIGH 1
@@ -131,17 +139,11 @@ void clearMockAnalogReads();
 // Forward declaration for SITL support
 class SITLSocket;
 
-// Arduino String class
-#include <string>
+// Arduino String class (number parsing and float formatting live in Arduino.cpp)
 class String {
 private:
     std::string str;
-    template <typename T>
-    static std::string formatFloat(T value, unsigned int digits) {
-        std::ostringstream stream;
-        stream << std::fixed << std::setprecision(static_cast<int>(digits)) << value;
-        return stream.str();
-    }
+    static std::string formatFloat(double value, unsigned int digits);
 public:
     String() : str("") {}
     String(const char* s) : str(s ? s : "") {}
@@ -150,9 +152,9 @@ public:
     String(unsigned int n) : str(std::to_string(n)) {}
     String(long n) : str(std::to_string(n)) {}
     String(unsigned long n) : str(std::to_string(n)) {}
-    String(float f) : str(std::to_string(f)) {}
+    String(float f) : str(formatFloat(f, 6)) {}
     String(float f, unsigned int digits) : str(formatFloat(f, digits)) {}
-    String(double d) : str(std::to_string(d)) {}
+    String(double d) : str(formatFloat(d, 6)) {}
     String(double d, unsigned int digits) : str(formatFloat(d, digits)) {}
 
     const char* c_str() const { return str.c_str(); }
@@ -173,24 +175,10 @@ public:
     String substring(int start, int end) const {
         return String(str.substr(start, end - start));
     }
-    void trim() {
-        size_t first = str.find_first_not_of(" \t\r\n");
-        if (std::string::npos == first) {
-            str = "";
-        } else {
-            size_t last = str.find_last_not_of(" \t\r\n");
-            str = str.substr(first, (last - first + 1));
-        }
-    }
-    long toInt() const {
-        try { return std::stol(str); } catch (...) { return 0; }
-    }
-    float toFloat() const {
-        try { return std::stof(str); } catch (...) { return 0.0f; }
-    }
-    double toDouble() const {
-        try { return std::stod(str); } catch (...) { return 0.0; }
-    }
+    void trim();
+    long toInt() const;
+    float toFloat() const;
+    double toDouble() const;
     
     String& operator+=(char c) {
         str += c;
@@ -209,7 +197,7 @@ public:
 class Stream : public Print
 {
 public:
-    Stream() = default;
+    Stream() : outputCapture(fakeBuffer, sizeof(fakeBuffer), cursor) {}
     ~Stream();
     void begin(int baud = 9600);
     void end();
@@ -223,13 +211,9 @@ public:
     size_t readBytes(char *buf, size_t len);
     size_t readBytes(uint8_t *buf, size_t len);
     size_t write(uint8_t b) override;
-    size_t write(const uint8_t *buf, size_t len) {  // Add buffer write
-        size_t written = 0;
-        for (size_t i = 0; i < len; i++) {
-            written += write(buf[i]);
-        }
-        return written;
-    }
+    size_t write(const uint8_t *buf, size_t len) override;
+    size_t writev(const WriteSlice *slices, size_t count) override;
+    using Print::write;
     
     String readString() {
         String ret = "";
@@ -253,6 +237,20 @@ public:
     void disconnectSITL();
     bool isSITLConnected() const;
 
+    // UART bandwidth/FIFO model (off by default: unlimited bandwidth)
+    void configureUart(const UartModel::Config &config) { uart.configure(config, baudRate); }
+    void disableUart() { uart.disable(); }
+    int availableForWrite();
+    const UartModel::Stats &uartStats() const { return uart.stats(); }
+    void resetUartStats() { uart.reset(); }
+
+    // Outbound capture (default Prefix: the first bytes land in fakeBuffer)
+    void setCapture(SerialCapture::Mode mode, size_t ringBytes = SerialCapture::DEFAULT_RING_BYTES) { outputCapture.setMode(mode, ringBytes); }
+    SerialCapture &capture() { return outputCapture; }
+    const SerialCapture &capture() const { return outputCapture; }
+    std::string captured() const { return outputCapture.snapshot(); }
+    void clearCapture() { outputCapture.clear(); }
+
     char fakeBuffer[1000];
     int cursor = 0;
     // Input buffer for read operations
@@ -262,9 +260,17 @@ public:
 
 private:
     int timedRead();
+    SerialCapture outputCapture;
+    UartModel uart;
+    unsigned long baudRate = 9600;
+    size_t uartAcceptTx(size_t len);  // Applies the UART model; returns bytes accepted
     SITLSocket* sitlSocket = nullptr;  // TCP connection to external simulator
     unsigned long timeoutMs = 1000;
     void pollSITLInput();  // Poll for incoming data from simulator
+    void appendSITLInput(const uint8_t *data, size_t len);
+    void sendSequenced(const WriteSlice *slices, size_t count);
+    void forwardSlices(const WriteSlice *slices, size_t count);  // Capture + send, no UART model
+    SitlSequencer sitlSequencer;  // "@<seq>|" envelopes for windowed sims
 };
 
 
@@ -0,0 +1,200 @@
+#ifndef NATIVE_HITL_PACKETS_H
+#define NATIVE_HITL_PACKETS_H
+
+#ifdef __cplusplus
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * HitlPacketParser: receiving side of the simulator's sensor packets.
+ *
+ * `sim run --sensor-rates` sends one line per sensor, each at its own rate:
+ *   HITL/IMU/<t>,ax,ay,az,gx,gy,gz,mx,my,mz
+ *   HITL/BARO/<t>,pressure,temp
+ *   HITL/GPS/<t>,lat,lon,alt,fix,sats,heading
+ * Without it every packet is one combined line carrying all three:
+ *   HITL/<t>,ax,ay,az,gx,gy,gz,mx,my,mz,pressure,temp,lat,lon,alt,fix,sats,heading
+ *
+ * parse() accepts both. It only touches the fields of the sensors named in the
+ * line and records them as fresh, so firmware can update each sensor when it has
+ * new data instead of on every packet. Lines with the wrong field count or a
+ * field that is not a number are rejected without changing any sample.
+ */
+class HitlPacketParser
+{
+public:
+    enum Sensor : uint8_t
+    {
+        NONE = 0,
+        IMU = 1,
+        BARO = 2,
+        GPS = 4,
+        ALL = IMU | BARO | GPS,
+    };
+
+    struct ImuSample
+    {
+        double time = 0;
+        double accel[3] = {}; // m/s^2, specific force
+        double gyro[3] = {};  // rad/s
+        double mag[3] = {};   // uT
+    };
+
+    struct BaroSample
+    {
+        double time = 0;
+        double pressure = 0; // hPa
+        double temp = 0;     // C
+    };
+
+    struct GpsSample
+    {
+        double time = 0;
+        double lat = 0;
+        double lon = 0;
+        double alt = 0; // m
+        int fix = 0;
+        int sats = 0;
+        double heading = 0; // deg
+    };
+
+    // Parses one line (trailing "\r\n" optional). Returns the sensors it updated,
+    // NONE for anything that is not a well-formed HITL data line.
+    uint8_t parse(const char *line, size_t n)
+    {
+        while (n > 0 && (line[n - 1] == '\n' || line[n - 1] == '\r'))
+            n--;
+        if (!startsWith(line, n, "HITL/"))
+            return NONE;
+        line += 5;
+        n -= 5;
+
+        double v[18];
+        uint8_t sensors;
+        if (startsWith(line, n, "IMU/"))
+        {
+            if (!parseFields(line + 4, n - 4, v, 10))
+                return NONE;
+            setImu(v);
+            sensors = IMU;
+        }
+        else if (startsWith(line, n, "BARO/"))
+        {
+            if (!parseFields(line + 5, n - 5, v, 3))
+                return NONE;
+            setBaro(v[0], v + 1);
+            sensors = BARO;
+        }
+        else if (startsWith(line, n, "GPS/"))
+        {
+            if (!parseFields(line + 4, n - 4, v, 7))
+                return NONE;
+            setGps(v[0], v + 1);
+            sensors = GPS;
+        }
+        else
+        {
+            if (!parseFields(line, n, v, 18))
+                return NONE;
+            setImu(v);
+            setBaro(v[0], v + 10);
+            setGps(v[0], v + 12);
+            sensors = ALL;
+        }
+        fresh_ |= sensors;
+        for (int i = 0; i < 3; i++)
+            if (sensors & (1 << i))
+                counts_[i]++;
+        return sensors;
+    }
+
+    uint8_t parse(const char *line) { return parse(line, std::strlen(line)); }
+
+    // Sensors updated since the last call, then cleared.
+    uint8_t takeFresh()
+    {
+        const uint8_t fresh = fresh_;
+        fresh_ = NONE;
+        return fresh;
+    }
+
+    uint8_t fresh() const { return fresh_; }
+
+    const ImuSample &imu() const { return imu_; }
+    const BaroSample &baro() const { return baro_; }
+    const GpsSample &gps() const { return gps_; }
+
+    // Lines accepted for one sensor (IMU, BARO or GPS) since construction.
+    uint32_t count(Sensor sensor) const
+    {
+        return sensor == IMU ? counts_[0] : sensor == BARO ? counts_[1] : sensor == GPS ? counts_[2] : 0;
+    }
+
+private:
+    ImuSample imu_;
+    BaroSample baro_;
+    GpsSample gps_;
+    uint8_t fresh_ = NONE;
+    uint32_t counts_[3] = {};
+
+    static bool startsWith(const char *s, size_t n, const char *prefix)
+    {
+        const size_t len = std::strlen(prefix);
+        return n >= len && std::memcmp(s, prefix, len) == 0;
+    }
+
+    // Exactly `count` comma-separated numbers.
+    static bool parseFields(const char *p, size_t n, double *out, int count)
+    {
+        const char *end = p + n;
+        for (int i = 0; i < count; i++)
+        {
+            const std::from_chars_result result = std::from_chars(p, end, out[i]);
+            if (result.ec != std::errc() || result.ptr == p)
+                return false;
+            p = result.ptr;
+            if (i + 1 < count)
+            {
+                if (p == end || *p != ',')
+                    return false;
+                p++;
+            }
+        }
+        return p == end;
+    }
+
+    void setImu(const double *v)
+    {
+        imu_.time = v[0];
+        for (int i = 0; i < 3; i++)
+        {
+            imu_.accel[i] = v[1 + i];
+            imu_.gyro[i] = v[4 + i];
+            imu_.mag[i] = v[7 + i];
+        }
+    }
+
+    void setBaro(double time, const double *v)
+    {
+        baro_.time = time;
+        baro_.pressure = v[0];
+        baro_.temp = v[1];
+    }
+
+    void setGps(double time, const double *v)
+    {
+        gps_.time = time;
+        gps_.lat = v[0];
+        gps_.lon = v[1];
+        gps_.alt = v[2];
+        gps_.fix = static_cast<int>(v[3]);
+        gps_.sats = static_cast<int>(v[4]);
+        gps_.heading = v[5];
+    }
+};
+
+#endif // __cplusplus
+
+#endif // NATIVE_HITL_PACKETS_H
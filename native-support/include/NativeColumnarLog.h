@@ -0,0 +1,346 @@
+#pragma once
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <RecordData/Logging/LoggingBackend/ILogSink.h>
+
+/**
+ * NativeColumnarLog: ILogSink that stores CSV telemetry as compact column blocks.
+ *
+ * The first line written (optionally prefixed with "TELEM/") is taken as the
+ * schema. Following rows are buffered and written every `blockRows` rows, and
+ * once more by end(), as one block per column. flush() only pushes blocks
+ * already encoded to the file; a block per flush would defeat the encoding.
+ * Each column is stored as follows:
+ *   - fixed-point decimals ("12.370", "-4", ...) as delta + zigzag varints of the
+ *     scaled integer, so integers are just decimals with scale 0
+ *   - other numbers as varints of the XOR with the previous value's bits
+ *   - anything else as length-prefixed strings
+ *
+ * See docs/columnar-log-format.md for the byte layout and
+ * astra_support.sim.columnar for the Python reader.
+ */
+class NativeColumnarLog : public astra::ILogSink
+{
+public:
+    static constexpr size_t DEFAULT_BLOCK_ROWS = 1024;
+
+    explicit NativeColumnarLog(std::string path, size_t blockRows = DEFAULT_BLOCK_ROWS)
+        : path_(std::move(path)), blockRows_(blockRows ? blockRows : DEFAULT_BLOCK_ROWS) {}
+    ~NativeColumnarLog() { end(); }
+
+    NativeColumnarLog(const NativeColumnarLog &) = delete;
+    NativeColumnarLog &operator=(const NativeColumnarLog &) = delete;
+
+    bool begin() override
+    {
+        end();
+        file_ = fopen(path_.c_str(), "wb");
+        if (file_)
+            setvbuf(file_, nullptr, _IOFBF, 256 * 1024);
+        names_.clear();
+        cells_.clear();
+        line_.clear();
+        rows_ = 0;
+        skippedRows_ = 0;
+        return file_ != nullptr;
+    }
+
+    bool end() override
+    {
+        if (!file_)
+            return true;
+        writeBlock();
+        fclose(file_);
+        file_ = nullptr;
+        return true;
+    }
+
+    bool ok() const override { return file_ != nullptr && !ferror(file_); }
+
+    bool wantsPrefix() const override { return false; }
+
+    void flush() override
+    {
+        if (file_)
+            fflush(file_);
+    }
+
+    size_t write(uint8_t b) override { return write(&b, 1); }
+
+    size_t write(const uint8_t *buf, size_t n) override
+    {
+        if (!file_)
+            return 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            const char c = static_cast<char>(buf[i]);
+            if (c == '\n')
+            {
+                consumeLine();
+                line_.clear();
+            }
+            else if (c != '\r')
+            {
+                line_ += c;
+            }
+        }
+        return n;
+    }
+
+    using Print::write; // keep other Print overloads visible
+
+    const std::vector<std::string> &columns() const { return names_; }
+    size_t rows() const { return rows_; }
+    // Rows whose column count did not match the schema.
+    size_t skippedRows() const { return skippedRows_; }
+
+private:
+    enum : uint8_t
+    {
+        COL_DECIMAL = 1,
+        COL_FLOAT = 2,
+        COL_STRING = 3,
+    };
+
+    static constexpr int MAX_DECIMAL_DIGITS = 18;
+
+    std::string path_;
+    size_t blockRows_;
+    FILE *file_ = nullptr;
+    std::string line_;
+    std::vector<std::string> names_;
+    std::vector<std::vector<std::string>> cells_; // [column][row] for the pending block
+    std::vector<uint8_t> payload_;
+    size_t pending_ = 0;
+    size_t rows_ = 0;
+    size_t skippedRows_ = 0;
+
+    static void splitCsv(const char *text, std::vector<std::string> &out)
+    {
+        out.clear();
+        const char *start = text;
+        for (const char *p = text;; ++p)
+        {
+            if (*p == ',' || *p == '\0')
+            {
+                out.emplace_back(start, static_cast<size_t>(p - start));
+                if (*p == '\0')
+                    break;
+                start = p + 1;
+            }
+        }
+    }
+
+    void consumeLine()
+    {
+        const char *text = line_.c_str();
+        if (std::strncmp(text, "TELEM/", 6) == 0)
+            text += 6;
+        if (*text == '\0')
+            return;
+
+        if (names_.empty())
+        {
+            splitCsv(text, names_);
+            for (std::string &name : names_)
+                trim(name);
+            cells_.assign(names_.size(), {});
+            writeHeader();
+            return;
+        }
+
+        static thread_local std::vector<std::string> row;
+        splitCsv(text, row);
+        if (row.size() != names_.size())
+        {
+            ++skippedRows_;
+            return;
+        }
+        for (size_t col = 0; col < row.size(); ++col)
+        {
+            trim(row[col]);
+            cells_[col].push_back(std::move(row[col]));
+        }
+        ++pending_;
+        ++rows_;
+        if (pending_ >= blockRows_)
+            writeBlock();
+    }
+
+    static void trim(std::string &s)
+    {
+        size_t first = s.find_first_not_of(" \t");
+        size_t last = s.find_last_not_of(" \t");
+        s = first == std::string::npos ? std::string() : s.substr(first, last - first + 1);
+    }
+
+    // Parses "[-+]digits[.digits]" into an exact scaled integer.
+    static bool parseDecimal(const std::string &s, int64_t &mantissa, int &scale)
+    {
+        size_t i = 0;
+        bool negative = false;
+        if (i < s.size() && (s[i] == '-' || s[i] == '+'))
+            negative = s[i++] == '-';
+        int digits = 0;
+        bool seenPoint = false;
+        bool seenDigit = false;
+        int64_t value = 0;
+        scale = 0;
+        for (; i < s.size(); ++i)
+        {
+            const char c = s[i];
+            if (c == '.' && !seenPoint)
+            {
+                seenPoint = true;
+                continue;
+            }
+            if (c < '0' || c > '9')
+                return false;
+            seenDigit = true;
+            if (++digits > MAX_DECIMAL_DIGITS)
+                return false;
+            value = value * 10 + (c - '0');
+            if (seenPoint)
+                ++scale;
+        }
+        mantissa = negative ? -value : value;
+        // "-0" and "-0.00" would decode as +0; the float column keeps the sign.
+        return seenDigit && !(negative && value == 0);
+    }
+
+    static bool parseNumber(const std::string &s, double &value)
+    {
+        if (s.empty())
+        {
+            value = NAN;
+            return true;
+        }
+        char *end = nullptr;
+        value = std::strtod(s.c_str(), &end);
+        return end == s.c_str() + s.size();
+    }
+
+    void putVarint(uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            payload_.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        payload_.push_back(static_cast<uint8_t>(value));
+    }
+
+    void writeVarint(uint64_t value)
+    {
+        uint8_t buf[10];
+        size_t n = 0;
+        while (value >= 0x80)
+        {
+            buf[n++] = static_cast<uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        buf[n++] = static_cast<uint8_t>(value);
+        fwrite(buf, 1, n, file_);
+    }
+
+    void writeHeader()
+    {
+        fwrite("ASTRACOL", 1, 8, file_);
+        fputc(1, file_); // format version
+        writeVarint(names_.size());
+        for (const std::string &name : names_)
+        {
+            writeVarint(name.size());
+            fwrite(name.data(), 1, name.size(), file_);
+        }
+    }
+
+    uint8_t encodeColumn(const std::vector<std::string> &cells, uint8_t &scaleOut)
+    {
+        static const int64_t POW10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+                                        1000000000, 10000000000LL, 100000000000LL, 1000000000000LL,
+                                        10000000000000LL, 100000000000000LL, 1000000000000000LL,
+                                        10000000000000000LL, 100000000000000000LL, 1000000000000000000LL};
+        payload_.clear();
+
+        // Fixed-point decimals: scale every value to the block's widest scale.
+        std::vector<int64_t> mantissas(cells.size());
+        std::vector<int> scales(cells.size());
+        bool decimal = true;
+        int maxScale = 0;
+        for (size_t i = 0; i < cells.size() && decimal; ++i)
+        {
+            decimal = parseDecimal(cells[i], mantissas[i], scales[i]);
+            if (scales[i] > maxScale)
+                maxScale = scales[i];
+        }
+        for (size_t i = 0; i < cells.size() && decimal; ++i)
+        {
+            const int64_t factor = POW10[maxScale - scales[i]];
+            const int64_t limit = POW10[MAX_DECIMAL_DIGITS] / factor;
+            if (mantissas[i] >= limit || mantissas[i] <= -limit)
+                decimal = false;
+            else
+                mantissas[i] *= factor;
+        }
+        if (decimal)
+        {
+            int64_t previous = 0;
+            for (int64_t mantissa : mantissas)
+            {
+                const int64_t delta = mantissa - previous;
+                putVarint((static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63));
+                previous = mantissa;
+            }
+            scaleOut = static_cast<uint8_t>(maxScale);
+            return COL_DECIMAL;
+        }
+
+        std::vector<double> values(cells.size());
+        bool numeric = true;
+        for (size_t i = 0; i < cells.size() && numeric; ++i)
+            numeric = parseNumber(cells[i], values[i]);
+        if (numeric)
+        {
+            uint64_t previous = 0;
+            for (double value : values)
+            {
+                uint64_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                putVarint(bits ^ previous);
+                previous = bits;
+            }
+            return COL_FLOAT;
+        }
+
+        for (const std::string &cell : cells)
+        {
+            putVarint(cell.size());
+            payload_.insert(payload_.end(), cell.begin(), cell.end());
+        }
+        return COL_STRING;
+    }
+
+    void writeBlock()
+    {
+        if (!file_ || pending_ == 0)
+            return;
+        writeVarint(pending_);
+        for (std::vector<std::string> &cells : cells_)
+        {
+            uint8_t scale = 0;
+            const uint8_t type = encodeColumn(cells, scale);
+            fputc(type, file_);
+            if (type == COL_DECIMAL)
+                fputc(scale, file_);
+            writeVarint(payload_.size());
+            fwrite(payload_.data(), 1, payload_.size(), file_);
+            cells.clear();
+        }
+        pending_ = 0;
+    }
+};
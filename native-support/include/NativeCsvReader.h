@@ -0,0 +1,468 @@
+#pragma once
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NATIVE_CSV_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define NATIVE_CSV_NEON 1
+#endif
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * NativeCsvReader: fast reader for the numeric flight CSVs in datasets/, for
+ * native replay, trace-driven fakes and benchmarks.
+ *
+ * The file is memory-mapped (read into memory on Windows) and scanned 16 bytes
+ * at a time for ',' and '\n' with SSE2 or NEON, falling back to a scalar loop.
+ * Only the selected columns are converted, with std::from_chars, so skipping a
+ * column costs one delimiter hit. Once the last selected column of a row has
+ * been parsed the rest of the row is skipped with memchr.
+ *
+ * The header is the first non-blank line; a leading '#', surrounding spaces and
+ * double quotes are stripped from each name (OpenRocket exports). Blank lines
+ * and lines starting with '#' after the header are skipped, "\r\n" endings and
+ * a UTF-8 BOM are accepted. Cells that are empty, missing from a short row or
+ * not a number ("13:23:56.346") read as NaN. Quoted cells containing commas are
+ * not supported; none of the bundled datasets use them.
+ *
+ *   NativeCsvReader csv;
+ *   if (csv.open("datasets/astra-rocket/raw/BR_LR_JAN.csv") &&
+ *       csv.select({"Flight_Time_(s)", "Baro_Altitude_AGL_(feet)"}))
+ *   {
+ *       double row[2];
+ *       while (csv.next(row)) { ... }
+ *   }
+ */
+class NativeCsvReader
+{
+public:
+    NativeCsvReader() = default;
+    ~NativeCsvReader() { close(); }
+
+    NativeCsvReader(const NativeCsvReader &) = delete;
+    NativeCsvReader &operator=(const NativeCsvReader &) = delete;
+
+    // Maps `path` and reads its header. All columns are selected afterwards.
+    bool open(const std::string &path)
+    {
+        close();
+        if (!mapFile(path))
+            return false;
+        const char *p = begin_;
+        if (end_ - p >= 3 && std::memcmp(p, "\xEF\xBB\xBF", 3) == 0)
+            p += 3;
+        while (p < end_ && isBlankLine(p))
+            p = lineEnd(p);
+        if (p == end_)
+        {
+            close();
+            return false;
+        }
+        const char *headerEnd = static_cast<const char *>(std::memchr(p, '\n', end_ - p));
+        if (!headerEnd)
+            headerEnd = end_;
+        parseHeader(p, headerEnd);
+        data_ = headerEnd < end_ ? headerEnd + 1 : end_;
+        selectAll();
+        rewind();
+        return true;
+    }
+
+    void close()
+    {
+#ifndef _WIN32
+        if (mapped_)
+            munmap(mapped_, mappedSize_);
+#endif
+        mapped_ = nullptr;
+        mappedSize_ = 0;
+        buffer_.clear();
+        buffer_.shrink_to_fit();
+        begin_ = end_ = data_ = cursor_ = nullptr;
+        columns_.clear();
+        slots_.clear();
+        selected_.clear();
+        rows_ = 0;
+    }
+
+    bool isOpen() const { return begin_ != nullptr; }
+
+    // Column names from the header, in file order.
+    const std::vector<std::string> &columns() const { return columns_; }
+
+    // Index of the column named exactly `name`, or -1.
+    int columnIndex(const std::string &name) const
+    {
+        for (size_t i = 0; i < columns_.size(); i++)
+            if (columns_[i] == name)
+                return static_cast<int>(i);
+        return -1;
+    }
+
+    // Projects rows onto the named columns, in the given order. Fails (and keeps
+    // the previous selection) if any name is not in the header.
+    bool select(const std::vector<std::string> &names)
+    {
+        std::vector<size_t> indices;
+        indices.reserve(names.size());
+        for (const std::string &name : names)
+        {
+            const int index = columnIndex(name);
+            if (index < 0)
+                return false;
+            indices.push_back(static_cast<size_t>(index));
+        }
+        selectIndices(indices);
+        return true;
+    }
+
+    // Projects rows onto the given column indices. Indices past the header read as NaN.
+    void selectIndices(const std::vector<size_t> &indices)
+    {
+        selected_ = indices;
+        size_t width = columns_.size();
+        for (size_t index : indices)
+            if (index + 1 > width)
+                width = index + 1;
+        slots_.assign(width, NONE);
+        lastField_ = 0;
+        for (size_t slot = 0; slot < indices.size(); slot++)
+        {
+            // A column selected twice is parsed once and copied.
+            if (slots_[indices[slot]] == NONE)
+                slots_[indices[slot]] = static_cast<int32_t>(slot);
+            if (indices[slot] > lastField_)
+                lastField_ = indices[slot];
+        }
+    }
+
+    void selectAll()
+    {
+        std::vector<size_t> indices(columns_.size());
+        for (size_t i = 0; i < indices.size(); i++)
+            indices[i] = i;
+        selectIndices(indices);
+    }
+
+    // Number of values next() writes per row.
+    size_t selectedCount() const { return selected_.size(); }
+
+    // Reads the next data row into `values` (selectedCount() doubles).
+    bool next(double *values)
+    {
+        while (cursor_ < end_)
+        {
+            if (isBlankLine(cursor_) || *cursor_ == '#')
+            {
+                cursor_ = lineEnd(cursor_);
+                continue;
+            }
+            cursor_ = parseRow(cursor_, values);
+            rows_++;
+            return true;
+        }
+        return false;
+    }
+
+    // Reads every remaining row, column-major: `out[i]` holds selected column i.
+    size_t readColumns(std::vector<std::vector<double>> &out)
+    {
+        const size_t width = selected_.size();
+        out.assign(width, std::vector<double>());
+        // Size the columns from the first row's length to avoid regrowing them.
+        const char *first = cursor_;
+        const char *firstEnd = first < end_ ? lineEnd(first) : end_;
+        if (firstEnd > first)
+        {
+            const size_t estimate = static_cast<size_t>(end_ - cursor_) / static_cast<size_t>(firstEnd - first) + 1;
+            for (std::vector<double> &column : out)
+                column.reserve(estimate);
+        }
+        std::vector<double> row(width);
+        size_t count = 0;
+        while (next(row.data()))
+        {
+            for (size_t i = 0; i < width; i++)
+                out[i].push_back(row[i]);
+            count++;
+        }
+        return count;
+    }
+
+    // Restarts at the first data row.
+    void rewind()
+    {
+        cursor_ = data_;
+        rows_ = 0;
+    }
+
+    // Data rows returned since open() or rewind().
+    size_t rowsRead() const { return rows_; }
+
+    // Size of the mapped file in bytes.
+    size_t size() const { return static_cast<size_t>(end_ - begin_); }
+
+private:
+    static constexpr int32_t NONE = -1;
+    static constexpr size_t BLOCK = 16;
+
+    void *mapped_ = nullptr;
+    size_t mappedSize_ = 0;
+    std::vector<char> buffer_;
+    const char *begin_ = nullptr;
+    const char *end_ = nullptr;
+    const char *data_ = nullptr;
+    const char *cursor_ = nullptr;
+    std::vector<std::string> columns_;
+    std::vector<int32_t> slots_; // file column -> first output slot, or NONE
+    std::vector<size_t> selected_;
+    size_t lastField_ = 0;
+    size_t rows_ = 0;
+
+    // Finds ',' and '\n' a block at a time; the mask of the current block is
+    // kept so consecutive calls within a block cost a bit scan.
+    struct Scanner
+    {
+        const char *block;
+        const char *end;
+        uint64_t mask;
+
+#if defined(NATIVE_CSV_NEON)
+        static constexpr unsigned BITS = 4; // NEON has no movemask; narrow to a nibble per byte
+#else
+        static constexpr unsigned BITS = 1;
+#endif
+
+        Scanner(const char *p, const char *e) : block(p), end(e), mask(0)
+        {
+            load();
+        }
+
+        // Next ',' or '\n' at or after the scanner's position, or `end`.
+        const char *next()
+        {
+            while (mask == 0)
+            {
+                block += BLOCK;
+                if (block >= end)
+                    return end;
+                load();
+            }
+            const unsigned bit = static_cast<unsigned>(countTrailingZeros(mask));
+            const unsigned lane = bit / BITS;
+            mask &= ~(((uint64_t(1) << BITS) - 1) << (lane * BITS));
+            return block + lane;
+        }
+
+        void load()
+        {
+            if (end - block >= static_cast<std::ptrdiff_t>(BLOCK))
+            {
+                mask = structuralMask(block);
+                return;
+            }
+            mask = 0;
+            for (std::ptrdiff_t i = 0; i < end - block; i++)
+                if (block[i] == ',' || block[i] == '\n')
+                    mask |= ((uint64_t(1) << BITS) - 1) << (i * BITS);
+        }
+
+        static uint64_t structuralMask(const char *p)
+        {
+#if defined(NATIVE_CSV_SSE2)
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            const __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(',')),
+                                              _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')));
+            return static_cast<uint32_t>(_mm_movemask_epi8(hits));
+#elif defined(NATIVE_CSV_NEON)
+            const uint8x16_t bytes = vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+            const uint8x16_t hits = vorrq_u8(vceqq_u8(bytes, vdupq_n_u8(',')), vceqq_u8(bytes, vdupq_n_u8('\n')));
+            return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hits), 4)), 0);
+#else
+            uint64_t mask = 0;
+            for (size_t i = 0; i < BLOCK; i++)
+                if (p[i] == ',' || p[i] == '\n')
+                    mask |= uint64_t(1) << i;
+            return mask;
+#endif
+        }
+
+        static int countTrailingZeros(uint64_t value)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_ctzll(value);
+#else
+            int count = 0;
+            while (!(value & 1))
+            {
+                value >>= 1;
+                count++;
+            }
+            return count;
+#endif
+        }
+    };
+
+    bool mapFile(const std::string &path)
+    {
+#ifdef _WIN32
+        FILE *file = fopen(path.c_str(), "rb");
+        if (!file)
+            return false;
+        char chunk[64 * 1024];
+        size_t n;
+        while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0)
+            buffer_.insert(buffer_.end(), chunk, chunk + n);
+        fclose(file);
+        begin_ = buffer_.data();
+        end_ = begin_ + buffer_.size();
+        return true;
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        const size_t size = static_cast<size_t>(st.st_size);
+        if (size == 0)
+        {
+            ::close(fd);
+            begin_ = end_ = "";
+            return true;
+        }
+        void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED)
+            return false;
+        madvise(mapped, size, MADV_SEQUENTIAL);
+        mapped_ = mapped;
+        mappedSize_ = size;
+        begin_ = static_cast<const char *>(mapped);
+        end_ = begin_ + size;
+        return true;
+#endif
+    }
+
+    void parseHeader(const char *p, const char *lineEnd)
+    {
+        const char *cell = p;
+        for (const char *q = p;; q++)
+        {
+            if (q == lineEnd || *q == ',')
+            {
+                const char *a = cell;
+                const char *b = q;
+                trim(a, b);
+                if (a < b && *a == '#')
+                {
+                    a++;
+                    trim(a, b);
+                }
+                columns_.emplace_back(a, b);
+                if (q == lineEnd)
+                    break;
+                cell = q + 1;
+            }
+        }
+    }
+
+    // Parses the row starting at `p` into `values`; returns the start of the next line.
+    const char *parseRow(const char *p, double *values)
+    {
+        const size_t width = selected_.size();
+        for (size_t i = 0; i < width; i++)
+            values[i] = std::numeric_limits<double>::quiet_NaN();
+
+        Scanner scanner(p, end_);
+        const char *cell = p;
+        size_t field = 0;
+        for (;;)
+        {
+            const char *q = scanner.next();
+            if (field < slots_.size() && slots_[field] != NONE)
+                values[slots_[field]] = parseNumber(cell, q);
+            if (q == end_)
+                break;
+            if (*q == '\n')
+            {
+                p = q + 1;
+                fillDuplicates(values);
+                return p;
+            }
+            if (field >= lastField_)
+            {
+                fillDuplicates(values);
+                return lineEnd(q);
+            }
+            field++;
+            cell = q + 1;
+        }
+        fillDuplicates(values);
+        return end_;
+    }
+
+    // Copies values into slots whose column was already selected earlier.
+    void fillDuplicates(double *values) const
+    {
+        for (size_t slot = 0; slot < selected_.size(); slot++)
+        {
+            const int32_t first = slots_[selected_[slot]];
+            if (first != static_cast<int32_t>(slot))
+                values[slot] = values[first];
+        }
+    }
+
+    static double parseNumber(const char *a, const char *b)
+    {
+        trim(a, b);
+        if (a < b && *a == '+')
+            a++;
+        double value;
+        const std::from_chars_result result = std::from_chars(a, b, value);
+        if (a == b || result.ec != std::errc() || result.ptr != b)
+            return std::numeric_limits<double>::quiet_NaN();
+        return value;
+    }
+
+    static void trim(const char *&a, const char *&b)
+    {
+        while (a < b && (*a == ' ' || *a == '\t' || *a == '"'))
+            a++;
+        while (b > a && (b[-1] == ' ' || b[-1] == '\t' || b[-1] == '\r' || b[-1] == '"'))
+            b--;
+    }
+
+    bool isBlankLine(const char *p) const
+    {
+        while (p < end_ && (*p == ' ' || *p == '\t' || *p == '\r'))
+            p++;
+        return p == end_ || *p == '\n';
+    }
+
+    // Start of the line after the one containing `p`.
+    const char *lineEnd(const char *p) const
+    {
+        const char *newline = static_cast<const char *>(std::memchr(p, '\n', end_ - p));
+        return newline ? newline + 1 : end_;
+    }
+};
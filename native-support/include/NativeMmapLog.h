@@ -0,0 +1,202 @@
+#pragma once
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <Arduino.h>
+#include <RecordData/Logging/LoggingBackend/ILogSink.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * NativeMmapLog: append-only ILogSink backed by fixed-size memory-mapped segments.
+ *
+ * Writes are a memcpy into the current mapping; the kernel handles writeback.
+ * When a segment fills up the sink rotates to `<path>.<NNN>`, and each segment's
+ * start time is appended to `<path>.idx` ("segment,start_ms") as it is opened so
+ * a crashed run still leaves an index next to its segments. On a clean end() the
+ * last segment is truncated to the bytes actually written; after a crash the
+ * tail of the last segment is zero-filled.
+ *
+ * POSIX only. On Windows begin() fails and callers should fall back to NativeFileLog.
+ */
+class NativeMmapLog : public astra::ILogSink
+{
+public:
+    struct Segment
+    {
+        std::string path;
+        uint64_t startMs;
+        size_t bytes;
+    };
+
+    static constexpr size_t DEFAULT_SEGMENT_SIZE = 8 * 1024 * 1024;
+
+    explicit NativeMmapLog(std::string path, size_t segmentSize = DEFAULT_SEGMENT_SIZE)
+        : path_(std::move(path)), segmentSize_(segmentSize ? pageAlign(segmentSize) : pageAlign(DEFAULT_SEGMENT_SIZE)) {}
+    ~NativeMmapLog() { end(); }
+
+    NativeMmapLog(const NativeMmapLog &) = delete;
+    NativeMmapLog &operator=(const NativeMmapLog &) = delete;
+
+    bool begin() override
+    {
+        end();
+        segments_.clear();
+        removeOldSegments();
+        started_ = openSegment();
+        return started_;
+    }
+
+    bool end() override
+    {
+        closeSegment(true);
+        started_ = false;
+        return true;
+    }
+
+    bool ok() const override { return started_ && base_ != nullptr; }
+
+    bool wantsPrefix() const override { return false; }
+
+    void flush() override
+    {
+#ifndef _WIN32
+        if (base_)
+            msync(base_, used_, MS_ASYNC);
+#endif
+    }
+
+    size_t write(uint8_t b) override { return write(&b, 1); }
+
+    size_t write(const uint8_t *buf, size_t n) override
+    {
+        if (!ok())
+            return 0;
+        size_t written = 0;
+        while (written < n)
+        {
+            if (used_ == segmentSize_ && !rotate())
+                break;
+            size_t chunk = segmentSize_ - used_;
+            if (chunk > n - written)
+                chunk = n - written;
+            std::memcpy(base_ + used_, buf + written, chunk);
+            used_ += chunk;
+            written += chunk;
+        }
+        if (base_) // a failed rotate() already recorded the closed segment's bytes
+            segments_.back().bytes = used_;
+        return written;
+    }
+
+    using Print::write; // keep other Print overloads visible
+
+    // Segments opened since begin(), oldest first.
+    const std::vector<Segment> &segments() const { return segments_; }
+
+    size_t segmentSize() const { return segmentSize_; }
+
+private:
+    std::string path_;
+    size_t segmentSize_;
+    std::vector<Segment> segments_;
+    uint8_t *base_ = nullptr;
+    size_t used_ = 0;
+    int fd_ = -1;
+    bool started_ = false;
+
+    static size_t pageAlign(size_t size)
+    {
+#ifndef _WIN32
+        const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+        const size_t page = 4096;
+#endif
+        return (size + page - 1) / page * page;
+    }
+
+    std::string segmentPath(size_t index) const
+    {
+        char suffix[16];
+        snprintf(suffix, sizeof(suffix), ".%03zu", index);
+        return path_ + suffix;
+    }
+
+    // A shorter run must not leave a longer previous run's segments behind.
+    void removeOldSegments() const
+    {
+        for (size_t index = 0; std::remove(segmentPath(index).c_str()) == 0; ++index)
+        {
+        }
+    }
+
+    bool rotate()
+    {
+        closeSegment(false);
+        return openSegment();
+    }
+
+    bool openSegment()
+    {
+#ifdef _WIN32
+        fprintf(stderr, "NativeMmapLog: memory-mapped logging is not supported on Windows\n");
+        return false;
+#else
+        Segment segment{segmentPath(segments_.size()), millis(), 0};
+        fd_ = ::open(segment.path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd_ < 0)
+            return false;
+        if (ftruncate(fd_, static_cast<off_t>(segmentSize_)) != 0)
+        {
+            ::close(fd_);
+            fd_ = -1;
+            return false;
+        }
+        void *mapped = mmap(nullptr, segmentSize_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (mapped == MAP_FAILED)
+        {
+            ::close(fd_);
+            fd_ = -1;
+            return false;
+        }
+        madvise(mapped, segmentSize_, MADV_SEQUENTIAL);
+        base_ = static_cast<uint8_t *>(mapped);
+        used_ = 0;
+        segments_.push_back(segment);
+        appendIndex(segment);
+        return true;
+#endif
+    }
+
+    void closeSegment(bool truncate)
+    {
+#ifndef _WIN32
+        if (!base_)
+            return;
+        msync(base_, used_, MS_ASYNC);
+        munmap(base_, segmentSize_);
+        segments_.back().bytes = used_;
+        base_ = nullptr;
+        if (truncate && ftruncate(fd_, static_cast<off_t>(used_)) != 0)
+            fprintf(stderr, "NativeMmapLog: failed to truncate %s\n", segments_.back().path.c_str());
+        ::close(fd_);
+        fd_ = -1;
+        used_ = 0;
+#endif
+    }
+
+    void appendIndex(const Segment &segment) const
+    {
+        FILE *idx = fopen((path_ + ".idx").c_str(), segments_.size() == 1 ? "w" : "a");
+        if (!idx)
+            return;
+        fprintf(idx, "%s,%llu\n", segment.path.c_str(), static_cast<unsigned long long>(segment.startMs));
+        fclose(idx);
+    }
+};
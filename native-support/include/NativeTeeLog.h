@@ -0,0 +1,284 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <RecordData/Logging/LoggingBackend/ILogSink.h>
+
+/**
+ * NativeTeeLog: fan-out ILogSink that formats a record once and dispatches it to N sinks.
+ *
+ * Bytes are collected into a record until '\n'; the finished record is stored in
+ * one reference-counted buffer and handed to every downstream sink's queue. Each
+ * ILogSink is drained by its own worker thread, so a slow sink (file, socket) only
+ * backs up its own queue. Plain Print targets are written inline by the thread
+ * that calls write(), since they are usually shared (a Serial port) and not safe
+ * to write from another thread. What happens when a sink's queue is full depends
+ * on its policy:
+ *   - Blocking:   the writer waits for room (nothing is lost).
+ *   - DropOldest: the oldest queued record is discarded.
+ *   - Sample:     only every Nth record is queued; when full, drop-oldest.
+ *
+ * Per-sink metrics report delivered/dropped/skipped records, queue high water and
+ * enqueue-to-write latency.
+ */
+class NativeTeeLog : public astra::ILogSink
+{
+public:
+    enum class Policy
+    {
+        Blocking,
+        DropOldest,
+        Sample,
+    };
+
+    struct Metrics
+    {
+        uint64_t delivered = 0;
+        uint64_t dropped = 0;     // discarded because the queue was full
+        uint64_t skipped = 0;     // not selected by a Sample policy
+        size_t queueHighWater = 0;
+        uint64_t totalLatencyUs = 0;
+        uint64_t maxLatencyUs = 0;
+
+        double meanLatencyUs() const { return delivered ? static_cast<double>(totalLatencyUs) / delivered : 0.0; }
+    };
+
+    static constexpr size_t DEFAULT_QUEUE_DEPTH = 256;
+
+    explicit NativeTeeLog(bool wantsPrefix = false) : wantsPrefix_(wantsPrefix) {}
+    ~NativeTeeLog() { end(); }
+
+    NativeTeeLog(const NativeTeeLog &) = delete;
+    NativeTeeLog &operator=(const NativeTeeLog &) = delete;
+
+    // Adds a downstream sink; its begin()/end()/flush() follow the tee's. Call before begin().
+    void addSink(astra::ILogSink &sink, Policy policy = Policy::Blocking, unsigned sampleEvery = 1,
+                 size_t queueDepth = DEFAULT_QUEUE_DEPTH)
+    {
+        addOutput(sink, &sink, policy, sampleEvery, queueDepth);
+    }
+
+    // Adds a plain Print target (e.g. a Serial port), written inline on the writer's
+    // thread with no queue; only write()/flush() are forwarded. Call before begin().
+    void addPrint(Print &print) { addOutput(print, nullptr, Policy::Blocking, 1, 1); }
+
+    size_t sinkCount() const { return outputs_.size(); }
+
+    Metrics metrics(size_t index) const
+    {
+        if (index >= outputs_.size())
+            return {};
+        std::lock_guard<std::mutex> lock(outputs_[index]->mutex);
+        return outputs_[index]->metrics;
+    }
+
+    bool begin() override
+    {
+        if (started_)
+            return true;
+        bool allOk = true;
+        for (auto &output : outputs_)
+        {
+            if (!output->sink)
+                continue;
+            if (!output->sink->begin())
+                allOk = false;
+            output->stopping = false;
+            output->worker = std::thread([this, out = output.get()] { drain(*out); });
+        }
+        started_ = true;
+        return allOk;
+    }
+
+    bool end() override
+    {
+        if (!started_)
+            return true;
+        publish();
+        for (auto &output : outputs_)
+        {
+            {
+                std::lock_guard<std::mutex> lock(output->mutex);
+                output->stopping = true;
+            }
+            output->ready.notify_all();
+            if (output->worker.joinable())
+                output->worker.join();
+            if (output->sink)
+                output->sink->end();
+        }
+        started_ = false;
+        return true;
+    }
+
+    bool ok() const override { return started_; }
+
+    bool wantsPrefix() const override { return wantsPrefix_; }
+
+    // Publishes any partial record, waits for every queue to drain, then flushes each sink.
+    void flush() override
+    {
+        publish();
+        for (auto &output : outputs_)
+        {
+            std::unique_lock<std::mutex> lock(output->mutex);
+            output->space.wait(lock, [&] { return (output->queue.empty() && !output->busy) || !started_; });
+            lock.unlock();
+            output->target->flush();
+        }
+    }
+
+    size_t write(uint8_t b) override { return write(&b, 1); }
+
+    size_t write(const uint8_t *buf, size_t n) override
+    {
+        if (!started_)
+            return 0;
+        const uint8_t *start = buf;
+        const uint8_t *end = buf + n;
+        for (const uint8_t *p = buf; p < end; ++p)
+        {
+            if (*p != '\n')
+                continue;
+            pending_.insert(pending_.end(), start, p + 1);
+            publish();
+            start = p + 1;
+        }
+        pending_.insert(pending_.end(), start, end);
+        return n;
+    }
+
+    using Print::write; // keep other Print overloads visible
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Record
+    {
+        std::vector<uint8_t> bytes;
+        Clock::time_point created;
+    };
+
+    struct Output
+    {
+        Print *target;
+        astra::ILogSink *sink;
+        Policy policy;
+        unsigned sampleEvery;
+        size_t queueDepth;
+        uint64_t seen = 0;
+
+        mutable std::mutex mutex;
+        std::condition_variable ready;
+        std::condition_variable space;
+        std::deque<std::shared_ptr<const Record>> queue;
+        bool busy = false;
+        bool stopping = false;
+        Metrics metrics;
+        std::thread worker;
+    };
+
+    std::vector<std::unique_ptr<Output>> outputs_;
+    std::vector<uint8_t> pending_;
+    bool wantsPrefix_;
+    bool started_ = false;
+
+    void addOutput(Print &target, astra::ILogSink *sink, Policy policy, unsigned sampleEvery, size_t queueDepth)
+    {
+        std::unique_ptr<Output> output(new Output());
+        output->target = &target;
+        output->sink = sink;
+        output->policy = policy;
+        output->sampleEvery = sampleEvery ? sampleEvery : 1;
+        output->queueDepth = queueDepth ? queueDepth : 1;
+        outputs_.push_back(std::move(output));
+    }
+
+    void publish()
+    {
+        if (pending_.empty())
+            return;
+        std::shared_ptr<Record> record = std::make_shared<Record>();
+        record->bytes.swap(pending_);
+        record->created = Clock::now();
+        std::shared_ptr<const Record> shared = std::move(record);
+
+        for (auto &output : outputs_)
+        {
+            if (!output->sink)
+            {
+                writeInline(*output, *shared);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(output->mutex);
+            if (output->policy == Policy::Sample && (output->seen++ % output->sampleEvery) != 0)
+            {
+                ++output->metrics.skipped;
+                continue;
+            }
+            if (output->queue.size() >= output->queueDepth)
+            {
+                if (output->policy == Policy::Blocking)
+                {
+                    output->space.wait(lock, [&] { return output->queue.size() < output->queueDepth; });
+                }
+                else
+                {
+                    output->queue.pop_front();
+                    ++output->metrics.dropped;
+                }
+            }
+            output->queue.push_back(shared);
+            if (output->queue.size() > output->metrics.queueHighWater)
+                output->metrics.queueHighWater = output->queue.size();
+            lock.unlock();
+            output->ready.notify_one();
+        }
+    }
+
+    static void writeInline(Output &output, const Record &record)
+    {
+        output.target->write(record.bytes.data(), record.bytes.size());
+        const uint64_t latencyUs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - record.created).count());
+        std::lock_guard<std::mutex> lock(output.mutex);
+        ++output.metrics.delivered;
+        output.metrics.totalLatencyUs += latencyUs;
+        if (latencyUs > output.metrics.maxLatencyUs)
+            output.metrics.maxLatencyUs = latencyUs;
+    }
+
+    static void drain(Output &output)
+    {
+        std::unique_lock<std::mutex> lock(output.mutex);
+        while (true)
+        {
+            output.ready.wait(lock, [&] { return !output.queue.empty() || output.stopping; });
+            if (output.queue.empty())
+                break;
+            std::shared_ptr<const Record> record = std::move(output.queue.front());
+            output.queue.pop_front();
+            output.busy = true;
+            lock.unlock();
+            output.space.notify_all();
+
+            output.target->write(record->bytes.data(), record->bytes.size());
+            const uint64_t latencyUs = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - record->created).count());
+
+            lock.lock();
+            output.busy = false;
+            ++output.metrics.delivered;
+            output.metrics.totalLatencyUs += latencyUs;
+            if (latencyUs > output.metrics.maxLatencyUs)
+                output.metrics.maxLatencyUs = latencyUs;
+            if (output.queue.empty())
+                output.space.notify_all();
+        }
+    }
+};
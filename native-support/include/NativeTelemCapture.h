@@ -0,0 +1,298 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <string>
+#include <vector>
+#include <RecordData/Logging/LoggingBackend/ILogSink.h>
+
+/**
+ * NativeTelemCapture: ILogSink that keeps telemetry in memory as columns for tests.
+ *
+ * The first line written (optionally prefixed with "TELEM/") defines the column
+ * names; every following CSV row is parsed into growable per-column double
+ * vectors (NaN for empty or non-numeric cells). Rows can also be appended
+ * directly with setColumns()/appendRow() when no text logging is involved.
+ *
+ * Unlike Stream::fakeBuffer nothing is truncated, so full-flight assertions
+ * can run in-process:
+ *
+ *   NativeTelemCapture telem;
+ *   ... run the flight ...
+ *   auto boost = telem.timeRange(0.0, 3.5);
+ *   TEST_ASSERT_TRUE(telem.stats("State - AZ (m/s/s)", boost).max > 50.0);
+ *   TEST_ASSERT_EQUAL(-1, telem.firstCrossing("State - PZ (m)", 3000.0));
+ */
+class NativeTelemCapture : public astra::ILogSink
+{
+public:
+    struct Range
+    {
+        size_t begin;
+        size_t end; // exclusive
+        size_t size() const { return end > begin ? end - begin : 0; }
+    };
+
+    struct Stats
+    {
+        size_t count = 0; // non-NaN samples
+        double min = std::numeric_limits<double>::quiet_NaN();
+        double max = std::numeric_limits<double>::quiet_NaN();
+        double mean = std::numeric_limits<double>::quiet_NaN();
+        long argMin = -1;
+        long argMax = -1;
+    };
+
+    NativeTelemCapture() = default;
+
+    bool begin() override
+    {
+        clear();
+        started_ = true;
+        return true;
+    }
+
+    bool end() override
+    {
+        if (!line_.empty())
+            consumeLine();
+        started_ = false;
+        return true;
+    }
+
+    bool ok() const override { return started_; }
+
+    bool wantsPrefix() const override { return false; }
+
+    size_t write(uint8_t b) override
+    {
+        if (b == '\n')
+            consumeLine();
+        else if (b != '\r')
+            line_ += static_cast<char>(b);
+        return 1;
+    }
+
+    size_t write(const uint8_t *buf, size_t n) override
+    {
+        for (size_t i = 0; i < n; ++i)
+            write(buf[i]);
+        return n;
+    }
+
+    using Print::write; // keep other Print overloads visible
+
+    // Drops all columns and rows; the next line written is treated as a header again.
+    void clear()
+    {
+        names_.clear();
+        columns_.clear();
+        line_.clear();
+        rows_ = 0;
+        timeColumn_ = 0;
+    }
+
+    // Defines the schema for structured appends (replaces any captured data).
+    void setColumns(std::initializer_list<const char *> names)
+    {
+        clear();
+        for (const char *name : names)
+            names_.emplace_back(name);
+        columns_.assign(names_.size(), {});
+    }
+
+    // Appends one structured record; missing trailing values are NaN.
+    void appendRow(const double *values, size_t n)
+    {
+        for (size_t col = 0; col < columns_.size(); ++col)
+            columns_[col].push_back(col < n ? values[col] : std::numeric_limits<double>::quiet_NaN());
+        ++rows_;
+    }
+
+    void appendRow(std::initializer_list<double> values) { appendRow(values.begin(), values.size()); }
+
+    size_t rows() const { return rows_; }
+    const std::vector<std::string> &columnNames() const { return names_; }
+
+    // Column index by exact name, or by the part after "Source - " (e.g. "PZ (m)"); -1 if absent.
+    int columnIndex(const char *name) const
+    {
+        for (size_t i = 0; i < names_.size(); ++i)
+            if (names_[i] == name)
+                return static_cast<int>(i);
+        for (size_t i = 0; i < names_.size(); ++i)
+        {
+            const size_t sep = names_[i].find(" - ");
+            if (sep != std::string::npos && names_[i].compare(sep + 3, std::string::npos, name) == 0)
+                return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    bool hasColumn(const char *name) const { return columnIndex(name) >= 0; }
+
+    // Column values, or an empty vector when the column does not exist.
+    const std::vector<double> &column(const char *name) const
+    {
+        static const std::vector<double> empty;
+        const int index = columnIndex(name);
+        return index < 0 ? empty : columns_[index];
+    }
+
+    double value(const char *name, size_t row) const
+    {
+        const std::vector<double> &values = column(name);
+        return row < values.size() ? values[row] : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    // Column used by timeRange()/timeAt(); defaults to the first column.
+    bool setTimeColumn(const char *name)
+    {
+        const int index = columnIndex(name);
+        if (index < 0)
+            return false;
+        timeColumn_ = static_cast<size_t>(index);
+        return true;
+    }
+
+    double timeAt(size_t row) const
+    {
+        if (timeColumn_ >= columns_.size() || row >= rows_)
+            return std::numeric_limits<double>::quiet_NaN();
+        return columns_[timeColumn_][row];
+    }
+
+    Range all() const { return {0, rows_}; }
+
+    // Rows with t0 <= time < t1. Assumes the time column is non-decreasing.
+    Range timeRange(double t0, double t1) const
+    {
+        if (timeColumn_ >= columns_.size())
+            return {0, 0};
+        const std::vector<double> &time = columns_[timeColumn_];
+        const size_t first = std::lower_bound(time.begin(), time.end(), t0) - time.begin();
+        const size_t last = std::lower_bound(time.begin(), time.end(), t1) - time.begin();
+        return {first, std::max(first, last)};
+    }
+
+    Stats stats(const char *name) const { return stats(name, all()); }
+
+    Stats stats(const char *name, Range range) const
+    {
+        Stats out;
+        const std::vector<double> &values = column(name);
+        const size_t end = std::min(range.end, values.size());
+        double sum = 0.0;
+        for (size_t row = range.begin; row < end; ++row)
+        {
+            const double v = values[row];
+            if (std::isnan(v))
+                continue;
+            if (out.count == 0 || v < out.min)
+            {
+                out.min = v;
+                out.argMin = static_cast<long>(row);
+            }
+            if (out.count == 0 || v > out.max)
+            {
+                out.max = v;
+                out.argMax = static_cast<long>(row);
+            }
+            sum += v;
+            ++out.count;
+        }
+        if (out.count)
+            out.mean = sum / static_cast<double>(out.count);
+        return out;
+    }
+
+    // First row where the column crosses `threshold` (rising: prev < t <= cur,
+    // falling: prev > t >= cur), or -1 when it never does.
+    long firstCrossing(const char *name, double threshold, bool rising = true) const
+    {
+        return firstCrossing(name, threshold, rising, all());
+    }
+
+    long firstCrossing(const char *name, double threshold, bool rising, Range range) const
+    {
+        const std::vector<double> &values = column(name);
+        const size_t end = std::min(range.end, values.size());
+        double previous = std::numeric_limits<double>::quiet_NaN();
+        for (size_t row = range.begin; row < end; ++row)
+        {
+            const double v = values[row];
+            if (std::isnan(v))
+                continue;
+            if (!std::isnan(previous) &&
+                (rising ? (previous < threshold && v >= threshold) : (previous > threshold && v <= threshold)))
+                return static_cast<long>(row);
+            previous = v;
+        }
+        return -1;
+    }
+
+private:
+    std::vector<std::string> names_;
+    std::vector<std::vector<double>> columns_;
+    std::string line_;
+    size_t rows_ = 0;
+    size_t timeColumn_ = 0;
+    bool started_ = true;
+
+    void consumeLine()
+    {
+        const char *text = line_.c_str();
+        if (std::strncmp(text, "TELEM/", 6) == 0)
+            text += 6;
+        if (*text == '\0')
+        {
+            line_.clear();
+            return;
+        }
+
+        if (names_.empty())
+        {
+            const char *start = text;
+            for (const char *p = text;; ++p)
+            {
+                if (*p == ',' || *p == '\0')
+                {
+                    std::string name(start, static_cast<size_t>(p - start));
+                    const size_t first = name.find_first_not_of(" \t");
+                    const size_t last = name.find_last_not_of(" \t");
+                    names_.push_back(first == std::string::npos ? std::string() : name.substr(first, last - first + 1));
+                    if (*p == '\0')
+                        break;
+                    start = p + 1;
+                }
+            }
+            columns_.assign(names_.size(), {});
+            line_.clear();
+            return;
+        }
+
+        const char *cursor = text;
+        for (size_t col = 0; col < columns_.size(); ++col)
+        {
+            double value = std::numeric_limits<double>::quiet_NaN();
+            if (cursor)
+            {
+                char *end = nullptr;
+                const double parsed = std::strtod(cursor, &end);
+                const char *next = std::strchr(cursor, ',');
+                const char *cellEnd = next ? next : cursor + std::strlen(cursor);
+                while (end && end < cellEnd && (*end == ' ' || *end == '\t'))
+                    ++end;
+                if (end != cursor && end == cellEnd)
+                    value = parsed;
+                cursor = next ? next + 1 : nullptr;
+            }
+            columns_[col].push_back(value);
+        }
+        ++rows_;
+        line_.clear();
+    }
+};
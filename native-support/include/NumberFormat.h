@@ -0,0 +1,90 @@
+#ifndef NATIVE_NUMBER_FORMAT_H
+#define NATIVE_NUMBER_FORMAT_H
+
+#ifdef __cplusplus
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+// Number formatting shared by Print and String: no allocation, one pass, no
+// locale. Output matches printf's "%d"/"%u"/"%.*f" for the same arguments.
+
+// Largest "%.*f" output: sign + 309 integer digits + point + NUMBER_FORMAT_MAX_PRECISION.
+#define NUMBER_FORMAT_MAX_PRECISION 30
+#define NUMBER_FORMAT_BUFFER_SIZE 352
+
+template <typename T>
+inline size_t formatInteger(char *out, T value)
+{
+    // 20 digits + sign covers every 64-bit integer.
+    std::to_chars_result result = std::to_chars(out, out + 21, value);
+    return static_cast<size_t>(result.ptr - out);
+}
+
+// Fixed-point "%.*f" formatting into `out` (at least NUMBER_FORMAT_BUFFER_SIZE bytes,
+// no NUL written). Precision is clamped to [0, NUMBER_FORMAT_MAX_PRECISION].
+inline size_t formatFixed(char *out, double value, int precision)
+{
+    static const double POW10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8};
+    if (precision < 0)
+        precision = 0;
+    if (precision > NUMBER_FORMAT_MAX_PRECISION)
+        precision = NUMBER_FORMAT_MAX_PRECISION;
+
+    // Fast path: scale to an integer and print its digits. Only taken when the
+    // rounding direction is unambiguous: |scaled| < 2^43 keeps the product's
+    // error under 2^-10, so anything not within 2^-9 of a .5 tie rounds exactly
+    // as printf would round the exact binary value.
+    if (precision <= 8 && std::isfinite(value))
+    {
+        const double scaled = value * POW10[precision];
+        if (std::fabs(scaled) < 8796093022208.0)
+        {
+            const double rounded = std::nearbyint(scaled);
+            if (std::fabs(std::fabs(scaled - rounded) - 0.5) > 0.001953125)
+            {
+                char digits[24];
+                const uint64_t magnitude = static_cast<uint64_t>(std::fabs(rounded));
+                const size_t count = formatInteger(digits, magnitude);
+                char *p = out;
+                if (std::signbit(value))
+                    *p++ = '-';
+                const size_t intDigits = count > static_cast<size_t>(precision) ? count - precision : 0;
+                if (intDigits == 0)
+                    *p++ = '0';
+                else
+                {
+                    std::memcpy(p, digits, intDigits);
+                    p += intDigits;
+                }
+                if (precision > 0)
+                {
+                    *p++ = '.';
+                    const size_t fracDigits = count - intDigits;
+                    const size_t zeros = static_cast<size_t>(precision) - fracDigits;
+                    std::memset(p, '0', zeros);
+                    p += zeros;
+                    std::memcpy(p, digits + intDigits, fracDigits);
+                    p += fracDigits;
+                }
+                return static_cast<size_t>(p - out);
+            }
+        }
+    }
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    std::to_chars_result result = std::to_chars(out, out + NUMBER_FORMAT_BUFFER_SIZE, value,
+                                                std::chars_format::fixed, precision);
+    return result.ec == std::errc() ? static_cast<size_t>(result.ptr - out) : 0;
+#else
+    int n = snprintf(out, NUMBER_FORMAT_BUFFER_SIZE, "%.*f", precision, value);
+    return n > 0 ? static_cast<size_t>(n) : 0;
+#endif
+}
+
+#endif // __cplusplus
+
+#endif // NATIVE_NUMBER_FORMAT_H
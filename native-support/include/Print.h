@@ -6,9 +6,10 @@
 #include <cstdint>
 #include <cstring>
 #include <cstdarg>
-#include <cstdio>
 #include <climits>
-#include <new>
+#include "NumberFormat.h"
+#include "PrintFormat.h"
+#include "WriteSlice.h"
 
 using uint8_t = std::uint8_t;
 
@@ -26,6 +27,16 @@ public:
         return w;
     }
 
+    // Scatter-gather write of several buffers as one record. The default forwards each
+    // slice to write(buf, n); transports override it to emit a single syscall.
+    virtual size_t writev(const WriteSlice *slices, size_t count)
+    {
+        size_t w = 0;
+        for (size_t i = 0; i < count; ++i)
+            w += write(slices[i].data, slices[i].len);
+        return w;
+    }
+
     size_t write(const char *str)
     {
         if (!str)
@@ -41,84 +52,21 @@ public:
         return write(reinterpret_cast<const uint8_t *>(s), std::strlen(s));
     }
 
-    size_t print(double d, int precision = 2)
-    {
-        char buf[32];
-        snprintf(buf, sizeof(buf), "%.*f", precision, d);
-        return print(buf);
-    }
-
-    size_t print(int i)
-    {
-        char buf[32];
-        snprintf(buf, sizeof(buf), "%d", i);
-        return print(buf);
-    }
-
-    size_t print(unsigned int i)
-    {
-        char buf[32];
-        snprintf(buf, sizeof(buf), "%u", i);
-        return print(buf);
-    }
-
-    size_t print(long i)
-    {
-        char buf[32];
-        snprintf(buf, sizeof(buf), "%ld", i);
-        return print(buf);
-    }
-
-    size_t print(unsigned long i)
-    {
-        char buf[32];
-        snprintf(buf, sizeof(buf), "%lu", i);
-        return print(buf);
-    }
-
-    size_t println(double d, int precision = 2)
-    {
-        char buf[32];
-        snprintf(buf, sizeof(buf), "%.*f", precision, d);
-        return println(buf);
-    }
-
-    size_t println(int i)
-    {
-        char buf[32];
-        snprintf(buf, sizeof(buf), "%d", i);
-        return println(buf);
-    }
-
-    size_t println(unsigned int i)
-    {
-        char buf[32];
-        snprintf(buf, sizeof(buf), "%u", i);
-        return println(buf);
-    }
-
-    size_t println(long i)
-    {
-        char buf[32];
-        snprintf(buf, sizeof(buf), "%ld", i);
-        return println(buf);
-    }
+    size_t print(double d, int precision = 2) { return printFixed(d, precision, false); }
+    size_t print(int i) { return printInteger(i, false); }
+    size_t print(unsigned int i) { return printInteger(i, false); }
+    size_t print(long i) { return printInteger(i, false); }
+    size_t print(unsigned long i) { return printInteger(i, false); }
 
-    size_t println(unsigned long i)
-    {
-        char buf[32];
-        snprintf(buf, sizeof(buf), "%lu", i);
-        return println(buf);
-    }
+    size_t println(double d, int precision = 2) { return printFixed(d, precision, true); }
+    size_t println(int i) { return printInteger(i, true); }
+    size_t println(unsigned int i) { return printInteger(i, true); }
+    size_t println(long i) { return printInteger(i, true); }
+    size_t println(unsigned long i) { return printInteger(i, true); }
 
     // Define size_t overload only when it won't collide with other integer overloads.
 #if (SIZE_MAX != UINT_MAX) && (SIZE_MAX != ULONG_MAX)
-    size_t println(size_t i)
-    {
-        char buf[32];
-        snprintf(buf, sizeof(buf), "%zu", i);
-        return println(buf);
-    }
+    size_t println(size_t i) { return printInteger(i, true); }
 #endif
 
     // FlashStringHelper support - on native, flash strings are just regular const char*
@@ -132,73 +80,67 @@ public:
 
     size_t println(const char *s)
     {
-        size_t n = print(s);
-        n += write(reinterpret_cast<const uint8_t *>("\n"), 1);
-        return n;
+        const WriteSlice slices[] = {
+            {reinterpret_cast<const uint8_t *>(s ? s : ""), s ? std::strlen(s) : 0},
+            {reinterpret_cast<const uint8_t *>("\n"), 1},
+        };
+        return writev(slices, 2);
     }
 
     size_t println()
     {
         return write(reinterpret_cast<const uint8_t *>("\n"), 1);
     }
-    // Add these methods inside your Print-compatible class:
-    size_t vprintf(const char *fmt, va_list ap)
+    // printf-style formatting (Print.cpp)
+    size_t vprintf(const char *fmt, va_list ap);
+    size_t printf(const char *fmt, ...);
+    size_t printlnf(const char *fmt, ...); // printf + newline
+
+    // Compile-time checked formatting (see PrintFormat.h): the format is parsed while
+    // compiling and the output goes out in a single write().
+    template <typename Fmt, typename... Args>
+    size_t print_fmt(Fmt, const Args &...args)
     {
-        if (!fmt)
-            return 0;
+        return print_format::format<Fmt>(*this, false, std::index_sequence_for<Args...>{}, args...);
+    }
 
-        // First pass: determine required length (excluding null)
-        va_list ap_copy;
-        va_copy(ap_copy, ap);
-        int needed = vsnprintf(nullptr, 0, fmt, ap_copy);
-        va_end(ap_copy);
-        if (needed <= 0)
-            return 0; // formatting error or empty
-
-        // Fast path: fit into small stack buffer
-        if (needed < 128)
-        {
-            char buf[128];
-            int n = vsnprintf(buf, sizeof(buf), fmt, ap);
-            if (n <= 0)
-                return 0;
-            return write(reinterpret_cast<const uint8_t *>(buf), static_cast<size_t>(n));
-        }
-
-        // Large output: allocate exact size + NUL, then write once
-        char *heap = new (std::nothrow) char[static_cast<size_t>(needed) + 1];
-        if (!heap)
-            return 0;
-        int n = vsnprintf(heap, static_cast<size_t>(needed) + 1, fmt, ap);
-        size_t wrote = 0;
-        if (n > 0)
-            wrote = write(reinterpret_cast<const uint8_t *>(heap), static_cast<size_t>(n));
-        delete[] heap;
-        return wrote;
+    template <typename Fmt, typename... Args>
+    size_t println_fmt(Fmt, const Args &...args)
+    {
+        return print_format::format<Fmt>(*this, true, std::index_sequence_for<Args...>{}, args...);
     }
 
-    size_t printf(const char *fmt, ...)
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+    template <print_format::FixedString F, typename... Args>
+    size_t print_fmt(const Args &...args)
     {
-        va_list ap;
-        va_start(ap, fmt);
-        size_t wrote = vprintf(fmt, ap);
-        va_end(ap);
-        return wrote;
+        return print_fmt(print_format::FixedStringLiteral<F>{}, args...);
     }
 
-    // Convenience: printf + newline
-    size_t printlnf(const char *fmt, ...)
+    template <print_format::FixedString F, typename... Args>
+    size_t println_fmt(const Args &...args)
     {
-        va_list ap;
-        va_start(ap, fmt);
-        size_t wrote = vprintf(fmt, ap);
-        va_end(ap);
-        wrote += write(reinterpret_cast<const uint8_t *>("\n"), 1);
-        return wrote;
+        return println_fmt(print_format::FixedStringLiteral<F>{}, args...);
     }
+#endif
 
     virtual void flush() {} // no-op by default (Arduino's default too)
+
+private:
+    // Format into one stack buffer (plus optional newline) and issue a single write.
+    size_t printFixed(double d, int precision, bool newline);
+
+    template <typename T>
+    size_t printInteger(T value, bool newline)
+    {
+        char buf[24];
+        size_t n = formatInteger(buf, value);
+        if (newline)
+            buf[n++] = '\n';
+        return write(reinterpret_cast<const uint8_t *>(buf), n);
+    }
 };
+
 #endif // __cplusplus
 
 #endif // NATIVE_PRINT_H
@@ -0,0 +1,367 @@
+#ifndef NATIVE_PRINT_FORMAT_H
+#define NATIVE_PRINT_FORMAT_H
+
+#ifdef __cplusplus
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include "NumberFormat.h"
+
+/**
+ * Compile-time checked formatting for Print::print_fmt()/println_fmt().
+ *
+ * Placeholders:
+ *   {}      value with its default formatting (floating point: 2 decimals, like print(double))
+ *   {:.N}   floating point with N decimals (0-30)
+ *   {:x}    unsigned integer in lowercase hex
+ *   {{ }}   literal braces
+ *
+ * The format string is parsed while compiling into a table of literal runs and
+ * argument specs; a placeholder/argument count mismatch or a malformed spec is a
+ * compile error. At run time arguments go straight to typed writers that fill one
+ * stack buffer, which is handed to write() once (or in 1 KiB pieces).
+ *
+ *   Serial.println_fmt(PRINT_FMT("{:.3},{},{}"), t, stage, alt);   // C++17
+ *   Serial.println_fmt<"{:.3},{},{}">(t, stage, alt);              // C++20
+ *
+ * The header only needs an output with write(const uint8_t *, size_t), so target
+ * builds whose Print lacks print_fmt can use the free functions instead:
+ *
+ *   print_format::println(Serial, PRINT_FMT("{:.3},{}"), t, alt);
+ *
+ * Needs C++17 and a standard library with floating-point std::to_chars (GCC 11+).
+ */
+
+// Wraps a string literal in a unique type so its contents are usable in constant expressions.
+#define PRINT_FMT(literal)                                                   \
+    ([] {                                                                    \
+        struct PrintFmtLiteral                                               \
+        {                                                                    \
+            static constexpr const char *value() { return literal; }         \
+        };                                                                   \
+        return PrintFmtLiteral{};                                            \
+    }())
+
+namespace print_format
+{
+    struct Segment
+    {
+        size_t literalBegin = 0;
+        size_t literalLength = 0;
+        char kind = 'n';     // 'a' argument, 'b' literal brace, 'n' end of string
+        char type = 0;       // 0 default, 'f' fixed precision, 'x' hex
+        int precision = -1;
+    };
+
+    // Number of segments (placeholders + escapes + trailing literal), or 0 if malformed.
+    constexpr size_t countSegments(const char *s)
+    {
+        size_t count = 1;
+        for (size_t i = 0; s[i]; ++i)
+        {
+            if (s[i] == '{' && s[i + 1] == '{')
+            {
+                ++count;
+                ++i;
+            }
+            else if (s[i] == '}' && s[i + 1] == '}')
+            {
+                ++count;
+                ++i;
+            }
+            else if (s[i] == '{')
+            {
+                while (s[i] && s[i] != '}')
+                    ++i;
+                if (!s[i])
+                    return 0;
+                ++count;
+            }
+            else if (s[i] == '}')
+            {
+                return 0;
+            }
+        }
+        return count;
+    }
+
+    template <size_t N>
+    struct Parsed
+    {
+        std::array<Segment, N> segments{};
+        size_t argCount = 0;
+        bool valid = true;
+    };
+
+    template <size_t N>
+    constexpr Parsed<N> parse(const char *s)
+    {
+        Parsed<N> out;
+        size_t seg = 0;
+        size_t literalStart = 0;
+        size_t i = 0;
+        while (s[i])
+        {
+            const bool escape = (s[i] == '{' || s[i] == '}') && s[i + 1] == s[i];
+            if (!escape && s[i] != '{')
+            {
+                ++i;
+                continue;
+            }
+            Segment &current = out.segments[seg++];
+            current.literalBegin = literalStart;
+            current.literalLength = i - literalStart;
+            if (escape)
+            {
+                current.kind = 'b';
+                current.type = s[i];
+                i += 2;
+                literalStart = i;
+                continue;
+            }
+            current.kind = 'a';
+            ++out.argCount;
+            ++i; // past '{'
+            if (s[i] == ':')
+            {
+                ++i;
+                if (s[i] == '.')
+                {
+                    ++i;
+                    int precision = 0;
+                    bool digits = false;
+                    while (s[i] >= '0' && s[i] <= '9')
+                    {
+                        precision = precision * 10 + (s[i] - '0');
+                        digits = true;
+                        ++i;
+                    }
+                    if (!digits || precision > NUMBER_FORMAT_MAX_PRECISION)
+                        out.valid = false;
+                    current.type = 'f';
+                    current.precision = precision;
+                }
+                else if (s[i] == 'x')
+                {
+                    ++i;
+                    current.type = 'x';
+                }
+                else
+                {
+                    out.valid = false;
+                }
+            }
+            if (s[i] != '}')
+            {
+                out.valid = false;
+                while (s[i] && s[i] != '}')
+                    ++i;
+            }
+            ++i; // past '}'
+            literalStart = i;
+        }
+        Segment &tail = out.segments[seg];
+        tail.literalBegin = literalStart;
+        tail.literalLength = i - literalStart;
+        tail.kind = 'n';
+        return out;
+    }
+
+    template <typename Fmt>
+    struct Format
+    {
+        static constexpr const char *text = Fmt::value();
+        static constexpr size_t segmentCount = countSegments(Fmt::value());
+        static_assert(segmentCount > 0, "print_fmt: unbalanced '{' or '}' in format string");
+        static constexpr Parsed<segmentCount> parsed = parse<segmentCount>(Fmt::value());
+        static_assert(parsed.valid, "print_fmt: unsupported placeholder (use {}, {:.N} or {:x})");
+
+        // Segment index of argument `arg`.
+        static constexpr size_t argSegment(size_t arg)
+        {
+            for (size_t i = 0; i < segmentCount; ++i)
+                if (parsed.segments[i].kind == 'a' && arg-- == 0)
+                    return i;
+            return segmentCount - 1;
+        }
+    };
+
+    // Collects formatted output for `Out`, anything with write(const uint8_t *, size_t).
+    template <typename Out>
+    class Buffer
+    {
+    public:
+        static constexpr size_t CAPACITY = 1024;
+
+        explicit Buffer(Out &out) : out_(out) {}
+
+        void append(const char *data, size_t n)
+        {
+            while (n > 0)
+            {
+                if (used_ == CAPACITY)
+                    flush();
+                const size_t chunk = n < CAPACITY - used_ ? n : CAPACITY - used_;
+                std::memcpy(data_ + used_, data, chunk);
+                used_ += chunk;
+                data += chunk;
+                n -= chunk;
+            }
+        }
+        void append(char c)
+        {
+            if (used_ == CAPACITY)
+                flush();
+            data_[used_++] = c;
+        }
+        // Room for one formatted number; flushes if it might not fit.
+        char *reserve()
+        {
+            if (CAPACITY - used_ < NUMBER_FORMAT_BUFFER_SIZE)
+                flush();
+            return data_ + used_;
+        }
+        void commit(size_t n) { used_ += n; }
+        void flush()
+        {
+            if (used_ == 0)
+                return;
+            written_ += out_.write(reinterpret_cast<const uint8_t *>(data_), used_);
+            used_ = 0;
+        }
+        size_t written() const { return written_; }
+
+    private:
+        Out &out_;
+        char data_[CAPACITY];
+        size_t used_ = 0;
+        size_t written_ = 0;
+    };
+
+    template <typename T, typename = void>
+    struct HasCStr : std::false_type
+    {
+    };
+    template <typename T>
+    struct HasCStr<T, decltype(void(std::declval<const T &>().c_str()))> : std::true_type
+    {
+    };
+
+    template <typename Buf, typename T>
+    void writeValue(Buf &buf, const T &value, const Segment &spec)
+    {
+        using V = std::decay_t<T>;
+        if constexpr (std::is_same<V, bool>::value)
+        {
+            buf.append(value ? '1' : '0');
+        }
+        else if constexpr (std::is_same<V, char>::value)
+        {
+            buf.append(value);
+        }
+        else if constexpr (std::is_integral<V>::value)
+        {
+            char *out = buf.reserve();
+            if (spec.type == 'x')
+                buf.commit(static_cast<size_t>(std::to_chars(out, out + 21, static_cast<std::make_unsigned_t<V>>(value), 16).ptr - out));
+            else
+                buf.commit(formatInteger(out, value));
+        }
+        else if constexpr (std::is_floating_point<V>::value)
+        {
+            buf.commit(formatFixed(buf.reserve(), static_cast<double>(value), spec.type == 'f' ? spec.precision : 2));
+        }
+        else if constexpr (std::is_same<V, const char *>::value || std::is_same<V, char *>::value)
+        {
+            const char *text = value; // also decays char arrays / string literals
+            if (text)
+                buf.append(text, std::strlen(text));
+        }
+        else if constexpr (HasCStr<V>::value)
+        {
+            const char *text = value.c_str();
+            buf.append(text, std::strlen(text));
+        }
+        else
+        {
+            static_assert(sizeof(V) == 0, "print_fmt: argument type has no formatter");
+        }
+    }
+
+    template <typename F, typename Buf>
+    void writeSegments(Buf &buf, size_t first, size_t last)
+    {
+        for (size_t i = first; i <= last; ++i)
+        {
+            const Segment &seg = F::parsed.segments[i];
+            buf.append(F::text + seg.literalBegin, seg.literalLength);
+            if (seg.kind == 'b')
+                buf.append(seg.type);
+        }
+    }
+
+    template <typename F, size_t I, typename Buf, typename T>
+    void writeArg(Buf &buf, const T &value)
+    {
+        constexpr size_t seg = F::argSegment(I);
+        constexpr size_t previous = I == 0 ? 0 : F::argSegment(I - 1) + 1;
+        constexpr Segment spec = F::parsed.segments[seg];
+        static_assert(spec.type != 'x' || std::is_integral<std::decay_t<T>>::value,
+                      "print_fmt: {:x} needs an integer argument");
+        static_assert(spec.type != 'f' || std::is_floating_point<std::decay_t<T>>::value,
+                      "print_fmt: {:.N} needs a floating point argument");
+        writeSegments<F>(buf, previous, seg);
+        writeValue(buf, value, spec);
+    }
+
+    template <typename Fmt, typename Out, size_t... I, typename... Args>
+    size_t format(Out &out, bool newline, std::index_sequence<I...>, const Args &...args)
+    {
+        using F = Format<Fmt>;
+        static_assert(F::parsed.argCount == sizeof...(Args), "print_fmt: placeholder count does not match arguments");
+        Buffer<Out> buf(out);
+        (writeArg<F, I>(buf, args), ...);
+        writeSegments<F>(buf, sizeof...(Args) == 0 ? 0 : F::argSegment(sizeof...(Args) - 1) + 1, F::segmentCount - 1);
+        if (newline)
+            buf.append('\n');
+        buf.flush();
+        return buf.written();
+    }
+
+    template <typename Out, typename Fmt, typename... Args>
+    size_t print(Out &out, Fmt, const Args &...args)
+    {
+        return format<Fmt>(out, false, std::index_sequence_for<Args...>{}, args...);
+    }
+
+    template <typename Out, typename Fmt, typename... Args>
+    size_t println(Out &out, Fmt, const Args &...args)
+    {
+        return format<Fmt>(out, true, std::index_sequence_for<Args...>{}, args...);
+    }
+
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+    template <size_t N>
+    struct FixedString
+    {
+        char chars[N]{};
+        constexpr FixedString(const char (&s)[N])
+        {
+            for (size_t i = 0; i < N; ++i)
+                chars[i] = s[i];
+        }
+    };
+
+    template <FixedString S>
+    struct FixedStringLiteral
+    {
+        static constexpr const char *value() { return S.chars; }
+    };
+#endif
+} // namespace print_format
+
+#endif // __cplusplus
+
+#endif // NATIVE_PRINT_FORMAT_H
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <cstddef>
+#include "WriteSlice.h"
 
 /**
  * SITLSocket: Cross-platform TCP socket wrapper for Software-In-The-Loop simulation
@@ -44,6 +45,15 @@ public:
      */
     int write(const uint8_t* data, size_t len);
 
+    /**
+     * Write several buffers as one message (blocking), using sendmsg()/WSASend()
+     * so a prefix, payload and newline leave in a single syscall without copying
+     * @param slices Buffers to send, in order
+     * @param count Number of slices
+     * @return Number of bytes actually written, -1 on error
+     */
+    int writev(const WriteSlice* slices, size_t count);
+
     /**
      * Read available data from simulator (non-blocking)
      * @param buffer Pointer to buffer to fill
@@ -0,0 +1,272 @@
+#ifndef NATIVE_SERIAL_CAPTURE_H
+#define NATIVE_SERIAL_CAPTURE_H
+
+#ifdef __cplusplus
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * SerialCapture: record of the bytes a Stream has written, for test assertions.
+ *
+ * Modes:
+ *   Off        nothing is kept (fastest; use for long soak runs)
+ *   Prefix     legacy behaviour: the first bytes go to Stream::fakeBuffer until it is full
+ *   Ring       the last N bytes are kept, older output is overwritten
+ *   Unbounded  everything is kept in fixed-size chunks (no reallocation or copying)
+ *
+ * Every mode counts the total bytes written and how many were not retained, so a
+ * test can tell a truncated capture from a complete one.
+ *
+ *   Serial.setCapture(SerialCapture::Mode::Ring, 64 * 1024);
+ *   ... run ...
+ *   Serial.capture().forEachLine([](const std::string &line) { ... });
+ */
+class SerialCapture
+{
+public:
+    enum class Mode
+    {
+        Off,
+        Prefix,
+        Ring,
+        Unbounded,
+    };
+
+    static constexpr size_t DEFAULT_RING_BYTES = 64 * 1024;
+    static constexpr size_t CHUNK_BYTES = 64 * 1024;
+
+    // `prefix`/`prefixCursor` are the owning Stream's fakeBuffer and cursor.
+    SerialCapture(char *prefix, size_t prefixCapacity, int &prefixCursor)
+        : prefix_(prefix), prefixCapacity_(prefixCapacity), prefixCursor_(prefixCursor)
+    {
+    }
+
+    SerialCapture(const SerialCapture &) = delete;
+    SerialCapture &operator=(const SerialCapture &) = delete;
+
+    // Switches mode (ring capacity in bytes for Ring) and drops anything captured.
+    void setMode(Mode mode, size_t ringBytes = DEFAULT_RING_BYTES)
+    {
+        mode_ = mode;
+        ring_.reset();
+        ringCapacity_ = 0;
+        if (mode == Mode::Ring)
+        {
+            ringCapacity_ = ringBytes ? ringBytes : 1;
+            ring_.reset(new char[ringCapacity_]);
+        }
+        clear();
+    }
+
+    Mode mode() const { return mode_; }
+
+    void append(const uint8_t *data, size_t len)
+    {
+        total_ += len;
+        switch (mode_)
+        {
+        case Mode::Off:
+            dropped_ += len;
+            break;
+        case Mode::Prefix:
+            appendPrefix(reinterpret_cast<const char *>(data), len);
+            break;
+        case Mode::Ring:
+            appendRing(reinterpret_cast<const char *>(data), len);
+            break;
+        case Mode::Unbounded:
+            appendChunks(reinterpret_cast<const char *>(data), len);
+            break;
+        }
+    }
+
+    void clear()
+    {
+        prefixCursor_ = 0;
+        prefix_[0] = '\0';
+        ringHead_ = 0;
+        ringSize_ = 0;
+        ringAtLineStart_ = true;
+        chunks_.clear();
+        total_ = 0;
+        dropped_ = 0;
+    }
+
+    // Bytes currently retained.
+    size_t size() const
+    {
+        switch (mode_)
+        {
+        case Mode::Prefix:
+            return static_cast<size_t>(prefixCursor_);
+        case Mode::Ring:
+            return ringSize_;
+        case Mode::Unbounded:
+            return static_cast<size_t>(total_);
+        default:
+            return 0;
+        }
+    }
+
+    uint64_t totalBytes() const { return total_; }   // written since the last clear()
+    uint64_t droppedBytes() const { return dropped_; } // written but no longer retained
+    bool complete() const { return dropped_ == 0; }
+
+    // Copy of the retained bytes, oldest first.
+    std::string snapshot() const
+    {
+        std::string out;
+        out.reserve(size());
+        switch (mode_)
+        {
+        case Mode::Prefix:
+            out.assign(prefix_, static_cast<size_t>(prefixCursor_));
+            break;
+        case Mode::Ring:
+        {
+            const size_t start = (ringHead_ + ringCapacity_ - ringSize_) % ringCapacity_;
+            const size_t first = ringSize_ < ringCapacity_ - start ? ringSize_ : ringCapacity_ - start;
+            out.append(ring_.get() + start, first);
+            out.append(ring_.get(), ringSize_ - first);
+            break;
+        }
+        case Mode::Unbounded:
+            for (const std::string &chunk : chunks_)
+                out += chunk;
+            break;
+        default:
+            break;
+        }
+        return out;
+    }
+
+    // Calls fn(line) for each retained line without its "\r\n"/"\n". A line the
+    // ring cut off at its start is skipped, as is a trailing line with no
+    // newline yet unless includePartial is set.
+    template <typename Fn>
+    size_t forEachLine(Fn &&fn, bool includePartial = false) const
+    {
+        const std::string text = snapshot();
+        size_t pos = 0;
+        if (mode_ == Mode::Ring && !ringAtLineStart_)
+        {
+            const size_t newline = text.find('\n');
+            pos = newline == std::string::npos ? text.size() : newline + 1;
+        }
+        size_t count = 0;
+        while (pos < text.size())
+        {
+            size_t end = text.find('\n', pos);
+            if (end == std::string::npos && !includePartial)
+                break;
+            if (end == std::string::npos)
+                end = text.size();
+            size_t stop = end;
+            if (stop > pos && text[stop - 1] == '\r')
+                --stop;
+            fn(text.substr(pos, stop - pos));
+            ++count;
+            pos = end + 1;
+        }
+        return count;
+    }
+
+    std::vector<std::string> lines(bool includePartial = false) const
+    {
+        std::vector<std::string> out;
+        forEachLine([&](const std::string &line) { out.push_back(line); }, includePartial);
+        return out;
+    }
+
+private:
+    char *prefix_;
+    size_t prefixCapacity_;
+    int &prefixCursor_;
+    Mode mode_ = Mode::Prefix;
+
+    std::unique_ptr<char[]> ring_;
+    size_t ringCapacity_ = 0;
+    size_t ringHead_ = 0; // next write position
+    size_t ringSize_ = 0;
+    bool ringAtLineStart_ = true; // the last byte overwritten, if any, was '\n'
+
+    std::vector<std::string> chunks_;
+
+    uint64_t total_ = 0;
+    uint64_t dropped_ = 0;
+
+    void appendPrefix(const char *data, size_t len)
+    {
+        const size_t cursor = static_cast<size_t>(prefixCursor_);
+        const size_t room = prefixCapacity_ - 1 - cursor;
+        const size_t n = len < room ? len : room;
+        if (n > 0)
+        {
+            std::memcpy(prefix_ + cursor, data, n);
+            prefixCursor_ += static_cast<int>(n);
+            prefix_[prefixCursor_] = '\0';
+        }
+        dropped_ += len - n;
+    }
+
+    void appendRing(const char *data, size_t len)
+    {
+        if (len >= ringCapacity_)
+        {
+            if (len > ringCapacity_)
+                ringAtLineStart_ = data[len - ringCapacity_ - 1] == '\n';
+            else if (ringSize_ > 0)
+                ringAtLineStart_ = ring_[(ringHead_ + ringCapacity_ - 1) % ringCapacity_] == '\n';
+            dropped_ += ringSize_ + len - ringCapacity_;
+            std::memcpy(ring_.get(), data + len - ringCapacity_, ringCapacity_);
+            ringHead_ = 0;
+            ringSize_ = ringCapacity_;
+            return;
+        }
+        if (ringSize_ + len > ringCapacity_)
+        {
+            // The oldest bytes are about to be overwritten; remember the newest of them.
+            const size_t start = (ringHead_ + ringCapacity_ - ringSize_) % ringCapacity_;
+            const size_t evicted = ringSize_ + len - ringCapacity_;
+            ringAtLineStart_ = ring_[(start + evicted - 1) % ringCapacity_] == '\n';
+        }
+        const size_t first = len < ringCapacity_ - ringHead_ ? len : ringCapacity_ - ringHead_;
+        std::memcpy(ring_.get() + ringHead_, data, first);
+        std::memcpy(ring_.get(), data + first, len - first);
+        ringHead_ = (ringHead_ + len) % ringCapacity_;
+        if (ringSize_ + len > ringCapacity_)
+        {
+            dropped_ += ringSize_ + len - ringCapacity_;
+            ringSize_ = ringCapacity_;
+        }
+        else
+        {
+            ringSize_ += len;
+        }
+    }
+
+    void appendChunks(const char *data, size_t len)
+    {
+        while (len > 0)
+        {
+            if (chunks_.empty() || chunks_.back().size() == CHUNK_BYTES)
+            {
+                chunks_.emplace_back();
+                chunks_.back().reserve(CHUNK_BYTES);
+            }
+            std::string &chunk = chunks_.back();
+            const size_t n = len < CHUNK_BYTES - chunk.size() ? len : CHUNK_BYTES - chunk.size();
+            chunk.append(data, n);
+            data += n;
+            len -= n;
+        }
+    }
+};
+
+#endif // __cplusplus
+
+#endif // NATIVE_SERIAL_CAPTURE_H
@@ -0,0 +1,119 @@
+#ifndef NATIVE_SITL_SEQUENCER_H
+#define NATIVE_SITL_SEQUENCER_H
+
+#ifdef __cplusplus
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include "NumberFormat.h"
+
+/**
+ * SitlSequencer: windowed sim protocol support for a SITL-connected Stream.
+ *
+ * With `sim run --window N` the simulator keeps several packets in flight, each
+ * sent as "@<seq>|HITL/...". The envelope is stripped before the firmware sees
+ * the bytes, the sequence number of the last line the firmware started reading
+ * is tracked, and every outbound line is prefixed with "@<seq>|" so the
+ * simulator can match telemetry back to the packet that produced it.
+ *
+ * Nothing is prefixed until an envelope has been received, so lockstep
+ * simulators (window 1) see exactly the bytes the firmware wrote.
+ */
+class SitlSequencer
+{
+public:
+    static constexpr size_t PREFIX_BUFFER_SIZE = 24;
+    // Envelope bytes ('@' + digits) that decode() may emit on top of its input.
+    static constexpr int MAX_HELD_BYTES = 11;
+
+    bool active() const { return active_; }
+    uint32_t seq() const { return seq_; }
+
+    // Strips envelopes from `n` received bytes into `out` (room for n + MAX_HELD_BYTES);
+    // returns the number of payload bytes written.
+    size_t decode(const uint8_t *in, size_t n, uint8_t *out)
+    {
+        size_t w = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            const uint8_t c = in[i];
+            if (inEnvelope_)
+            {
+                if (c >= '0' && c <= '9' && envelopeLen_ < 10)
+                {
+                    envelope_[envelopeLen_++] = static_cast<char>(c);
+                    envelopeSeq_ = envelopeSeq_ * 10 + (c - '0');
+                    continue;
+                }
+                inEnvelope_ = false;
+                if (c == '|' && envelopeLen_ > 0)
+                {
+                    active_ = true;
+                    marks_.emplace_back(received_ + w, envelopeSeq_);
+                    atLineStart_ = false;
+                    continue;
+                }
+                // Not an envelope: pass the held bytes through as data.
+                out[w++] = '@';
+                for (int k = 0; k < envelopeLen_; ++k)
+                    out[w++] = static_cast<uint8_t>(envelope_[k]);
+            }
+            else if (atLineStart_ && c == '@')
+            {
+                inEnvelope_ = true;
+                envelopeLen_ = 0;
+                envelopeSeq_ = 0;
+                continue;
+            }
+            out[w++] = c;
+            atLineStart_ = c == '\n';
+        }
+        received_ += w;
+        return w;
+    }
+
+    // The firmware read `n` more payload bytes.
+    void consumed(size_t n)
+    {
+        consumed_ += n;
+        while (!marks_.empty() && marks_.front().first < consumed_)
+        {
+            seq_ = marks_.front().second;
+            marks_.pop_front();
+        }
+    }
+
+    // Formats "@<seq>|" into `out` (PREFIX_BUFFER_SIZE bytes); returns its length.
+    size_t formatPrefix(char *out) const
+    {
+        out[0] = '@';
+        size_t n = 1 + formatInteger(out + 1, seq_);
+        out[n++] = '|';
+        return n;
+    }
+
+    // Outbound line tracking: true when the next byte written starts a line.
+    bool txAtLineStart = true;
+
+    void reset()
+    {
+        *this = SitlSequencer();
+    }
+
+private:
+    bool active_ = false;
+    uint32_t seq_ = 0;
+    bool atLineStart_ = true;
+    bool inEnvelope_ = false;
+    char envelope_[10] = {};
+    int envelopeLen_ = 0;
+    uint32_t envelopeSeq_ = 0;
+    uint64_t received_ = 0; // payload bytes handed to the input buffer
+    uint64_t consumed_ = 0; // payload bytes read by the firmware
+    std::deque<std::pair<uint64_t, uint32_t>> marks_; // payload offset where a sequenced line starts
+};
+
+#endif // __cplusplus
+
+#endif // NATIVE_SITL_SEQUENCER_H
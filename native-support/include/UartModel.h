@@ -0,0 +1,160 @@
+#ifndef NATIVE_UART_MODEL_H
+#define NATIVE_UART_MODEL_H
+
+#ifdef __cplusplus
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * UartModel: line-rate and FIFO accounting for one serial port.
+ *
+ * A byte takes 10 bit times (8N1) on the wire. The TX FIFO drains at that rate
+ * against the native clock; a write that does not fit either stalls until enough
+ * bytes have drained (Blocking, like Arduino's HardwareSerial) or loses the excess
+ * (Drop). On the receive side bytes arrive no faster than the line rate and any
+ * that arrive while the RX FIFO is full are lost.
+ *
+ * Disabled (the default) means unlimited bandwidth and no FIFOs, the historical
+ * behaviour of the native Serial ports.
+ */
+class UartModel
+{
+public:
+    enum class Overflow
+    {
+        Blocking,
+        Drop,
+    };
+
+    struct Config
+    {
+        unsigned long baud = 0; // 0: use the rate passed to Stream::begin()
+        size_t txFifo = 64;
+        size_t rxFifo = 64;
+        Overflow overflow = Overflow::Blocking;
+    };
+
+    struct Stats
+    {
+        uint64_t txBytes = 0;
+        uint64_t txOverflowBytes = 0; // dropped by a full TX FIFO (Drop)
+        uint64_t stalls = 0;          // writes that had to wait for room (Blocking)
+        uint64_t stallMicros = 0;     // total time those writes waited
+        size_t txHighWater = 0;
+        uint64_t rxBytes = 0;
+        uint64_t rxOverflowBytes = 0; // arrived while the RX FIFO was full
+    };
+
+    void configure(const Config &config, unsigned long beginBaud)
+    {
+        config_ = config;
+        enabled_ = true;
+        setBaud(config.baud ? config.baud : beginBaud);
+        reset();
+    }
+
+    void disable() { enabled_ = false; }
+    bool enabled() const { return enabled_ && byteMicros_ > 0.0; }
+    const Config &config() const { return config_; }
+
+    // Called from Stream::begin(); only applies when the config left baud at 0.
+    void begin(unsigned long baud)
+    {
+        if (config_.baud == 0)
+            setBaud(baud);
+    }
+
+    void reset()
+    {
+        stats_ = Stats();
+        txBusyUntil_ = 0.0;
+        rxLastMicros_ = -1.0;
+        rxCredit_ = 0.0;
+    }
+
+    const Stats &stats() const { return stats_; }
+
+    // Bytes still waiting in the TX FIFO at `now`.
+    size_t txQueued(uint64_t now) const
+    {
+        const double pending = txBusyUntil_ - static_cast<double>(now);
+        if (pending <= 0.0)
+            return 0;
+        const size_t bytes = static_cast<size_t>(pending / byteMicros_ + 0.999999);
+        return bytes < config_.txFifo ? bytes : config_.txFifo;
+    }
+
+    size_t availableForWrite(uint64_t now) const { return config_.txFifo - txQueued(now); }
+
+    // Queues `len` bytes at `now`; returns how many were accepted and, for a
+    // Blocking port, how long the writer must wait in `stallMicros`.
+    size_t acceptTx(size_t len, uint64_t now, uint64_t &stallMicros)
+    {
+        stallMicros = 0;
+        const double t = static_cast<double>(now);
+        const size_t room = availableForWrite(now);
+        size_t accepted = len;
+        if (len > room)
+        {
+            if (config_.overflow == Overflow::Drop)
+            {
+                accepted = room;
+                stats_.txOverflowBytes += len - room;
+            }
+            else
+            {
+                stallMicros = static_cast<uint64_t>((len - room) * byteMicros_ + 0.5);
+                ++stats_.stalls;
+                stats_.stallMicros += stallMicros;
+            }
+        }
+        txBusyUntil_ = (txBusyUntil_ > t ? txBusyUntil_ : t) + accepted * byteMicros_;
+        stats_.txBytes += accepted;
+        const size_t queued = txQueued(now + stallMicros);
+        if (queued > stats_.txHighWater)
+            stats_.txHighWater = queued;
+        return accepted;
+    }
+
+    // How many bytes may arrive from the wire by `now`.
+    size_t rxArrivals(uint64_t now)
+    {
+        const double t = static_cast<double>(now);
+        if (rxLastMicros_ < 0.0 || t < rxLastMicros_)
+            rxLastMicros_ = t;
+        rxCredit_ += (t - rxLastMicros_) / byteMicros_;
+        rxLastMicros_ = t;
+        // A silent line does not bank unlimited credit.
+        const double cap = static_cast<double>(config_.rxFifo) + 256.0;
+        if (rxCredit_ > cap)
+            rxCredit_ = cap;
+        return static_cast<size_t>(rxCredit_);
+    }
+
+    // Records `arrived` bytes from the wire with `unread` already buffered;
+    // returns how many fit in the RX FIFO (the rest are lost).
+    size_t acceptRx(size_t arrived, size_t unread)
+    {
+        rxCredit_ -= static_cast<double>(arrived);
+        const size_t room = unread < config_.rxFifo ? config_.rxFifo - unread : 0;
+        const size_t kept = arrived < room ? arrived : room;
+        stats_.rxBytes += kept;
+        stats_.rxOverflowBytes += arrived - kept;
+        return kept;
+    }
+
+private:
+    Config config_;
+    bool enabled_ = false;
+    double byteMicros_ = 0.0;
+    double txBusyUntil_ = 0.0; // when the last queued byte leaves the wire
+    double rxLastMicros_ = -1.0;
+    double rxCredit_ = 0.0;
+    Stats stats_;
+
+    void setBaud(unsigned long baud) { byteMicros_ = baud ? 10.0e6 / static_cast<double>(baud) : 0.0; }
+};
+
+#endif // __cplusplus
+
+#endif // NATIVE_UART_MODEL_H
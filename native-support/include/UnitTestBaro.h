@@ -0,0 +1,89 @@
+#ifndef UNIT_TEST_BARO_H
+#define UNIT_TEST_BARO_H
+
+#include <cmath>
+#include <Sensors/Baro/Barometer.h>
+
+using namespace astra;
+
+class FakeBarometer : public Barometer
+{
+public:
+    bool _healthy = true;
+    double _altitude = 0.0;
+    bool _shouldFailInit = false;
+
+    FakeBarometer() : Barometer(), fakeAlt(0), fakeAltSet(false)
+    {
+        setName("FakeBarometer");
+    }
+    ~FakeBarometer() {}
+
+    void reset()
+    {
+        initialized = false;
+    }
+
+    int read() override
+    {
+        pressure = fakeP;
+        temp = fakeT;
+        healthy = _healthy;  // Update health status when reading
+        return 0;
+    }
+
+    // Override update() to prevent recalculation when altitude is set directly
+    int update() override
+    {
+        if (read() != 0)
+            return -1;
+        // Only calculate altitude from pressure if it wasn't set directly
+        if (!fakeAltSet) {
+            altitudeASL = calcAltitude(pressure);
+        }
+        // If altitude was set directly, altitudeASL is already correct
+        return 0;
+    }
+
+    // Helper to set altitude directly
+    void setAltitude(double altM)
+    {
+        fakeAlt = altM;
+        _altitude = altM;
+        fakeAltSet = true;
+        // Calculate corresponding pressure for consistency
+        fakeP = 101325.0 * pow(1.0 - altM / 44330.0, 5.255);
+        fakeT = 15.0 - altM * 0.0065;
+        pressure = fakeP;
+        temp = fakeT;
+        // Directly set the altitude in the base class
+        altitudeASL = altM;
+    }
+
+    void set(double p, double t)
+    {
+        pressure = fakeP = p;
+        temp = fakeT = t;
+        fakeAltSet = false;
+    }
+
+    // Only override init() and read() like hardware sensors
+    int init() override
+    {
+        if (_shouldFailInit) {
+            return -1;
+        }
+        initialized = true;
+        healthy = true;
+        return 0;
+    }
+
+    bool isHealthy() const override { return _healthy; }
+
+    double fakeP = 101325.0;  // Default to sea level
+    double fakeT = 20.0;      // Default to 20C
+    double fakeAlt = 0.0;
+    int fakeAltSet = false;
+};
+
+#endif // UNIT_TEST_BARO_H
@@ -0,0 +1,27 @@
+#ifndef UNIT_TEST_FAKE_SENSOR_H
+#define UNIT_TEST_FAKE_SENSOR_H
+
+#include <Sensors/Sensor.h>
+
+using namespace astra;
+
+class FakeSensor : public Sensor
+{
+public:
+    FakeSensor(const char *name = "FakeSensor") : Sensor(name) {}
+    ~FakeSensor() {}
+
+    int init() override
+    {
+        initialized = true;
+        healthy = true;
+        return 0;
+    }
+
+    int read() override
+    {
+        return 0;
+    }
+};
+
+#endif // UNIT_TEST_FAKE_SENSOR_H
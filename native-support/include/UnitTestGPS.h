@@ -0,0 +1,81 @@
+#ifndef UNIT_TEST_GPS_H
+#define UNIT_TEST_GPS_H
+
+#include <Sensors/GPS/GPS.h>
+
+using namespace astra;
+
+class FakeGPS : public GPS
+{
+public:
+    bool _healthy = true;
+    bool _hasFix = false;
+    bool _shouldFailInit = false;
+
+    FakeGPS() : GPS()
+    {
+        setName("FakeGPS");
+    }
+    ~FakeGPS() {}
+
+    void reset()
+    {
+        initialized = false;
+    }
+
+    int read() override {
+        // Don't override fixQual or hasFix - they may have been set by test code
+        // GPS::update() will handle the hasFix logic based on fixQual
+        healthy = _healthy;  // Update health status when reading
+        return 0;
+    }
+    void set(double lat, double lon, double alt)
+    {
+        position.x() = lat;
+        position.y() = lon;
+        position.z() = alt;
+    }
+    void setHeading(double h)
+    {
+        heading = h;
+    }
+    void setDateTime(int y, int m, int d, int h, int mm, int s)
+    {
+        year = y;
+        month = m;
+        day = d;
+        hr = h;
+        min = mm;
+        sec = s;
+        snprintf(tod, 12, "%02d:%02d:%02d", hr, min, sec); // size is really 9 but 12 ignores warnings about truncation. IRL it will never truncate
+    }
+
+    // Only override init() and read() like hardware sensors
+    int init() override
+    {
+        if (_shouldFailInit) {
+            return -1;
+        }
+        initialized = true;
+        healthy = true;
+        return 0;
+    }
+
+    void setHasFirstFix(int fix)
+    {
+        _hasFix = fix;
+        hasFix = fix;
+        if (fix)
+            fixQual = 4;
+        else
+            fixQual = 0;
+    }
+    void setFixQual(int qual)
+    {
+        fixQual = qual;
+    }
+    // Don't override getHasFix() - let GPS::update() manage hasFix based on fixQual
+    bool isHealthy() const override { return _healthy; }
+};
+
+#endif // UNIT_TEST_GPS_H
@@ -0,0 +1,81 @@
+#ifndef UNIT_TEST_IMU_H
+#define UNIT_TEST_IMU_H
+
+#include <Sensors/IMU/IMU6DoF.h>
+#include <Sensors/IMU/IMU9DoF.h>
+#include <Math/Vector.h>
+
+using namespace astra;
+
+class FakeIMU : public IMU6DoF
+{
+public:
+    FakeIMU() : IMU6DoF("FakeIMU")
+    {
+    }
+    ~FakeIMU() {}
+
+    int init() override
+    {
+        acc = Vector<3>{0, 0, -9.81};
+        angVel = Vector<3>{0, 0, 0};
+        initialized = true;
+        healthy = true;
+        return 0;
+    }
+
+    int read() override
+    {
+        return 0;
+    }
+
+    void set(Vector<3> accel, Vector<3> gyro, Vector<3> mag = Vector<3>{0, 0, 0})
+    {
+        acc = accel;
+        angVel = gyro;
+        // Note: IMU6DoF doesn't have magnetometer, so mag is ignored
+    }
+
+    void reset()
+    {
+        initialized = false;
+    }
+};
+
+class FakeIMU9DoF : public IMU9DoF
+{
+public:
+    FakeIMU9DoF() : IMU9DoF("FakeIMU9DoF")
+    {
+    }
+    ~FakeIMU9DoF() {}
+
+    int init() override
+    {
+        acc = Vector<3>{0, 0, -9.81};
+        angVel = Vector<3>{0, 0, 0};
+        mag = Vector<3>{20, 0, 0};
+        initialized = true;
+        healthy = true;
+        return 0;
+    }
+
+    int read() override
+    {
+        return 0;
+    }
+
+    void set(Vector<3> accel, Vector<3> gyro, Vector<3> magField)
+    {
+        acc = accel;
+        angVel = gyro;
+        mag = magField;
+    }
+
+    void reset()
+    {
+        initialized = false;
+    }
+};
+
+#endif // UNIT_TEST_IMU_H
@@ -0,0 +1,158 @@
+#ifndef UNIT_TEST_INERTIAL_H
+#define UNIT_TEST_INERTIAL_H
+
+#include <Sensors/Accel/Accel.h>
+#include <Sensors/Gyro/Gyro.h>
+#include <Sensors/Mag/Mag.h>
+#include <Math/Vector.h>
+
+using namespace astra;
+
+class FakeAccel : public Accel
+{
+public:
+    bool _healthy = true;
+    Vector<3> _reading = Vector<3>(0, 0, -9.81);  // Match test expectations
+    bool _shouldFailInit = false;
+
+    FakeAccel() : Accel("FakeAccel")
+    {
+    }
+    ~FakeAccel() {}
+
+    // Only override init() and read() like hardware sensors
+    int init() override
+    {
+        if (_shouldFailInit) {
+            return -1;
+        }
+        acc = _reading;
+        initialized = true;
+        healthy = true;
+        return 0;
+    }
+
+    int read() override
+    {
+        acc = _reading;
+        healthy = _healthy;  // Update health status when reading
+        return 0;
+    }
+
+    void set(Vector<3> accel)
+    {
+        _reading = accel;
+        acc = accel;
+    }
+
+    bool isHealthy() const override { return _healthy; }
+
+    void reset()
+    {
+        initialized = false;
+    }
+};
+
+class FakeGyro : public Gyro
+{
+public:
+    bool _healthy = true;
+    Vector<3> _reading = Vector<3>(0, 0, 0);
+    bool _shouldFailInit = false;
+
+    FakeGyro() : Gyro("FakeGyro")
+    {
+    }
+    ~FakeGyro() {}
+
+    // Only override init() and read() like hardware sensors
+    int init() override
+    {
+        if (_shouldFailInit) {
+            return -1;
+        }
+        angVel = _reading;
+        initialized = true;
+        healthy = true;
+        return 0;
+    }
+
+    int read() override
+    {
+        angVel = _reading;
+        healthy = _healthy;  // Update health status when reading
+        return 0;
+    }
+
+    void set(Vector<3> gyro)
+    {
+        _reading = gyro;
+        angVel = gyro;
+    }
+
+    bool isHealthy() const override { return _healthy; }
+
+    void reset()
+    {
+        initialized = false;
+    }
+};
+
+class FakeMag : public Mag
+{
+public:
+    bool _healthy = true;
+    Vector<3> _reading = Vector<3>(0, 0, 0);  // Default to zero
+    bool _shouldFailInit = false;
+
+    FakeMag() : Mag("FakeMag")
+    {
+    }
+    ~FakeMag() {}
+
+    // Only override init() and read() like hardware sensors
+    int init() override
+    {
+        if (_shouldFailInit) {
+            return -1;
+        }
+        mag = _reading;
+        initialized = true;
+        healthy = true;
+        return 0;
+    }
+
+    int read() override
+    {
+        mag = _reading;
+        healthy = _healthy;  // Update health status when reading
+        return 0;
+    }
+
+    void set(Vector<3> magField)
+    {
+        _reading = magField;
+        mag = magField;
+    }
+
+    bool isHealthy() const override { return _healthy; }
+
+    void reset()
+    {
+        initialized = false;
+    }
+};
+
+// Failing sensor for testing error handling
+class FakeFailingAccel : public Accel {
+public:
+    FakeFailingAccel() : Accel("FailingAccel") {}
+    // Only override init() and read() like hardware sensors
+    int init() override { return -1; }  // Fail
+    int read() override {
+        acc = Vector<3>(0, 0, 0);
+        return 0;
+    }
+};
+
+#endif // UNIT_TEST_INERTIAL_H
@@ -0,0 +1,42 @@
+#ifndef UNIT_TEST_VOLTAGE_H
+#define UNIT_TEST_VOLTAGE_H
+
+#include <Sensors/VoltageSensor/VoltageSensor.h>
+
+using namespace astra;
+
+class MockVoltageSensor : public VoltageSensor
+{
+public:
+    bool initCalled = false;
+    bool readCalled = false;
+    int storedPin;
+
+    MockVoltageSensor(int pin, const char *name = "MockVoltage")
+        : VoltageSensor(pin, name), storedPin(pin) {}
+    MockVoltageSensor(int pin, int r1, int r2, const char *name = "MockVoltage", double refVoltage = 3.3)
+        : VoltageSensor(pin, r1, r2, name, refVoltage), storedPin(pin) {}
+
+    int init() override
+    {
+        initCalled = true;
+        initialized = true;
+        healthy = true;
+        return 0;
+    }
+
+    int read() override
+    {
+        readCalled = true;
+        // Call the parent class read() which will use analogRead()
+        return VoltageSensor::read();
+    }
+
+    // Helper to set the mock ADC value for this sensor's pin
+    void setMockRawValue(int value)
+    {
+        setMockAnalogRead(storedPin, value);
+    }
+};
+
+#endif // UNIT_TEST_VOLTAGE_H
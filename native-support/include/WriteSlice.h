@@ -0,0 +1,18 @@
+#ifndef NATIVE_WRITE_SLICE_H
+#define NATIVE_WRITE_SLICE_H
+
+#include <cstddef>
+#include <cstdint>
+
+// One piece of a scatter-gather write (Print::writev, SITLSocket::writev).
+struct WriteSlice
+{
+    const uint8_t *data;
+    size_t len;
+};
+
+// Slices a native write builds on the stack before sending them as one batch;
+// well under IOV_MAX everywhere.
+static const size_t WRITE_SLICE_BATCH = 64;
+
+#endif // NATIVE_WRITE_SLICE_H
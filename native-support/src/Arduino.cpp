@@ -1,5 +1,6 @@
 #include "Arduino.h"
 #include "SITLSocket.h"
+#include <chrono>
 #include <iostream>
 #include <map>
 
@@ -133,7 +134,34 @@ Stream::~Stream()
     disconnectSITL();
 }
 
-void Stream::begin(int baud) {}
+void Stream::begin(int baud)
+{
+    baudRate = baud > 0 ? static_cast<unsigned long>(baud) : 0;
+    uart.begin(baudRate);
+}
+
+int Stream::availableForWrite()
+{
+    if (!uart.enabled()) {
+        return INT_MAX;  // unlimited
+    }
+    return static_cast<int>(uart.availableForWrite(micros()));
+}
+
+size_t Stream::uartAcceptTx(size_t len)
+{
+    if (!uart.enabled()) {
+        return len;
+    }
+    uint64_t stallMicros = 0;
+    size_t accepted = uart.acceptTx(len, micros(), stallMicros);
+    // A blocking write really waits on the wall clock; under setMillis() the
+    // stall is only counted so the test keeps control of time.
+    if (stallMicros > 0 && !useFakeMillis) {
+        spin_wait_us(stallMicros);
+    }
+    return accepted;
+}
 void Stream::setTimeout(unsigned long timeout)
 {
     timeoutMs = timeout;
@@ -151,8 +179,7 @@ void Stream::end()
 
 void Stream::clearBuffer()
 {
-    cursor = 0;
-    fakeBuffer[0] = '\0';
+    outputCapture.clear();
     inputCursor = 0;
     inputLength = 0;
     inputBuffer[0] = '\0';
@@ -171,22 +198,58 @@ void Stream::pollSITLInput()
         inputLength = 0;
     }
 
-    // Check if there's room in the input buffer
-    int roomAvailable = sizeof(inputBuffer) - inputLength;
+    // Check if there's room in the input buffer (keeping space for the terminator
+    // and for envelope bytes the sequencer may still be holding back)
+    int roomAvailable = static_cast<int>(sizeof(inputBuffer)) - 1 - SitlSequencer::MAX_HELD_BYTES - inputLength;
+
+    uint8_t tempBuffer[256];
+    if (uart.enabled()) {
+        // Bytes come off the wire at line rate whether or not the firmware keeps
+        // up; those that find the RX FIFO full are lost.
+        size_t arrivals = uart.rxArrivals(micros());
+        if (arrivals == 0) {
+            return;
+        }
+        if (arrivals > sizeof(tempBuffer)) {
+            arrivals = sizeof(tempBuffer);
+        }
+        int bytesRead = sitlSocket->read(tempBuffer, arrivals);
+        if (bytesRead <= 0) {
+            return;
+        }
+        size_t kept = uart.acceptRx(bytesRead, inputLength - inputCursor);
+        if (kept > static_cast<size_t>(roomAvailable > 0 ? roomAvailable : 0)) {
+            kept = roomAvailable > 0 ? roomAvailable : 0;  // input buffer overrun
+        }
+        appendSITLInput(tempBuffer, kept);
+        return;
+    }
+
     if (roomAvailable <= 0) {
         return; // Buffer full
     }
 
     // Read available data from SITL socket
-    uint8_t tempBuffer[256];
     int bytesRead = sitlSocket->read(tempBuffer, sizeof(tempBuffer) < roomAvailable ? sizeof(tempBuffer) : roomAvailable);
 
     if (bytesRead > 0) {
-        // Append to input buffer
-        memcpy(inputBuffer + inputLength, tempBuffer, bytesRead);
-        inputLength += bytesRead;
-        inputBuffer[inputLength] = '\0';
+        appendSITLInput(tempBuffer, bytesRead);
+    }
+}
+
+void Stream::appendSITLInput(const uint8_t *data, size_t len)
+{
+    // Strip windowed-protocol envelopes ("@<seq>|") before the firmware sees the bytes
+    uint8_t payload[256 + SitlSequencer::MAX_HELD_BYTES];
+    size_t n = sitlSequencer.decode(data, len < 256 ? len : 256, payload);
+
+    size_t room = sizeof(inputBuffer) - 1 - inputLength;
+    if (n > room) {
+        n = room;
     }
+    memcpy(inputBuffer + inputLength, payload, n);
+    inputLength += n;
+    inputBuffer[inputLength] = '\0';
 }
 
 bool Stream::available()
@@ -206,6 +269,7 @@ int Stream::read()
     {
         return -1;
     }
+    sitlSequencer.consumed(1);
     return (uint8_t)inputBuffer[inputCursor++];
 }
 
@@ -279,6 +343,38 @@ size_t Stream::readBytes(uint8_t *buffer, size_t length)
     return readBytes((char *)buffer, length);
 }
 
+std::string String::formatFloat(double value, unsigned int digits)
+{
+    char buf[NUMBER_FORMAT_BUFFER_SIZE];
+    return std::string(buf, formatFixed(buf, value, static_cast<int>(digits)));
+}
+
+void String::trim()
+{
+    size_t first = str.find_first_not_of(" \t\r\n");
+    if (std::string::npos == first) {
+        str = "";
+    } else {
+        size_t last = str.find_last_not_of(" \t\r\n");
+        str = str.substr(first, (last - first + 1));
+    }
+}
+
+long String::toInt() const
+{
+    try { return std::stol(str); } catch (...) { return 0; }
+}
+
+float String::toFloat() const
+{
+    try { return std::stof(str); } catch (...) { return 0.0f; }
+}
+
+double String::toDouble() const
+{
+    try { return std::stod(str); } catch (...) { return 0.0; }
+}
+
 String Stream::readStringUntil(char terminator)
 {
     String ret = "";
@@ -294,20 +390,104 @@ String Stream::readStringUntil(char terminator)
 
 size_t Stream::write(uint8_t b)
 {
-    // Write to fake buffer for debugging/logging
-    if (cursor < sizeof(fakeBuffer) - 1) {
-        fakeBuffer[cursor++] = b;
-        fakeBuffer[cursor] = '\0';
-    }
-    // std::cout << b;
+    return write(&b, 1);
+}
 
+size_t Stream::write(const uint8_t *buf, size_t len)
+{
+    len = uartAcceptTx(len);
+    outputCapture.append(buf, len);
 
     // If SITL is connected, send to external simulator
     if (sitlSocket && sitlSocket->isConnected()) {
-        sitlSocket->write(&b, 1);
+        if (sitlSequencer.active()) {
+            const WriteSlice slice = {buf, len};
+            sendSequenced(&slice, 1);
+        } else {
+            sitlSocket->write(buf, len);
+        }
     }
 
-    return 1;
+    return len;
+}
+
+void Stream::sendSequenced(const WriteSlice *slices, size_t count)
+{
+    // Prefix every outbound line with the sequence number of the last packet read
+    char prefix[SitlSequencer::PREFIX_BUFFER_SIZE];
+    const WriteSlice prefixSlice = {reinterpret_cast<const uint8_t *>(prefix), sitlSequencer.formatPrefix(prefix)};
+    WriteSlice out[WRITE_SLICE_BATCH];
+    size_t used = 0;
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t *p = slices[i].data;
+        const uint8_t *end = p + slices[i].len;
+        while (p < end) {
+            if (used + 2 > WRITE_SLICE_BATCH) {
+                // Lines are only split across sends on very long records
+                sitlSocket->writev(out, used);
+                used = 0;
+            }
+            if (sitlSequencer.txAtLineStart) {
+                out[used++] = prefixSlice;
+                sitlSequencer.txAtLineStart = false;
+            }
+            const uint8_t *newline = static_cast<const uint8_t *>(memchr(p, '\n', end - p));
+            const uint8_t *stop = newline ? newline + 1 : end;
+            out[used++] = {p, static_cast<size_t>(stop - p)};
+            if (newline) {
+                sitlSequencer.txAtLineStart = true;
+            }
+            p = stop;
+        }
+    }
+    if (used > 0) {
+        sitlSocket->writev(out, used);
+    }
+}
+
+void Stream::forwardSlices(const WriteSlice *slices, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        outputCapture.append(slices[i].data, slices[i].len);
+    }
+
+    // One sendmsg()/WSASend() for the whole record
+    if (count > 0 && sitlSocket && sitlSocket->isConnected()) {
+        if (sitlSequencer.active()) {
+            sendSequenced(slices, count);
+        } else {
+            sitlSocket->writev(slices, count);
+        }
+    }
+}
+
+size_t Stream::writev(const WriteSlice *slices, size_t count)
+{
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += slices[i].len;
+    }
+
+    size_t accepted = uartAcceptTx(total);
+    if (accepted == total) {
+        forwardSlices(slices, count);
+        return accepted;
+    }
+
+    // A dropping UART kept only the first `accepted` bytes; send those.
+    WriteSlice kept[WRITE_SLICE_BATCH];
+    size_t used = 0;
+    for (size_t i = 0, left = accepted; i < count && left > 0; i++) {
+        size_t n = slices[i].len < left ? slices[i].len : left;
+        kept[used++] = {slices[i].data, n};
+        left -= n;
+        if (used == WRITE_SLICE_BATCH) {
+            forwardSlices(kept, used);
+            used = 0;
+        }
+    }
+    forwardSlices(kept, used);
+    return accepted;
 }
 
 bool Stream::connectSITL(const char* host, int port)
@@ -320,6 +500,7 @@ bool Stream::connectSITL(const char* host, int port)
         sitlSocket->disconnect();
     }
 
+    sitlSequencer.reset();
     return sitlSocket->connect(host, port);
 }
 
@@ -0,0 +1,61 @@
+#include "Print.h"
+
+#include <cstdio>
+#include <new>
+
+// Format into one stack buffer (plus optional newline) and issue a single write.
+size_t Print::printFixed(double d, int precision, bool newline)
+{
+    char buf[NUMBER_FORMAT_BUFFER_SIZE + 1];
+    size_t n = formatFixed(buf, d, precision);
+    if (newline)
+        buf[n++] = '\n';
+    return write(reinterpret_cast<const uint8_t *>(buf), n);
+}
+
+size_t Print::vprintf(const char *fmt, va_list ap)
+{
+    if (!fmt)
+        return 0;
+
+    // Single pass into a stack buffer; only output that does not fit pays for
+    // a second formatting pass into an exact-size heap buffer.
+    va_list ap_copy;
+    va_copy(ap_copy, ap);
+    char buf[256];
+    int needed = vsnprintf(buf, sizeof(buf), fmt, ap_copy);
+    va_end(ap_copy);
+    if (needed <= 0)
+        return 0; // formatting error or empty
+    if (static_cast<size_t>(needed) < sizeof(buf))
+        return write(reinterpret_cast<const uint8_t *>(buf), static_cast<size_t>(needed));
+
+    char *heap = new (std::nothrow) char[static_cast<size_t>(needed) + 1];
+    if (!heap)
+        return 0;
+    int n = vsnprintf(heap, static_cast<size_t>(needed) + 1, fmt, ap);
+    size_t wrote = 0;
+    if (n > 0)
+        wrote = write(reinterpret_cast<const uint8_t *>(heap), static_cast<size_t>(n));
+    delete[] heap;
+    return wrote;
+}
+
+size_t Print::printf(const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    size_t wrote = vprintf(fmt, ap);
+    va_end(ap);
+    return wrote;
+}
+
+size_t Print::printlnf(const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    size_t wrote = vprintf(fmt, ap);
+    va_end(ap);
+    wrote += write(reinterpret_cast<const uint8_t *>("\n"), 1);
+    return wrote;
+}
@@ -13,8 +13,10 @@
     #define CLOSE_SOCKET closesocket
 #else
     #include <sys/socket.h>
+    #include <sys/uio.h>
     #include <sys/ioctl.h>
     #include <netinet/in.h>
+    #include <netinet/tcp.h>
     #include <arpa/inet.h>
     #include <unistd.h>
     #include <fcntl.h>
@@ -173,6 +175,11 @@ bool SITLSocket::connect(const char *host, int port)
     }
 #endif
 
+    // Telemetry lines are small and latency-bound; don't let Nagle hold them
+    // back waiting for the simulator's delayed ACK.
+    int noDelay = 1;
+    setsockopt(socketFd, IPPROTO_TCP, TCP_NODELAY, (const char*)&noDelay, sizeof(noDelay));
+
     connected = true;
     printf("SITL: Connected to %s:%d\n", host, port);
     return true;
@@ -227,6 +234,79 @@ int SITLSocket::write(const uint8_t* data, size_t len)
     return totalSent;
 }
 
+int SITLSocket::writev(const WriteSlice* slices, size_t count)
+{
+    if (!connected || socketFd == INVALID_SOCKET_VALUE) {
+        return -1;
+    }
+
+    int totalSent = 0;
+    size_t index = 0;   // first slice not fully sent
+    size_t offset = 0;  // bytes of slices[index] already sent
+    while (index < count) {
+#ifdef _WIN32
+        WSABUF bufs[WRITE_SLICE_BATCH];
+#else
+        struct iovec bufs[WRITE_SLICE_BATCH];
+#endif
+        size_t n = 0;
+        for (size_t i = index; i < count && n < WRITE_SLICE_BATCH; i++) {
+            size_t skip = (i == index) ? offset : 0;
+            if (slices[i].len <= skip) {
+                continue;
+            }
+#ifdef _WIN32
+            bufs[n].buf = (char*)(slices[i].data + skip);
+            bufs[n].len = (ULONG)(slices[i].len - skip);
+#else
+            bufs[n].iov_base = (void*)(slices[i].data + skip);
+            bufs[n].iov_len = slices[i].len - skip;
+#endif
+            n++;
+        }
+        if (n == 0) {
+            break;
+        }
+
+#ifdef _WIN32
+        DWORD bytesSent = 0;
+        int sent = WSASend(socketFd, bufs, (DWORD)n, &bytesSent, 0, NULL, NULL) == SOCKET_ERROR ? SOCKET_ERROR : (int)bytesSent;
+#else
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = bufs;
+        msg.msg_iovlen = n;
+        int sent = (int)sendmsg(socketFd, &msg, 0);
+#endif
+        if (sent == SOCKET_ERROR) {
+#ifdef _WIN32
+            if (WSAGetLastError() == WSAEWOULDBLOCK) {
+                continue;
+            }
+#else
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                continue;
+            }
+#endif
+            fprintf(stderr, "SITL: Send error: %d\n", SOCKET_ERROR_CODE);
+            disconnect();
+            return -1;
+        }
+        totalSent += sent;
+
+        // Skip past what the kernel accepted; a short send resumes mid-slice.
+        size_t remaining = (size_t)sent;
+        while (index < count && remaining >= slices[index].len - offset) {
+            remaining -= slices[index].len - offset;
+            offset = 0;
+            index++;
+        }
+        offset += remaining;
+    }
+
+    return totalSent;
+}
+
 int SITLSocket::read(uint8_t* buffer, size_t maxLen)
 {
     if (!connected || socketFd == INVALID_SOCKET_VALUE) {
@@ -0,0 +1,49 @@
+"""Precompiles the native Arduino shim for the project and test sources.
+
+PlatformIO post script for the managed `native` env. Every test and project
+translation unit includes Arduino.h, so the header is compiled once per build
+directory into a PCH and force-included with `-include`. GCC and Clang fall back
+to parsing the header when the PCH does not match the flags (-Winvalid-pch warns).
+
+Set `custom_native_pch = no` in the env to turn it off.
+"""
+
+import os
+
+Import("env")  # noqa: F821  (provided by SCons)
+
+PCH_HEADER = "astra_native_pch.h"
+PCH_INCLUDES = ("Arduino.h",)
+
+
+def _enabled(build_env) -> bool:
+    value = str(build_env.GetProjectOption("custom_native_pch", "yes")).strip().lower()
+    return value not in {"no", "false", "off", "0"}
+
+
+def _pch_suffix(build_env) -> str:
+    return ".pch" if "clang" in os.path.basename(build_env.subst("$CXX")) else ".gch"
+
+
+def _add_pch(build_env) -> None:
+    pch_dir = os.path.join(build_env.subst("$BUILD_DIR"), "astra_pch")
+    os.makedirs(pch_dir, exist_ok=True)
+    header = os.path.join(pch_dir, PCH_HEADER)
+    text = "".join(f"#include <{name}>\n" for name in PCH_INCLUDES)
+    if not os.path.exists(header) or open(header, encoding="utf-8").read() != text:
+        with open(header, "w", encoding="utf-8") as handle:
+            handle.write(text)
+
+    # Clone before adding -include so the PCH is not built against itself.
+    pch_env = build_env.Clone()
+    pch = pch_env.Command(
+        header + _pch_suffix(build_env),
+        header,
+        "$CXX -x c++-header -o $TARGET -c $CXXFLAGS $CCFLAGS $_CCCOMCOM $SOURCE",
+    )
+    build_env.Append(CXXFLAGS=["-include", header, "-Winvalid-pch"])
+    build_env.Depends(build_env.get("PIOBUILDFILES", []), pch)
+
+
+if _enabled(env):  # noqa: F821
+    _add_pch(env)  # noqa: F821
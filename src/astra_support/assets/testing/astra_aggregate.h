@@ -0,0 +1,29 @@
+#ifndef ASTRA_AGGREGATE_H
+#define ASTRA_AGGREGATE_H
+
+// Registry for `astra-support test --aggregate`. Each test folder is compiled
+// into one program with its main, setUp and tearDown renamed per suite; the
+// generated suite wrappers register them here and astra_aggregate_main.cpp
+// runs them.
+
+struct AstraSuite
+{
+    const char *name;
+    int (*run)(int argc, char **argv);
+    void (*setUp)(void);
+    void (*tearDown)(void);
+    void (*reset)(); // optional astraSuiteReset() of the suite, called before it runs
+};
+
+void astraRegisterSuite(const AstraSuite &suite);
+
+struct AstraSuiteRegistrar
+{
+    explicit AstraSuiteRegistrar(const AstraSuite &suite) { astraRegisterSuite(suite); }
+};
+
+// Suites declare main as `int main()` or `int main(int, char **)`.
+inline int astraCallMain(int (*fn)(), int, char **) { return fn(); }
+inline int astraCallMain(int (*fn)(int, char **), int argc, char **argv) { return fn(argc, argv); }
+
+#endif // ASTRA_AGGREGATE_H
@@ -0,0 +1,160 @@
+// Runner for `astra-support test --aggregate`.
+//
+//   program [--list] [--suite NAME]... [--shard I/N] [--no-fork]
+//
+// Suites run in name order; --shard I/N runs every N-th suite starting at I so
+// several copies of the program can split the work. On POSIX each suite runs
+// in a forked child, so its globals and any crash stay out of the next suite.
+// With --no-fork (and on Windows) suites share the process and only their
+// astraSuiteReset() hook resets state between them.
+//
+// Each suite's output is framed by lines the Python side splits on:
+//   ::astra-suite-begin NAME
+//   ::astra-suite-end NAME CODE MILLISECONDS
+
+#include "astra_aggregate.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#define ASTRA_AGGREGATE_FORK 1
+#endif
+
+namespace
+{
+std::vector<AstraSuite> &suites()
+{
+    static std::vector<AstraSuite> registered;
+    return registered;
+}
+
+const AstraSuite *current = nullptr;
+
+int runInProcess(const AstraSuite &suite, char *program)
+{
+    current = &suite;
+    if (suite.reset)
+        suite.reset();
+    char *argv[] = {program, nullptr};
+    const int code = suite.run(1, argv);
+    std::fflush(stdout);
+    current = nullptr;
+    return code;
+}
+
+int runSuite(const AstraSuite &suite, char *program, bool fork_suites)
+{
+#ifdef ASTRA_AGGREGATE_FORK
+    if (fork_suites)
+    {
+        std::fflush(stdout);
+        std::fflush(stderr);
+        const pid_t pid = fork();
+        if (pid == 0)
+            _exit(runInProcess(suite, program) == 0 ? 0 : 1);
+        if (pid > 0)
+        {
+            int status = 0;
+            waitpid(pid, &status, 0);
+            if (WIFEXITED(status))
+                return WEXITSTATUS(status);
+            std::printf("%s: Error: suite terminated by signal %d\n", suite.name, WTERMSIG(status));
+            return 128 + WTERMSIG(status);
+        }
+    }
+#else
+    (void)fork_suites;
+#endif
+    return runInProcess(suite, program);
+}
+
+bool parseShard(const char *text, unsigned &index, unsigned &count)
+{
+    return std::sscanf(text, "%u/%u", &index, &count) == 2 && count > 0 && index < count;
+}
+} // namespace
+
+void astraRegisterSuite(const AstraSuite &suite)
+{
+    suites().push_back(suite);
+}
+
+extern "C" void setUp(void)
+{
+    if (current && current->setUp)
+        current->setUp();
+}
+
+extern "C" void tearDown(void)
+{
+    if (current && current->tearDown)
+        current->tearDown();
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<std::string> selected;
+    unsigned shard = 0;
+    unsigned shards = 1;
+    bool fork_suites = true;
+    bool list = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--suite") == 0 && i + 1 < argc)
+            selected.push_back(argv[++i]);
+        else if (std::strcmp(argv[i], "--shard") == 0 && i + 1 < argc)
+        {
+            if (!parseShard(argv[++i], shard, shards))
+            {
+                std::fprintf(stderr, "Error: --shard expects I/N with I < N, got %s\n", argv[i]);
+                return 2;
+            }
+        }
+        else if (std::strcmp(argv[i], "--no-fork") == 0)
+            fork_suites = false;
+        else if (std::strcmp(argv[i], "--list") == 0)
+            list = true;
+        else
+        {
+            std::fprintf(stderr, "Error: unknown argument %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    std::vector<AstraSuite> ordered = suites();
+    std::sort(ordered.begin(), ordered.end(), [](const AstraSuite &a, const AstraSuite &b)
+              { return std::strcmp(a.name, b.name) < 0; });
+    if (!selected.empty())
+    {
+        ordered.erase(std::remove_if(ordered.begin(), ordered.end(), [&](const AstraSuite &suite)
+                                     { return std::find(selected.begin(), selected.end(), suite.name) == selected.end(); }),
+                      ordered.end());
+    }
+
+    int failed = 0;
+    for (size_t index = shard; index < ordered.size(); index += shards)
+    {
+        const AstraSuite &suite = ordered[index];
+        if (list)
+        {
+            std::printf("%s\n", suite.name);
+            continue;
+        }
+        std::printf("::astra-suite-begin %s\n", suite.name);
+        const auto start = std::chrono::steady_clock::now();
+        const int code = runSuite(suite, argv[0], fork_suites);
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        std::printf("\n::astra-suite-end %s %d %lld\n", suite.name, code, static_cast<long long>(elapsed.count()));
+        std::fflush(stdout);
+        failed += code != 0;
+    }
+    return failed == 0 ? 0 : 1;
+}
@@ -53,6 +53,18 @@ def build_parser() -> argparse.ArgumentParser:
     p_test.add_argument("--no-builds", "-B", action="store_true")
     p_test.add_argument("--no-tests", "-T", action="store_true")
     p_test.add_argument("--clean", "-c", action="store_true")
+    p_test.add_argument(
+        "--no-shared-cache",
+        action="store_true",
+        help="Build libraries in every native test folder instead of linking one cached archive",
+    )
+    p_test.add_argument(
+        "--aggregate",
+        action="store_true",
+        help="Compile all native test folders into one program and run its suites in parallel shards",
+    )
+    p_test.add_argument("--all", action="store_true", help="Run every test folder, not just those affected by changes")
+    p_test.add_argument("--since", help="Also count files changed since this git ref when selecting affected tests")
     p_test.set_defaults(func=test_cmd.run)
 
     p_sim = sub.add_parser("sim", help="Simulation utilities")
@@ -91,10 +103,51 @@ def build_parser() -> argparse.ArgumentParser:
     p_sim_run.add_argument("--target-apogee", type=float, default=None)
     p_sim_run.add_argument("--real-time", action="store_true", help="Pace HITL packets to sim timestamps")
     p_sim_run.add_argument("--time-scale", type=float, default=1.0, help="Real-time pacing scale factor")
+    p_sim_run.add_argument(
+        "--window",
+        "-w",
+        type=int,
+        default=1,
+        help="SITL packets kept in flight, matched to TELEM by sequence number (1: lockstep)",
+    )
+    p_sim_run.add_argument(
+        "--sensor-rates",
+        nargs="?",
+        const="default",
+        default=None,
+        help="Send per-sensor HITL/IMU, HITL/BARO, HITL/GPS lines at their own rates "
+        "(default imu=1000,baro=50,gps=10) instead of one combined line per packet",
+    )
+    p_sim_run.add_argument(
+        "--log-format",
+        choices=["csv", "columnar"],
+        default="csv",
+        help="Sim log written during the run: CSV or ASTRACOL columnar (.astracol)",
+    )
     p_sim_run.add_argument("--dataset-root", action="append", help="Additional dataset roots")
     p_sim_run.add_argument("--no-plot", action="store_true", help="Skip result plotting")
+    p_sim_run.add_argument("--live-plot", action="store_true", help="Plot altitude and control while the run is going")
     p_sim_run.set_defaults(func=sim_cmd.run)
 
+    p_sim_link = p_sim_sub.add_parser("link", help="Run a lossy radio link between two native processes' serial ports")
+    p_sim_link.add_argument("--host", "-H", default="127.0.0.1", help="Listen address for both sides")
+    p_sim_link.add_argument("--a-port", type=int, default=5601, help="TCP port side A connects its Serial port to")
+    p_sim_link.add_argument("--b-port", type=int, default=5602, help="TCP port side B connects its Serial port to")
+    p_sim_link.add_argument("--bandwidth", "-b", type=float, default=0.0, help="Air rate in bit/s (0: unlimited)")
+    p_sim_link.add_argument("--latency-ms", "-l", type=float, default=0.0, help="One-way latency per packet")
+    p_sim_link.add_argument("--jitter-ms", type=float, default=0.0, help="Extra uniform random latency")
+    p_sim_link.add_argument("--loss", type=float, default=0.0, help="Packet loss probability outside bursts")
+    p_sim_link.add_argument("--burst-enter", type=float, default=0.0, help="Per-packet probability of entering a burst")
+    p_sim_link.add_argument("--burst-exit", type=float, default=1.0, help="Per-packet probability of leaving a burst")
+    p_sim_link.add_argument("--burst-loss", type=float, default=1.0, help="Packet loss probability inside a burst")
+    p_sim_link.add_argument("--max-packet", type=_positive_int, default=255, help="Largest packet; longer lines are split")
+    p_sim_link.add_argument(
+        "--idle-flush-ms", type=float, default=20.0, help="Send bytes without a newline after this long with no new bytes"
+    )
+    p_sim_link.add_argument("--seed", type=int, default=None, help="Seed for reproducible loss and jitter")
+    p_sim_link.add_argument("--duration", type=float, default=None, help="Stop after this many seconds")
+    p_sim_link.set_defaults(func=sim_cmd.link)
+
     p_init = sub.add_parser("init", help="Compatibility alias for sync")
     p_init.add_argument("--project", "-C", default=".", help="Target project path")
     p_init.add_argument("--config", help="Optional path to .astra-support.yml")
@@ -131,8 +184,11 @@ def build_parser() -> argparse.ArgumentParser:
     p_sitl.add_argument("--baro-noise", "-z", type=float, default=0.5)
     p_sitl.add_argument("--header-probe", default="CMD/HEADER\n")
     p_sitl.add_argument("--target-apogee", type=float, default=None)
+    p_sitl.add_argument("--window", "-w", type=int, default=1)
+    p_sitl.add_argument("--sensor-rates", nargs="?", const="default", default=None)
     p_sitl.add_argument("--dataset-root", action="append")
     p_sitl.add_argument("--no-plot", action="store_true")
+    p_sitl.add_argument("--live-plot", action="store_true")
     p_sitl.set_defaults(func=_compat_sitl)
 
     p_hitl = sub.add_parser("hitl", help="Compatibility alias for 'sim run --mode hitl'")
@@ -155,13 +211,22 @@ def build_parser() -> argparse.ArgumentParser:
     p_hitl.add_argument("--target-apogee", type=float, default=None)
     p_hitl.add_argument("--real-time", action="store_true")
     p_hitl.add_argument("--time-scale", type=float, default=1.0)
+    p_hitl.add_argument("--sensor-rates", nargs="?", const="default", default=None)
     p_hitl.add_argument("--dataset-root", action="append")
     p_hitl.add_argument("--no-plot", action="store_true")
+    p_hitl.add_argument("--live-plot", action="store_true")
     p_hitl.set_defaults(func=_compat_hitl)
 
     return parser
 
 
+def _positive_int(text: str) -> int:
+    value = int(text)
+    if value < 1:
+        raise argparse.ArgumentTypeError(f"must be at least 1, got {value}")
+    return value
+
+
 def _compat_sitl(args) -> int:
     compat_args = SimpleNamespace(
         **vars(args),
@@ -3,6 +3,7 @@ from __future__ import annotations
 from pathlib import Path
 
 from ..config.support_file import load_support_config
+from ..sim.radio_link import run_link_broker
 from ..sim.session import run_simulation
 from ..sim.sources import invoke_hook, list_available_sources, load_custom_sim_hooks
 
@@ -38,3 +39,7 @@ def run(args) -> int:
     if not getattr(args, "dataset_root", None) and config.dataset_paths:
         args.dataset_root = list(config.dataset_paths)
     return run_simulation(args, project_root)
+
+
+def link(args) -> int:
+    return run_link_broker(args)
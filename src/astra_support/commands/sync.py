@@ -25,12 +25,15 @@ ENV_TEMPLATE_FILES = {
 }
 
 ENV_ASSET_DIRS = {
+    "native": "env_assets/native",
     "stm32h723vehx": "env_assets/stm32h723vehx",
 }
 
 DEFAULT_GITIGNORE_PATTERNS = [
     ".pio_native_verbose.log",
     "sim_log_*.csv",
+    "sim_log_*.astracol",
+    "*.astracache",
 ]
 
 
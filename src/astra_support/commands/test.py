@@ -17,6 +17,10 @@ def run(args) -> int:
         no_builds=args.no_builds or "--no-builds" in default_flags or "-B" in default_flags,
         no_tests=args.no_tests or "--no-tests" in default_flags or "-T" in default_flags,
         clean=args.clean or "--clean" in default_flags or "-c" in default_flags,
+        shared_cache=not (getattr(args, "no_shared_cache", False) or "--no-shared-cache" in default_flags),
+        aggregate=getattr(args, "aggregate", False) or "--aggregate" in default_flags,
+        run_all=getattr(args, "all", False) or "--all" in default_flags,
+        since=getattr(args, "since", None),
         envs=args.env,
         default_args=config.test_args,
     )
@@ -0,0 +1,285 @@
+from __future__ import annotations
+
+import math
+from pathlib import Path
+from typing import Iterable
+
+import numpy as np
+
+MAGIC = b"ASTRACOL"
+FORMAT_VERSION = 1
+
+COL_DECIMAL = 1
+COL_FLOAT = 2
+COL_STRING = 3
+
+DEFAULT_BLOCK_ROWS = 1024
+MAX_DECIMAL_SCALE = 6
+MAX_DECIMAL_MAGNITUDE = 10**18
+
+
+def read_columnar_log(path: Path | str) -> dict[str, np.ndarray]:
+    """Load an ASTRACOL telemetry log into one NumPy array per column.
+
+    Columns that only ever held integers load as int64, other numeric columns
+    as float64 (missing values are NaN) and anything else as an object array.
+    An empty file (a native sink that never got a line) and one cut off inside
+    its header load as no columns, and a truncated final block is dropped.
+    """
+    data = memoryview(Path(path).read_bytes())
+    if bytes(data[: len(MAGIC)]) != MAGIC[: len(data)]:
+        raise ValueError(f"{path}: not an ASTRACOL log")
+    if len(data) > len(MAGIC) and data[len(MAGIC)] != FORMAT_VERSION:
+        raise ValueError(f"{path}: unsupported ASTRACOL version {data[len(MAGIC)]}")
+    header = _read_header(data)
+    if header is None:
+        return {}  # the writer stopped before the schema was complete
+    names, offset = header
+
+    parts: list[list[np.ndarray]] = [[] for _ in names]
+    while offset < len(data):
+        block = _read_block(data, offset, len(names))
+        if block is None:
+            break  # the writer stopped mid-block
+        offset, columns = block
+        for column, values in zip(parts, columns):
+            column.append(values)
+
+    return {name: _concat(column) for name, column in zip(names, parts)}
+
+
+class ColumnarLogWriter:
+    """Streaming ASTRACOL writer; rows are buffered and encoded per block."""
+
+    def __init__(self, path: Path | str, names: Iterable[str], *, block_rows: int = DEFAULT_BLOCK_ROWS):
+        self.path = Path(path)
+        self.names = [str(name) for name in names]
+        self.block_rows = max(1, block_rows)
+        self._pending: list[list[object]] = [[] for _ in self.names]
+        self._handle = self.path.open("wb")
+        header = bytearray(MAGIC)
+        header.append(FORMAT_VERSION)
+        header += _encode_varints(np.array([len(self.names)], dtype=np.uint64))
+        for name in self.names:
+            encoded = name.encode("utf-8")
+            header += _encode_varints(np.array([len(encoded)], dtype=np.uint64))
+            header += encoded
+        self._handle.write(bytes(header))
+
+    def append_row(self, values: Iterable[object]) -> None:
+        for column, value in zip(self._pending, values):
+            column.append(value)
+        if len(self._pending[0]) >= self.block_rows:
+            self.flush()
+
+    def append_columns(self, columns: Iterable[Iterable[object]]) -> None:
+        for pending, values in zip(self._pending, columns):
+            pending.extend(values)
+        if self._pending and len(self._pending[0]) >= self.block_rows:
+            self.flush()
+
+    def flush(self) -> None:
+        if not self._pending or not self._pending[0]:
+            return
+        block = bytearray(_encode_varints(np.array([len(self._pending[0])], dtype=np.uint64)))
+        for column in self._pending:
+            col_type, scale, payload = _encode_column(column)
+            block.append(col_type)
+            if col_type == COL_DECIMAL:
+                block.append(scale)
+            block += _encode_varints(np.array([len(payload)], dtype=np.uint64))
+            block += payload
+        self._handle.write(bytes(block))
+        self._handle.flush()
+        self._pending = [[] for _ in self.names]
+
+    def close(self) -> None:
+        if self._handle.closed:
+            return
+        self.flush()
+        self._handle.close()
+
+    def __enter__(self) -> "ColumnarLogWriter":
+        return self
+
+    def __exit__(self, *_exc) -> None:
+        self.close()
+
+
+def write_columnar_log(path: Path | str, columns: dict[str, Iterable[object]]) -> None:
+    with ColumnarLogWriter(path, columns.keys()) as writer:
+        writer.append_columns(columns.values())
+
+
+def _read_header(data: memoryview) -> tuple[list[str], int] | None:
+    """Column names and the offset of the first block; None if the data ends inside the header."""
+    offset = len(MAGIC) + 1
+    names: list[str] = []
+    try:
+        column_count, offset = _read_varint(data, offset)
+        for _ in range(column_count):
+            length, offset = _read_varint(data, offset)
+            if offset + length > len(data):
+                return None
+            names.append(bytes(data[offset : offset + length]).decode("utf-8"))
+            offset += length
+    except IndexError:
+        return None
+    return names, offset
+
+
+def _read_block(data: memoryview, offset: int, column_count: int) -> tuple[int, list[np.ndarray]] | None:
+    """Decodes the block at `offset`; None if the data ends before the block does."""
+    try:
+        row_count, offset = _read_varint(data, offset)
+        headers = []
+        for _ in range(column_count):
+            col_type = data[offset]
+            offset += 1
+            scale = 0
+            if col_type == COL_DECIMAL:
+                scale = data[offset]
+                offset += 1
+            length, offset = _read_varint(data, offset)
+            if offset + length > len(data):
+                return None
+            headers.append((col_type, scale, data[offset : offset + length]))
+            offset += length
+    except IndexError:
+        return None
+    return offset, [_decode_column(col_type, scale, payload, row_count) for col_type, scale, payload in headers]
+
+
+def _read_varint(data: memoryview, offset: int) -> tuple[int, int]:
+    value = 0
+    shift = 0
+    while True:
+        byte = data[offset]
+        offset += 1
+        value |= (byte & 0x7F) << shift
+        if byte < 0x80:
+            return value, offset
+        shift += 7
+
+
+def _decode_varints(payload: memoryview, count: int) -> np.ndarray:
+    raw = np.frombuffer(payload, dtype=np.uint8)
+    if count == 0:
+        return np.zeros(0, dtype=np.uint64)
+    ends = np.flatnonzero(raw < 0x80)
+    if len(ends) != count:
+        raise ValueError(f"expected {count} varints, found {len(ends)}")
+    starts = np.empty_like(ends)
+    starts[0] = 0
+    starts[1:] = ends[:-1] + 1
+    group = np.repeat(np.arange(count), ends - starts + 1)
+    shifts = (np.arange(len(raw)) - starts[group]).astype(np.uint64) * np.uint64(7)
+    pieces = (raw & 0x7F).astype(np.uint64) << shifts
+    return np.bitwise_or.reduceat(pieces, starts)
+
+
+def _encode_varints(values: np.ndarray) -> bytes:
+    values = values.astype(np.uint64, copy=False)
+    if len(values) == 0:
+        return b""
+    sizes = np.ones(len(values), dtype=np.int64)
+    rest = values >> np.uint64(7)
+    while np.any(rest):
+        sizes += rest > 0
+        rest >>= np.uint64(7)
+    starts = np.cumsum(sizes) - sizes
+    out = np.zeros(int(sizes.sum()), dtype=np.uint8)
+    for index in range(int(sizes.max())):
+        mask = sizes > index
+        chunk = (values[mask] >> np.uint64(7 * index)) & np.uint64(0x7F)
+        more = np.where(sizes[mask] > index + 1, 0x80, 0).astype(np.uint64)
+        out[starts[mask] + index] = (chunk | more).astype(np.uint8)
+    return out.tobytes()
+
+
+def _decode_column(col_type: int, scale: int, payload: memoryview, count: int) -> np.ndarray:
+    if col_type == COL_DECIMAL:
+        encoded = _decode_varints(payload, count)
+        deltas = (encoded >> np.uint64(1)).astype(np.int64) ^ -(encoded & np.uint64(1)).astype(np.int64)
+        values = np.cumsum(deltas)
+        if scale == 0:
+            return values
+        return values / float(10**scale)
+    if col_type == COL_FLOAT:
+        bits = np.bitwise_xor.accumulate(_decode_varints(payload, count))
+        return bits.view(np.float64)
+    if col_type == COL_STRING:
+        out = np.empty(count, dtype=object)
+        offset = 0
+        for index in range(count):
+            length, offset = _read_varint(payload, offset)
+            out[index] = bytes(payload[offset : offset + length]).decode("utf-8", errors="replace")
+            offset += length
+        return out
+    raise ValueError(f"unknown ASTRACOL column type {col_type}")
+
+
+def _concat(blocks: list[np.ndarray]) -> np.ndarray:
+    if not blocks:
+        return np.zeros(0, dtype=np.float64)
+    kinds = {block.dtype.kind for block in blocks}
+    if "O" in kinds:
+        return np.concatenate([block.astype(object) for block in blocks])
+    if "f" in kinds:
+        return np.concatenate([block.astype(np.float64) for block in blocks])
+    return np.concatenate(blocks)
+
+
+def _encode_column(values: list[object]) -> tuple[int, int, bytes]:
+    numeric = _as_float_array(values)
+    if numeric is None:
+        payload = bytearray()
+        for value in values:
+            encoded = ("" if value is None else str(value)).encode("utf-8")
+            payload += _encode_varints(np.array([len(encoded)], dtype=np.uint64))
+            payload += encoded
+        return COL_STRING, 0, bytes(payload)
+
+    scale = _decimal_scale(numeric)
+    if scale is not None:
+        mantissas = np.round(numeric * float(10**scale)).astype(np.int64)
+        deltas = np.diff(mantissas, prepend=np.int64(0))
+        zigzag = (deltas.astype(np.uint64) << np.uint64(1)) ^ (deltas >> np.int64(63)).astype(np.uint64)
+        return COL_DECIMAL, scale, _encode_varints(zigzag)
+
+    bits = numeric.view(np.uint64)
+    xored = bits ^ np.concatenate(([np.uint64(0)], bits[:-1]))
+    return COL_FLOAT, 0, _encode_varints(xored)
+
+
+def _as_float_array(values: list[object]) -> np.ndarray | None:
+    try:
+        return np.asarray(values, dtype=np.float64)
+    except (TypeError, ValueError):
+        pass
+    out = np.empty(len(values), dtype=np.float64)
+    for index, value in enumerate(values):
+        if value is None or value == "":
+            out[index] = math.nan
+            continue
+        if isinstance(value, (bool, np.bool_)):
+            return None
+        try:
+            out[index] = float(value)
+        except (TypeError, ValueError):
+            return None
+    return out
+
+
+def _decimal_scale(values: np.ndarray) -> int | None:
+    # A scaled integer has no negative zero; keep its sign in a float column.
+    if not np.all(np.isfinite(values)) or np.any(np.signbit(values) & (values == 0)):
+        return None
+    for scale in range(MAX_DECIMAL_SCALE + 1):
+        factor = float(10**scale)
+        scaled = values * factor
+        if np.any(np.abs(scaled) >= MAX_DECIMAL_MAGNITUDE):
+            return None
+        if np.array_equal(np.round(scaled) / factor, values):
+            return scale
+    return None
@@ -1,12 +1,18 @@
-import csv
+import math
 import socket
 import numpy as np
-from dataclasses import dataclass
+from dataclasses import dataclass, fields
+from typing import Callable, Iterable, Iterator
 from scipy.spatial.transform import Rotation
 
-SEA_LEVEL_PRESSURE_HPA = 1013.25
-MSL_ALTITUDE_SCALE_M = 44330.0
-MSL_ALTITUDE_EXPONENT = 0.1903
+from .dataset_cache import (
+    COLUMNS,
+    MSL_ALTITUDE_EXPONENT,
+    MSL_ALTITUDE_SCALE_M,
+    SEA_LEVEL_PRESSURE_HPA,
+    load_dataset,
+)
+from .merge import merge_input, merge_streams
 
 
 def pressure_to_msl_altitude(pressure_hpa: float) -> float:
@@ -46,10 +52,125 @@ class PacketData:
                 f"{self.lat:.7f},{self.lon:.7f},{self.alt:.2f},"
                 f"{self.fix},{self.sats},{self.heading:.1f}\n")
 
+    def to_sensor_string(self, kind: str) -> str:
+        """One per-sensor line (``imu``, ``baro`` or ``gps``) for multi-rate HITL;
+        fields and precision match the combined to_hitl_string() line."""
+        if kind == "imu":
+            return (f"HITL/IMU/{self.timestamp:.3f},"
+                    f"{self.accel[0]:.4f},{self.accel[1]:.4f},{self.accel[2]:.4f},"
+                    f"{self.gyro[0]:.4f},{self.gyro[1]:.4f},{self.gyro[2]:.4f},"
+                    f"{self.mag[0]:.2f},{self.mag[1]:.2f},{self.mag[2]:.2f}\n")
+        if kind == "baro":
+            return f"HITL/BARO/{self.timestamp:.3f},{self.pressure:.2f},{self.temp:.2f}\n"
+        if kind == "gps":
+            return (f"HITL/GPS/{self.timestamp:.3f},"
+                    f"{self.lat:.7f},{self.lon:.7f},{self.alt:.2f},"
+                    f"{self.fix},{self.sats},{self.heading:.1f}\n")
+        raise ValueError(f"Unknown sensor kind '{kind}'")
+
+# Packets per block for get_next_block callers that do not pick a size.
+BLOCK_ROWS = 4096
+
+@dataclass
+class PacketBlock:
+    """N consecutive packets as struct-of-arrays: one (N,) array per PacketData
+    field and (N, 3) for accel, gyro and mag. Optional truth fields are NaN where
+    a packet had None."""
+    timestamp: np.ndarray
+    accel: np.ndarray
+    gyro: np.ndarray
+    mag: np.ndarray
+    pressure: np.ndarray
+    temp: np.ndarray
+    lat: np.ndarray
+    lon: np.ndarray
+    alt: np.ndarray
+    fix: np.ndarray
+    sats: np.ndarray
+    heading: np.ndarray
+    truth_alt: np.ndarray
+    truth_accel: np.ndarray
+    sensor_alt_agl: np.ndarray
+
+    def __len__(self) -> int:
+        return len(self.timestamp)
+
+    @classmethod
+    def from_packets(cls, packets: list) -> "PacketBlock":
+        def column(name, dtype=np.float64):
+            return np.array([np.nan if getattr(p, name) is None else getattr(p, name) for p in packets], dtype=dtype)
+
+        def vectors(name):
+            return np.array([getattr(p, name) for p in packets], dtype=np.float64).reshape(len(packets), 3)
+
+        return cls(**{
+            f.name: vectors(f.name) if f.name in _VECTOR_FIELDS
+            else column(f.name, np.int64 if f.name in _INT_FIELDS else np.float64)
+            for f in fields(cls)
+        })
+
+    @classmethod
+    def concatenate(cls, blocks: Iterable["PacketBlock"]) -> "PacketBlock":
+        blocks = list(blocks)
+        if not blocks:
+            return cls.from_packets([])
+        return cls(**{f.name: np.concatenate([getattr(b, f.name) for b in blocks]) for f in fields(cls)})
+
+    def packet(self, i: int) -> PacketData:
+        def optional(values):
+            value = float(values[i])
+            return None if math.isnan(value) else value
+
+        return PacketData(float(self.timestamp[i]),
+                          self.accel[i].copy(),
+                          self.gyro[i].copy(),
+                          self.mag[i].copy(),
+                          float(self.pressure[i]),
+                          float(self.temp[i]),
+                          float(self.lat[i]),
+                          float(self.lon[i]),
+                          float(self.alt[i]),
+                          int(self.fix[i]),
+                          int(self.sats[i]),
+                          float(self.heading[i]),
+                          truth_alt=optional(self.truth_alt),
+                          truth_accel=optional(self.truth_accel),
+                          sensor_alt_agl=optional(self.sensor_alt_agl))
+
+    def packets(self) -> list:
+        return [self.packet(i) for i in range(len(self))]
+
+_VECTOR_FIELDS = {"accel", "gyro", "mag"}
+_INT_FIELDS = {"fix", "sats"}
+
 class DataSource:
     def get_next_packet(self) -> PacketData: raise NotImplementedError
     def is_finished(self) -> bool: return False
 
+    def get_next_block(self, rows: int = BLOCK_ROWS) -> PacketBlock:
+        """Up to `rows` next packets as one PacketBlock (fewer once the source is finished).
+        Sources that can slice their data directly override this."""
+        packets = []
+        while len(packets) < rows and not self.is_finished():
+            packets.append(self.get_next_packet())
+        return PacketBlock.from_packets(packets)
+
+def read_blocks(source: DataSource, rows: int = BLOCK_ROWS) -> Iterator[PacketBlock]:
+    """Yields the source's packets `rows` at a time until it is finished."""
+    while not source.is_finished():
+        block = source.get_next_block(rows)
+        if not len(block):
+            return
+        yield block
+
+def monte_carlo_runs(create_source: Callable[[int], DataSource], seeds: Iterable[int],
+                     rows: int = BLOCK_ROWS) -> Iterator[tuple[int, PacketBlock]]:
+    """One whole run per seed: `create_source(seed)` builds the (seeded) source,
+    e.g. ``lambda seed: NoisySim(CSVSim(path), seed=seed)``, and its packets are
+    read in blocks. Yields (seed, PacketBlock of the run)."""
+    for seed in seeds:
+        yield seed, PacketBlock.concatenate(read_blocks(create_source(seed), rows))
+
 class PhysicsSim(DataSource):
     def __init__(self):
         self.t = 0.0
@@ -111,153 +232,130 @@ class PhysicsSim(DataSource):
                           truth_alt=self.alt, truth_accel=accel_z)
 
 class CSVSim(DataSource):
-    def __init__(self, filename):
-        self.data = []
+    """Replays a flight CSV, normalized once and cached beside it (see dataset_cache)."""
+    def __init__(self, filename, use_cache: bool = True):
         self.index = 0
-        self.is_openrocket = False
-        self._load_csv(filename)
-        print(f"[Sim] Ready. Duration: {self.data[-1].timestamp:.1f}s")
+        self._data = None
+        print(f"[Sim] Parsing {filename}...")
+        self.dataset = load_dataset(filename, use_cache=use_cache)
+        self.is_openrocket = self.dataset.is_openrocket
+        self._columns = [self.dataset.columns[name] for name in COLUMNS]
+        if self.dataset.cache_path is not None and self.dataset.header_map is None:
+            print(f"[Sim] Using cached dataset {self.dataset.cache_path.name}")
+        elif self.is_openrocket:
+            print("[Sim] Detected OpenRocket format (inertial accel). Adding gravity to convert to specific force.")
+        else:
+            print("[Sim] Detected real flight data format (specific force). Using values as-is.")
+        print(f"[Sim] Successfully loaded {len(self.dataset)} rows.")
+        print(f"[Sim] Ready. Duration: {self.dataset.columns['time'][-1]:.1f}s")
+
+    @property
+    def data(self) -> list:
+        """Every row as a PacketData; built on first use, replay does not need it."""
+        if self._data is None:
+            self._data = [self._packet(i) for i in range(len(self.dataset))]
+        return self._data
 
     def is_finished(self) -> bool:
-        return self.index >= len(self.data)
+        return self.index >= len(self.dataset)
 
     def get_next_packet(self) -> PacketData:
-        if self.index < len(self.data):
-            p = self.data[self.index]
+        if self.index < len(self.dataset):
+            p = self._packet(self.index)
             self.index += 1
             return p
-        return self.data[-1]
+        return self._packet(len(self.dataset) - 1)
+
+    def get_next_block(self, rows: int = BLOCK_ROWS) -> PacketBlock:
+        start, stop = self.index, min(self.index + rows, len(self.dataset))
+        self.index = stop
+        (t, ax, ay, az, gx, gy, gz, mx, my, mz, pres, temp,
+         lat, lon, gps_alt, fix, sats, heading, truth_alt, truth_acc) = (
+            np.asarray(c[start:stop], dtype=np.float64) for c in self._columns)
+        return PacketBlock(t,
+                           np.column_stack((ax, ay, az)),
+                           np.column_stack((gx, gy, gz)),
+                           np.column_stack((mx, my, mz)),
+                           pres,
+                           temp,
+                           lat,
+                           lon,
+                           gps_alt,
+                           fix.astype(np.int64),
+                           sats.astype(np.int64),
+                           heading,
+                           truth_alt,
+                           truth_acc,
+                           np.full(len(t), np.nan))
+
+    def _packet(self, i: int) -> PacketData:
+        (t, ax, ay, az, gx, gy, gz, mx, my, mz, pres, temp,
+         lat, lon, gps_alt, fix, sats, heading, truth_alt, truth_acc) = (float(c[i]) for c in self._columns)
+        return PacketData(t,
+                          np.array([ax, ay, az]),
+                          np.array([gx, gy, gz]),
+                          np.array([mx, my, mz]),
+                          pres,
+                          temp,
+                          lat,
+                          lon,
+                          gps_alt,
+                          int(fix),
+                          int(sats),
+                          heading,
+                          truth_alt=truth_alt,
+                          truth_accel=truth_acc)
+
+class MergedCSVSim(DataSource):
+    """Replays several time-aligned CSVs (e.g. a high-rate IMU log and a low-rate baro log)
+    as one stream at the union of their sample times; see merge.merge_streams."""
+    def __init__(self, filenames):
+        self.inputs = [merge_input(name) for name in filenames]
+        for item in self.inputs:
+            keys = ", ".join(spec.key for spec in item.columns)
+            print(f"[Sim] Merging {item.path.name} on '{item.time_column}': {keys}")
+        self.is_openrocket = False
+        self._stream = merge_streams(self.inputs)
+        self._next = next(self._stream, None)
+        if self._next is None:
+            raise ValueError("No data rows found in the merged sources.")
+        self._last = self._packet(self._next)
+        self.fresh = frozenset()  # keys sampled at the last packet's timestamp
+        self.sampled = frozenset(spec.key for item in self.inputs for spec in item.columns)
 
-    def _load_csv(self, filename):
-        print(f"[Sim] Parsing {filename}...")
-        with open(filename, 'r', encoding='utf-8-sig', errors='ignore') as f:
-            lines = f.readlines()
-        
-        header_index = -1; header_map = {}; converters = {}
-        keys = {
-            'time': ['time', 'timestamp'],
-            'alt': ['state - pz', 'pos_z', 'position z', 'altitude', 'alt asl', 'alt agl', 'height', 'disp z'],
-            'acc_x': ['accx', 'acc_x', 'acc x', 'acceleration x'],
-            'acc_y': ['accy', 'acc_y', 'acc y', 'acceleration y'],
-            'acc_z': ['accz', 'acc_z', 'acc z', 'acceleration z', 'vertical acc'],
-            'gyro_x': ['gyrox', 'gyro_x', 'gyro x'],
-            'gyro_y': ['gyroy', 'gyro_y', 'gyro y'],
-            'gyro_z': ['gyroz', 'gyro_z', 'gyro z'],
-            'mag_x': ['magx', 'mag_x', 'mag x'],
-            'mag_y': ['magy', 'mag_y', 'mag y'],
-            'mag_z': ['magz', 'mag_z', 'mag z'],
-            'lat': ['latitude', ' lat'],
-            'lon': ['longitude', ' lon'],
-            'gps_alt': ['gps - alt', 'gps alt', ' max-m10s - alt', 'mockgps - alt', 'alt (m)'],
-            'fix': ['fix quality', 'fix', 'gps fix'],
-            'sats': ['satellites', 'num sats', 'sats'],
-            'heading': ['heading', 'course'],
-            'truth_acc_z': ['truth accel', 'true accel', 'inertial accel'],
-            'pres': ['pressure', 'baro', 'pres'],
-            'temp': ['temperature', 'temp'],
-        }
-
-        for i, line in enumerate(lines):
-            clean_parts = [p.lower().replace('#','').replace('"','').strip() for p in line.split(',')]
-            if len(clean_parts) < 2: continue
-            found_cols = {}
-            for col_idx, col_name in enumerate(clean_parts):
-                for key_type, keywords in keys.items():
-                    if any(k in col_name for k in keywords) and key_type not in found_cols:
-                        found_cols[key_type] = col_idx
-                        converters[key_type] = lambda x: x
-                        if key_type == 'temp' and 'f' in col_name and 'c' not in col_name:
-                            converters[key_type] = lambda x: (x - 32.0) * 5.0/9.0
-                        elif key_type == 'alt' and ('ft' in col_name or 'feet' in col_name):
-                            converters[key_type] = lambda x: x * 0.3048
-                        elif key_type in ['acc_x', 'acc_y', 'acc_z'] and ('g' in col_name and 'mag' not in col_name):
-                            converters[key_type] = lambda x: x * 9.80665
-                        elif key_type in ['gyro_x', 'gyro_y', 'gyro_z'] and ('deg' in col_name and 'rad' not in col_name):
-                            converters[key_type] = lambda x: x * np.pi / 180.0
-
-            if 'time' in found_cols and 'alt' in found_cols:
-                header_index = i; header_map = found_cols
-                print(f"[Sim] Found Header at line {i+1}. Map: {header_map}")
-                break
-        
-        if header_index == -1: raise ValueError("Headers not found.")
-
-        # Detect OpenRocket format: check if first data row has near-zero acceleration
-        # OpenRocket reports inertial acceleration (gravity removed), so we need to add it back
-        # Real flight data already has specific force, so we don't add gravity
-        for i in range(header_index + 1, len(lines)):
-            line = lines[i].strip()
-            if not line or line.startswith('#'): continue
-            first_data_row = line.split(',')
-            try:
-                # Check any available acc axis for OpenRocket detection
-                for acc_key in ['acc_z', 'acc_x', 'acc_y']:
-                    if acc_key in header_map and header_map[acc_key] < len(first_data_row):
-                        first_acc = converters[acc_key](float(first_data_row[header_map[acc_key]].strip()))
-                        # OpenRocket starts at 0 inertial accel (at rest), so abs value should be < 1
-                        if abs(first_acc) < 0.005:
-                            self.is_openrocket = True
-                            print("[Sim] Detected OpenRocket format (inertial accel). Adding gravity to convert to specific force.")
-                        else:
-                            print("[Sim] Detected real flight data format (specific force). Using values as-is.")
-                        break
-                break
-            except (ValueError, TypeError, IndexError):
-                break
-
-        count = 0
-        for i in range(header_index + 1, len(lines)):
-            line = lines[i].strip()
-            if not line or line.startswith('#'): continue
-            row = line.split(',')
-            try:
-                def get_val(k, d=0.0):
-                    return converters[k](float(row[header_map[k]].strip())) if k in header_map and header_map[k] < len(row) else d
-
-                # Load all three accelerometer axes
-                sensor_x = get_val('acc_x')
-                sensor_y = get_val('acc_y')
-                sensor_z = get_val('acc_z')
-                gyro_x = get_val('gyro_x')
-                gyro_y = get_val('gyro_y')
-                gyro_z = get_val('gyro_z')
-                mag_x = get_val('mag_x')
-                mag_y = get_val('mag_y')
-                mag_z = get_val('mag_z')
-
-                # If OpenRocket format, add gravity to convert inertial accel -> specific force
-                # (typically gravity is on the Z axis)
-                if self.is_openrocket:
-                    sensor_z += 9.81
-
-                alt_val = get_val('alt')
-                truth_acc = get_val('truth_acc_z', 0.0)
-                lat_val = get_val('lat', 45.0)
-                lon_val = get_val('lon', -122.0)
-                gps_alt_val = get_val('gps_alt', alt_val)
-                pressure_val = get_val('pres', pressure_from_msl_altitude(alt_val))
-                fix_val = int(get_val('fix', 1.0))
-                sats_val = int(get_val('sats', 8.0))
-                heading_val = get_val('heading', 0.0)
-
-                self.data.append(PacketData(get_val('time'),
-                                            np.array([sensor_x, sensor_y, sensor_z]),
-                                            np.array([gyro_x, gyro_y, gyro_z]),
-                                            np.array([mag_x, mag_y, mag_z]),
-                                            pressure_val,
-                                            get_val('temp', 25.0),
-                                            lat_val,
-                                            lon_val,
-                                            gps_alt_val,
-                                            fix_val,
-                                            sats_val,
-                                            heading_val,
-                                            truth_alt=alt_val,
-                                            truth_accel=truth_acc))
-                count += 1
-            except (ValueError, TypeError, KeyError, IndexError):
-                continue
-        print(f"[Sim] Successfully loaded {count} rows.")
+    def is_finished(self) -> bool:
+        return self._next is None
+
+    def get_next_packet(self) -> PacketData:
+        if self._next is not None:
+            self.fresh = self._next.fresh
+            self._last = self._packet(self._next)
+            self._next = next(self._stream, None)
+        return self._last
+
+    @staticmethod
+    def _packet(sample) -> PacketData:
+        values = sample.values
+
+        def get(key, default):
+            value = values.get(key, math.nan)
+            return default if math.isnan(value) else value
+
+        alt = get('truth_alt', 0.0)
+        return PacketData(sample.time,
+                          np.array([get('acc_x', 0.0), get('acc_y', 0.0), get('acc_z', 0.0)]),
+                          np.array([get('gyro_x', 0.0), get('gyro_y', 0.0), get('gyro_z', 0.0)]),
+                          np.array([get('mag_x', 0.0), get('mag_y', 0.0), get('mag_z', 0.0)]),
+                          get('pres', pressure_from_msl_altitude(alt)),
+                          get('temp', 25.0),
+                          get('lat', 45.0),
+                          get('lon', -122.0),
+                          get('gps_alt', alt),
+                          int(get('fix', 1.0)),
+                          int(get('sats', 8.0)),
+                          get('heading', 0.0),
+                          truth_alt=alt,
+                          truth_accel=get('truth_acc_z', 0.0))
 
 class NetworkStreamSim(DataSource):
     def __init__(self, port=9000):
@@ -334,8 +432,9 @@ class PadDelaySim(DataSource):
             return packet
 
 class RotatedSim(DataSource):
-    """Wraps another DataSource and applies a 90-degree axis rotation to sensor data."""
-    def __init__(self, source: DataSource, rotation_deg=None):
+    """Wraps another DataSource and applies a 90-degree axis rotation to sensor data.
+    Pass `seed` to pick the random rotation reproducibly."""
+    def __init__(self, source: DataSource, rotation_deg=None, seed=None):
         self.source = source
 
         if rotation_deg is None:
@@ -366,7 +465,7 @@ class RotatedSim(DataSource):
                 (0, 270, 270),
             ]
 
-            rotation_deg = rotations_90deg[np.random.randint(0, len(rotations_90deg))]
+            rotation_deg = rotations_90deg[np.random.default_rng(seed).integers(0, len(rotations_90deg))]
             self.rotation = Rotation.from_euler('xyz', rotation_deg, degrees=True)
 
             print(f"[Sim] Applying random 90° rotation: {rotation_deg}")
@@ -374,6 +473,7 @@ class RotatedSim(DataSource):
             # Use specified rotation
             self.rotation = Rotation.from_euler('xyz', rotation_deg, degrees=True)
             print(f"[Sim] Applying specified rotation: {rotation_deg}")
+        self.matrix = self.rotation.as_matrix()
 
     def is_finished(self) -> bool:
         return self.source.is_finished()
@@ -385,21 +485,33 @@ class RotatedSim(DataSource):
         if packet.truth_alt is None:
             packet.truth_alt = packet.alt
 
-        # Rotate accelerometer data (specific force)
-        packet.accel = self.rotation.apply(packet.accel)
-
-        # Rotate gyroscope data (angular velocity)
-        packet.gyro = self.rotation.apply(packet.gyro)
-
-        # Rotate magnetometer data
-        packet.mag = self.rotation.apply(packet.mag)
+        # Rotate accelerometer (specific force), gyroscope and magnetometer data
+        packet.accel = self.matrix @ packet.accel
+        packet.gyro = self.matrix @ packet.gyro
+        packet.mag = self.matrix @ packet.mag
 
         return packet
 
+    def get_next_block(self, rows: int = BLOCK_ROWS) -> PacketBlock:
+        block = self.source.get_next_block(rows)
+        block.truth_alt = np.where(np.isnan(block.truth_alt), block.alt, block.truth_alt)
+        # Row vectors: v @ R.T rotates every packet at once
+        block.accel = block.accel @ self.matrix.T
+        block.gyro = block.gyro @ self.matrix.T
+        block.mag = block.mag @ self.matrix.T
+        return block
+
 class NoisySim(DataSource):
-    """Wraps another DataSource and adds Gaussian noise to sensor data."""
+    """Wraps another DataSource and adds Gaussian noise to sensor data.
+
+    Noise is drawn NOISE_BLOCK_ROWS packets at a time, so each packet or block
+    only takes rows from a pregenerated array. A given `seed` produces the same
+    noise whether the run is read packet by packet or in blocks."""
+
+    NOISE_BLOCK_ROWS = 4096
+
     def __init__(self, source: DataSource,
-                 accel_noise=0.05, gyro_noise=0.01, mag_noise=0.5, baro_noise=0.5):
+                 accel_noise=0.05, gyro_noise=0.01, mag_noise=0.5, baro_noise=0.5, seed=None):
         """
         Args:
             source: DataSource to wrap
@@ -407,12 +519,18 @@ class NoisySim(DataSource):
             gyro_noise: Gyroscope noise std dev (rad/s)
             mag_noise: Magnetometer noise std dev (uT)
             baro_noise: Barometer noise std dev (hPa)
+            seed: Seed for the noise generator (None: fresh entropy)
         """
         self.source = source
         self.accel_noise = accel_noise
         self.gyro_noise = gyro_noise
         self.mag_noise = mag_noise
         self.baro_noise = baro_noise
+        self.rng = np.random.default_rng(seed)
+        # Per-row std devs: accel xyz, gyro xyz, mag xyz, pressure
+        self._sigma = np.repeat([accel_noise, gyro_noise, mag_noise, baro_noise], [3, 3, 3, 1])
+        self._noise = np.empty((0, 10))
+        self._noise_pos = 0
 
         print(f"[Sim] Applying Gaussian noise:")
         print(f"      Accel: {accel_noise:.3f} m/s², Gyro: {gyro_noise:.3f} rad/s")
@@ -429,10 +547,29 @@ class NoisySim(DataSource):
             packet.truth_alt = packet.alt
 
         # Add Gaussian noise to each sensor
-        packet.accel += np.random.normal(0, self.accel_noise, 3)
-        packet.gyro += np.random.normal(0, self.gyro_noise, 3)
-        packet.mag += np.random.normal(0, self.mag_noise, 3)
-
-        packet.pressure += np.random.normal(0, self.baro_noise)
+        noise = self._take_noise(1)[0]
+        packet.accel = packet.accel + noise[0:3]
+        packet.gyro = packet.gyro + noise[3:6]
+        packet.mag = packet.mag + noise[6:9]
+        packet.pressure += float(noise[9])
 
         return packet
+
+    def get_next_block(self, rows: int = BLOCK_ROWS) -> PacketBlock:
+        block = self.source.get_next_block(rows)
+        block.truth_alt = np.where(np.isnan(block.truth_alt), block.alt, block.truth_alt)
+        noise = self._take_noise(len(block))
+        block.accel = block.accel + noise[:, 0:3]
+        block.gyro = block.gyro + noise[:, 3:6]
+        block.mag = block.mag + noise[:, 6:9]
+        block.pressure = block.pressure + noise[:, 9]
+        return block
+
+    def _take_noise(self, rows: int) -> np.ndarray:
+        if self._noise_pos + rows > len(self._noise):
+            fresh = self.rng.standard_normal((max(rows, self.NOISE_BLOCK_ROWS), 10)) * self._sigma
+            self._noise = np.concatenate((self._noise[self._noise_pos:], fresh))
+            self._noise_pos = 0
+        noise = self._noise[self._noise_pos:self._noise_pos + rows]
+        self._noise_pos += rows
+        return noise
@@ -0,0 +1,405 @@
+from __future__ import annotations
+
+import hashlib
+import math
+import os
+import re
+import struct
+import tempfile
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Optional
+
+import numpy as np
+
+CACHE_SUFFIX = ".astracache"
+CACHE_MAGIC = b"ASTRADSC"
+CACHE_VERSION = 2  # bump when the layout or the normalization below changes
+CACHE_ALIGN = 64
+CACHE_NAME_BYTES = 32
+CACHE_HEADER = struct.Struct("<8sIIQII32s")
+
+FLAG_OPENROCKET = 1
+
+GRAVITY_MPS2 = 9.80665
+OPENROCKET_GRAVITY_MPS2 = 9.81
+SEA_LEVEL_PRESSURE_HPA = 1013.25
+MSL_ALTITUDE_SCALE_M = 44330.0
+MSL_ALTITUDE_EXPONENT = 0.1903
+
+# Normalized columns, in file order. Every value is float64 in SI units with
+# the CSV defaults already applied, so a reader can build packets row by row.
+COLUMNS = (
+    "time",
+    "acc_x", "acc_y", "acc_z",
+    "gyro_x", "gyro_y", "gyro_z",
+    "mag_x", "mag_y", "mag_z",
+    "pres", "temp",
+    "lat", "lon", "gps_alt",
+    "fix", "sats", "heading",
+    "truth_alt", "truth_acc_z",
+)
+
+# Header keywords per column, matched as substrings of the lower-cased header
+# cell. Order matters: the first key whose keywords match a cell claims it.
+COLUMN_KEYWORDS = {
+    "time": ["time", "timestamp"],
+    "alt": ["state - pz", "pos_z", "position z", "altitude", "alt asl", "alt agl", "height", "disp z"],
+    "acc_x": ["accx", "acc_x", "acc x", "acceleration x"],
+    "acc_y": ["accy", "acc_y", "acc y", "acceleration y"],
+    "acc_z": ["accz", "acc_z", "acc z", "acceleration z", "vertical acc"],
+    "gyro_x": ["gyrox", "gyro_x", "gyro x"],
+    "gyro_y": ["gyroy", "gyro_y", "gyro y"],
+    "gyro_z": ["gyroz", "gyro_z", "gyro z"],
+    "mag_x": ["magx", "mag_x", "mag x"],
+    "mag_y": ["magy", "mag_y", "mag y"],
+    "mag_z": ["magz", "mag_z", "mag z"],
+    "lat": ["latitude", " lat"],
+    "lon": ["longitude", " lon"],
+    "gps_alt": ["gps - alt", "gps alt", " max-m10s - alt", "mockgps - alt", "alt (m)"],
+    "fix": ["fix quality", "fix", "gps fix"],
+    "sats": ["satellites", "num sats", "sats"],
+    "heading": ["heading", "course"],
+    "truth_acc_z": ["truth accel", "true accel", "inertial accel"],
+    "pres": ["pressure", "baro", "pres"],
+    "temp": ["temperature", "temp"],
+}
+
+
+@dataclass(frozen=True)
+class ColumnMatch:
+    """CSV column feeding one normalized key: ``(value + offset) * scale / divisor``."""
+
+    index: int
+    scale: float = 1.0
+    offset: float = 0.0
+    divisor: float = 1.0
+
+
+@dataclass
+class Dataset:
+    columns: dict[str, np.ndarray]
+    is_openrocket: bool
+    sha256: str
+    header_line: int = 0  # 1-based; 0 when loaded from a cache
+    header_map: Optional[dict[str, int]] = None
+    cache_path: Optional[Path] = None
+
+    def __len__(self) -> int:
+        return len(self.columns["time"])
+
+
+def match_columns(cells: list[str]) -> dict[str, ColumnMatch]:
+    """Maps normalized keys to header cells, with the unit conversion implied by each name."""
+    clean = [cell.lower().replace("#", "").replace('"', "").strip() for cell in cells]
+    found: dict[str, ColumnMatch] = {}
+    for index, name in enumerate(clean):
+        for key, keywords in COLUMN_KEYWORDS.items():
+            if key in found or not any(keyword in name for keyword in keywords):
+                continue
+            scale, offset, divisor = 1.0, 0.0, 1.0
+            if key == "temp" and "f" in name and "c" not in name:
+                scale, offset, divisor = 5.0, -32.0, 9.0  # (F - 32) * 5 / 9
+            elif key == "alt" and ("ft" in name or "feet" in name):
+                scale = 0.3048
+            elif key in ("acc_x", "acc_y", "acc_z") and "g" in name and "mag" not in name:
+                scale = GRAVITY_MPS2
+            elif key in ("gyro_x", "gyro_y", "gyro_z") and "deg" in name and "rad" not in name:
+                scale = math.pi / 180.0
+            found[key] = ColumnMatch(index, scale, offset, divisor)
+    return found
+
+
+def convert_units(value, scale: float, offset: float = 0.0, divisor: float = 1.0):
+    """``(value + offset) * scale / divisor`` for a float or an array, in that order.
+
+    Steps that do nothing are skipped, so every converted value rounds exactly
+    like the per-cell expression it replaces.
+    """
+    if offset:
+        value = value + offset
+    value = value * scale
+    if divisor != 1.0:
+        value = value / divisor
+    return value
+
+
+def load_dataset(path: Path | str, *, use_cache: bool = True) -> Dataset:
+    """Loads a flight CSV as normalized columns, going through the cache file when possible."""
+    path = Path(path)
+    raw = path.read_bytes()
+    digest = hashlib.sha256(raw).hexdigest()
+    expected = manifest_sha256(path)
+    if expected is not None and expected != digest:
+        print(f"[Sim] Warning: {path.name} does not match its manifest.yaml sha256")
+
+    cache_path = cache_path_for(path, digest)
+    if use_cache and cache_path.is_file():
+        try:
+            dataset = read_cache(cache_path)
+        except (OSError, ValueError):
+            dataset = None
+        if dataset is not None and dataset.sha256 == digest:
+            return dataset
+
+    dataset = parse_csv(raw.decode("utf-8-sig", errors="ignore"), digest)
+    if use_cache:
+        try:
+            write_cache(cache_path, dataset)
+            dataset.cache_path = cache_path
+            _remove_stale_caches(path, keep=cache_path)
+        except OSError as exc:
+            print(f"[Sim] Could not write dataset cache {cache_path.name}: {exc}")
+    return dataset
+
+
+def parse_csv(text: str, sha256: str = "") -> Dataset:
+    lines = text.splitlines()
+    header_index, header = _find_header(lines)
+    data_lines = [line for line in lines[header_index + 1 :] if line.strip() and not line.strip().startswith("#")]
+    used = sorted({match.index for match in header.values()})
+    values, valid = _parse_rows(data_lines, used)
+    if not np.any(valid):
+        raise ValueError("No data rows found after the header.")
+
+    position = {index: slot for slot, index in enumerate(used)}
+
+    def column(key: str) -> Optional[np.ndarray]:
+        match = header.get(key)
+        if match is None:
+            return None
+        return convert_units(values[:, position[match.index]], match.scale, match.offset, match.divisor)
+
+    # OpenRocket reports inertial acceleration (gravity removed), so the first
+    # row reads ~0 at rest; real flight data already holds specific force.
+    is_openrocket = False
+    for key in ("acc_z", "acc_x", "acc_y"):
+        first = column(key)
+        if first is not None:
+            if valid[0] and not math.isnan(first[0]):
+                is_openrocket = abs(first[0]) < 0.005
+            break
+
+    converted = {key: column(key)[valid] for key in header}
+    rows = int(np.count_nonzero(valid))
+
+    def get(key: str, default) -> np.ndarray:
+        series = converted.get(key)
+        fallback = default if isinstance(default, np.ndarray) else np.full(rows, float(default))
+        if series is None:
+            return fallback
+        # Cells past the end of a short row take the default, as with a missing column.
+        return np.where(np.isnan(series), fallback, series)
+
+    alt = get("alt", 0.0)
+    columns = {
+        "time": get("time", 0.0),
+        "acc_x": get("acc_x", 0.0),
+        "acc_y": get("acc_y", 0.0),
+        "acc_z": get("acc_z", 0.0) + (OPENROCKET_GRAVITY_MPS2 if is_openrocket else 0.0),
+        "gyro_x": get("gyro_x", 0.0),
+        "gyro_y": get("gyro_y", 0.0),
+        "gyro_z": get("gyro_z", 0.0),
+        "mag_x": get("mag_x", 0.0),
+        "mag_y": get("mag_y", 0.0),
+        "mag_z": get("mag_z", 0.0),
+        "pres": get("pres", _pressure_from_msl_altitude(alt)),
+        "temp": get("temp", 25.0),
+        "lat": get("lat", 45.0),
+        "lon": get("lon", -122.0),
+        "gps_alt": get("gps_alt", alt),
+        "fix": np.trunc(get("fix", 1.0)),
+        "sats": np.trunc(get("sats", 8.0)),
+        "heading": get("heading", 0.0),
+        "truth_alt": alt,
+        "truth_acc_z": get("truth_acc_z", 0.0),
+    }
+    return Dataset(
+        columns={name: np.ascontiguousarray(columns[name], dtype=np.float64) for name in COLUMNS},
+        is_openrocket=is_openrocket,
+        sha256=sha256,
+        header_line=header_index + 1,
+        header_map={key: match.index for key, match in header.items()},
+    )
+
+
+def cache_path_for(csv_path: Path, sha256: str) -> Path:
+    return csv_path.with_name(f"{csv_path.stem}.{sha256[:16]}{CACHE_SUFFIX}")
+
+
+def write_cache(path: Path, dataset: Dataset) -> None:
+    """Writes the dataset in the layout described in docs/dataset-cache-format.md."""
+    rows = len(dataset)
+    names = b"".join(name.encode("ascii").ljust(CACHE_NAME_BYTES, b"\0") for name in COLUMNS)
+    data_offset = _align(CACHE_HEADER.size + len(names))
+    header = CACHE_HEADER.pack(
+        CACHE_MAGIC,
+        CACHE_VERSION,
+        len(COLUMNS),
+        rows,
+        FLAG_OPENROCKET if dataset.is_openrocket else 0,
+        data_offset,
+        bytes.fromhex(dataset.sha256) if dataset.sha256 else bytes(32),
+    )
+    block = np.stack([dataset.columns[name] for name in COLUMNS]).astype("<f8", copy=False)
+
+    # Written beside the target and renamed, so readers never map a partial file.
+    fd, tmp_name = tempfile.mkstemp(prefix=f".{path.name}.", dir=path.parent)
+    try:
+        with os.fdopen(fd, "wb") as handle:
+            handle.write(header)
+            handle.write(names)
+            handle.write(bytes(data_offset - CACHE_HEADER.size - len(names)))
+            handle.write(block.tobytes())
+        os.chmod(tmp_name, _new_file_mode())  # mkstemp creates it 0600
+        os.replace(tmp_name, path)
+    except BaseException:
+        try:
+            os.unlink(tmp_name)
+        except OSError:
+            pass
+        raise
+
+
+def read_cache(path: Path) -> Dataset:
+    """Maps a cache file; the returned columns are read-only views of the file."""
+    with path.open("rb") as handle:
+        head = handle.read(CACHE_HEADER.size)
+        if len(head) < CACHE_HEADER.size:
+            raise ValueError(f"{path}: truncated dataset cache")
+        magic, version, column_count, rows, flags, data_offset, digest = CACHE_HEADER.unpack(head)
+        if magic != CACHE_MAGIC:
+            raise ValueError(f"{path}: not a dataset cache")
+        if version != CACHE_VERSION:
+            raise ValueError(f"{path}: unsupported dataset cache version {version}")
+        names_raw = handle.read(column_count * CACHE_NAME_BYTES)
+    names = [
+        names_raw[i : i + CACHE_NAME_BYTES].rstrip(b"\0").decode("ascii")
+        for i in range(0, len(names_raw), CACHE_NAME_BYTES)
+    ]
+    if len(names) != column_count or path.stat().st_size < data_offset + column_count * rows * 8:
+        raise ValueError(f"{path}: truncated dataset cache")
+    if rows == 0:
+        raise ValueError(f"{path}: empty dataset cache")
+    block = np.memmap(path, dtype="<f8", mode="r", offset=data_offset, shape=(column_count, rows))
+    columns = {name: block[i] for i, name in enumerate(names)}
+    missing = [name for name in COLUMNS if name not in columns]
+    if missing:
+        raise ValueError(f"{path}: dataset cache is missing {', '.join(missing)}")
+    return Dataset(
+        columns=columns,
+        is_openrocket=bool(flags & FLAG_OPENROCKET),
+        sha256=digest.hex(),
+        cache_path=path,
+    )
+
+
+def read_manifest(path: Path) -> list[dict[str, str]]:
+    """Reads the flat ``datasets:`` list of a dataset manifest.yaml."""
+    entries: list[dict[str, str]] = []
+    current: Optional[dict[str, str]] = None
+    in_datasets = False
+    for raw_line in path.read_text(encoding="utf-8").splitlines():
+        line = raw_line.split("#", 1)[0].rstrip()
+        if not line.strip():
+            continue
+        if not raw_line.startswith((" ", "-")):
+            in_datasets = line.strip() == "datasets:"
+            continue
+        if not in_datasets:
+            continue
+        stripped = line.strip()
+        if stripped.startswith("- "):
+            current = {}
+            entries.append(current)
+            stripped = stripped[2:].strip()
+        if current is not None and ":" in stripped:
+            key, value = stripped.split(":", 1)
+            current[key.strip()] = value.strip().strip('"').strip("'")
+    return entries
+
+
+def manifest_sha256(csv_path: Path) -> Optional[str]:
+    """The sha256 recorded for `csv_path` in the nearest manifest.yaml, if any."""
+    resolved = csv_path.resolve()
+    for directory in list(resolved.parents)[:3]:
+        manifest = directory / "manifest.yaml"
+        if not manifest.is_file():
+            continue
+        for entry in read_manifest(manifest):
+            if "path" in entry and (directory / entry["path"]).resolve() == resolved:
+                return entry.get("sha256")
+        return None
+    return None
+
+
+def _find_header(lines: list[str]) -> tuple[int, dict[str, ColumnMatch]]:
+    for index, line in enumerate(lines):
+        cells = line.split(",")
+        if len(cells) < 2:
+            continue
+        found = match_columns(cells)
+        if "time" in found and "alt" in found:
+            print(f"[Sim] Found Header at line {index + 1}. Map: { {key: match.index for key, match in found.items()} }")
+            return index, found
+    raise ValueError("Headers not found.")
+
+
+def _parse_rows(lines: list[str], used: list[int]) -> tuple[np.ndarray, np.ndarray]:
+    """Parses the used columns of every row; returns (values, valid).
+
+    Cells past the end of a short row are NaN; rows with a cell that is not a
+    number are marked invalid and skipped by the caller.
+    """
+    if not lines:
+        return np.zeros((0, len(used))), np.zeros(0, dtype=bool)
+    try:
+        values = np.loadtxt(lines, delimiter=",", usecols=used, dtype=np.float64, ndmin=2, comments=None)
+        return values, np.ones(len(values), dtype=bool)
+    except ValueError:
+        pass
+
+    # Slow path for ragged or partly non-numeric files: still one pass per
+    # column rather than one converter call per cell.
+    split = [line.split(",") for line in lines]
+    values = np.full((len(split), len(used)), np.nan)
+    valid = np.ones(len(split), dtype=bool)
+    for slot, index in enumerate(used):
+        cells = [row[index] if index < len(row) else "nan" for row in split]
+        try:
+            values[:, slot] = np.asarray(cells, dtype=np.float64)
+            continue
+        except ValueError:
+            pass
+        for row, cell in enumerate(cells):
+            try:
+                values[row, slot] = float(cell)
+            except ValueError:
+                valid[row] = False
+    return values, valid
+
+
+def _pressure_from_msl_altitude(altitude_m: np.ndarray) -> np.ndarray:
+    ratio = np.maximum(0.0, 1.0 - altitude_m / MSL_ALTITUDE_SCALE_M)
+    return SEA_LEVEL_PRESSURE_HPA * ratio ** (1.0 / MSL_ALTITUDE_EXPONENT)
+
+
+def _remove_stale_caches(csv_path: Path, *, keep: Path) -> None:
+    pattern = re.compile(re.escape(csv_path.stem) + r"\.[0-9a-f]{16}" + re.escape(CACHE_SUFFIX) + "$")
+    for candidate in csv_path.parent.glob(f"{csv_path.stem}.*{CACHE_SUFFIX}"):
+        if candidate != keep and pattern.match(candidate.name):
+            try:
+                candidate.unlink()
+            except OSError:
+                pass
+
+
+def _new_file_mode() -> int:
+    """Permissions open() would give a new file under the current umask."""
+    umask = os.umask(0)
+    os.umask(umask)
+    return 0o666 & ~umask
+
+
+def _align(offset: int) -> int:
+    return (offset + CACHE_ALIGN - 1) // CACHE_ALIGN * CACHE_ALIGN
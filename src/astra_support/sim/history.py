@@ -0,0 +1,144 @@
+from __future__ import annotations
+
+import math
+
+import numpy as np
+
+DEFAULT_HISTORY_POINTS = 20000
+HISTORY_CHUNK_ROWS = 4096
+
+# Numeric history columns, stored as one float64 row per record (NaN: missing).
+FLOAT_KEYS = (
+    "time",
+    "sim_alt",
+    "sensor_alt_agl_m",
+    "sim_acc_mps2",
+    "sensor_acc_z_mps2",
+    "sensor_alt",
+    "fc_alt",
+    "fc_vel_z_mps",
+    "fc_acc_z_mps2",
+    "fc_flap_cmd_deg",
+    "fc_flap_actual_deg",
+    "fc_est_apogee_m",
+    "fc_target_apogee_m",
+    "fc_mach",
+)
+STAGE_KEY = "fc_stage"
+NO_STAGE = -1
+
+
+class HistoryStore:
+    """Typed, bounded in-memory copy of the run for live display and the end-of-run plot.
+
+    Numeric keys live in one float64 block (NaN for missing) and the FC stage in an
+    int32 column of codes into `stages`, so recording a packet is one row store
+    plus one code store. The block grows HISTORY_CHUNK_ROWS rows at a time up to
+    `capacity`. When full, every other row is dropped and only every `stride`-th
+    new record is kept, so the store always spans the whole run at a resolution
+    that halves as it grows. Records passed with ``keep=True`` (stage changes) survive
+    decimation while they fill at most a quarter of `capacity`; past that, every
+    other one loses the guarantee, so a run that flips stage on every packet still
+    fits. Every record still goes to the on-disk log.
+
+    ``store[key]`` returns the column as an array (stage names as an object array).
+    """
+
+    def __init__(self, capacity: int = DEFAULT_HISTORY_POINTS, *, chunk_rows: int = HISTORY_CHUNK_ROWS):
+        self.capacity = max(4, capacity)  # room for a forced row after decimation
+        self.chunk_rows = max(1, min(chunk_rows, self.capacity))
+        self.stride = 1
+        self.count = 0  # records seen, kept or not
+        self.stages: list[str] = []
+        self._stage_codes: dict[str, int] = {}
+        self._values = np.empty((self.chunk_rows, len(FLOAT_KEYS)), dtype=np.float64)
+        self._stage = np.empty(self.chunk_rows, dtype=np.int32)
+        self._forced = np.empty(self.chunk_rows, dtype=bool)
+        self._rows = 0
+
+    def append(self, record: dict[str, object], *, keep: bool = False) -> None:
+        index = self.count
+        self.count += 1
+        if not keep and index % self.stride:
+            return
+        if self._rows == len(self._values):
+            self._grow()
+        row = self._rows
+        self._values[row] = [to_float(record.get(key)) for key in FLOAT_KEYS]
+        self._stage[row] = self._stage_code(record.get(STAGE_KEY))
+        self._forced[row] = keep
+        self._rows += 1
+        if self._rows >= self.capacity:
+            self._decimate()
+
+    def __getitem__(self, key: str) -> np.ndarray:
+        if key == STAGE_KEY:
+            names = np.array(self.stages + [""], dtype=object)
+            return names[self._stage[: self._rows]]  # NO_STAGE indexes the trailing ""
+        return self._values[: self._rows, _FLOAT_INDEX[key]]
+
+    def get(self, key: str, default=None):
+        return self[key] if key in _FLOAT_INDEX or key == STAGE_KEY else default
+
+    def keys(self):
+        return (*FLOAT_KEYS, STAGE_KEY)
+
+    def __len__(self) -> int:
+        return self._rows
+
+    def _stage_code(self, stage: object) -> int:
+        if stage in (None, "", "unknown"):
+            return NO_STAGE
+        name = str(stage)
+        code = self._stage_codes.get(name)
+        if code is None:
+            code = self._stage_codes[name] = len(self.stages)
+            self.stages.append(name)
+        return code
+
+    def _grow(self) -> None:
+        size = min(len(self._values) + self.chunk_rows, self.capacity)
+        self._values = np.resize(self._values, (size, len(FLOAT_KEYS)))
+        self._stage = np.resize(self._stage, size)
+        self._forced = np.resize(self._forced, size)
+
+    def _decimate(self) -> None:
+        rows = self._rows
+        forced = np.flatnonzero(self._forced[:rows])
+        while len(forced) > self.capacity // 4:
+            self._forced[forced[1::2]] = False
+            forced = forced[::2]
+        kept = self._forced[:rows] | (np.arange(rows) % 2 == 0)
+        count = int(np.count_nonzero(kept))
+        self._values[:count] = self._values[:rows][kept]
+        self._stage[:count] = self._stage[:rows][kept]
+        self._forced[:count] = self._forced[:rows][kept]
+        self._rows = count
+        self.stride *= 2
+
+
+_FLOAT_INDEX = {key: index for index, key in enumerate(FLOAT_KEYS)}
+
+
+def to_float(value: object) -> float:
+    if isinstance(value, (int, float, np.number)):
+        return float(value)
+    return math.nan
+
+
+def derive_series_rate(time_values, sample_values, *, backfill: bool = True) -> np.ndarray:
+    """Backward-difference rate of `sample_values` over `time_values`, NaN where a
+    step has no positive dt or a missing sample. With `backfill` the first element
+    takes the second's rate."""
+    time_values = np.asarray(time_values, dtype=np.float64)
+    sample_values = np.asarray(sample_values, dtype=np.float64)
+    count = min(len(time_values), len(sample_values))
+    derived = np.full(count, np.nan)
+    if count < 2:
+        return derived
+    dt = np.diff(time_values[:count])
+    with np.errstate(divide="ignore", invalid="ignore"):
+        derived[1:] = np.where(dt > 0, np.diff(sample_values[:count]) / dt, np.nan)
+    if backfill and np.isfinite(derived[1]):
+        derived[0] = derived[1]
+    return derived
@@ -4,38 +4,154 @@ import csv
 import math
 from pathlib import Path
 
+import numpy as np
+
+from .columnar import ColumnarLogWriter
+from .history import derive_series_rate
+
+LOG_FORMATS = ("csv", "columnar")
+LOG_SUFFIXES = {"csv": ".csv", "columnar": ".astracol"}
+LOG_CHUNK_ROWS = 512
+SIM_LOG_COLUMNS = ["Sim_Time", "Sim_Alt", "Sensor_Alt_AGL", "Sim_Vel_Z_mps", "Sim_Accel_Z_mps2", "Sensor_Accel_Z_mps2"]
+
 
 def write_sim_log(path: Path, history: dict[str, list], fc_header_names: list[str]) -> None:
-    real_velocity = _derive_series_rate(history["time"], history["sim_alt"])
-    real_accel = history["sim_acc_mps2"]
-    if not any(_is_number(value) for value in real_accel):
-        real_accel = _derive_series_rate(history["time"], real_velocity)
-
-    with path.open("w", newline="", encoding="utf-8") as handle:
-        writer = csv.writer(handle)
-        header = ["Sim_Time", "Sim_Alt", "Sensor_Alt_AGL", "Sim_Vel_Z_mps", "Sim_Accel_Z_mps2", "Sensor_Accel_Z_mps2"]
-        if fc_header_names:
-            header.extend(fc_header_names)
-        else:
-            header.append("FC_Raw_Data")
-        writer.writerow(header)
+    with SimLogWriter(path, fc_header_names) as writer:
         for index, timestamp in enumerate(history["time"]):
-            row = [
-                timestamp,
-                history["sim_alt"][index],
-                history["sensor_alt_agl_m"][index],
-                _nan_to_empty(real_velocity[index]) if index < len(real_velocity) else "",
-                _nan_to_empty(real_accel[index]) if index < len(real_accel) else "",
-                _nan_to_empty(history["sensor_acc_z_mps2"][index]) if index < len(history["sensor_acc_z_mps2"]) else "",
-            ]
-            fc_values = history["fc_values"][index]
-            if fc_header_names:
-                row.extend(fc_values[: len(fc_header_names)])
-                if len(fc_values) < len(fc_header_names):
-                    row.extend([""] * (len(fc_header_names) - len(fc_values)))
-            else:
-                row.extend(fc_values)
-            writer.writerow(row)
+            writer.append(
+                {
+                    "time": timestamp,
+                    "sim_alt": history["sim_alt"][index],
+                    "sensor_alt_agl_m": history["sensor_alt_agl_m"][index],
+                    "sim_acc_mps2": _at(history["sim_acc_mps2"], index),
+                    "sensor_acc_z_mps2": _at(history["sensor_acc_z_mps2"], index),
+                    "fc_values": history["fc_values"][index],
+                }
+            )
+
+
+class SimLogWriter:
+    """Writes sim log rows to disk as records arrive, `chunk_rows` at a time.
+
+    Memory use does not depend on the run length, and a crashed run keeps every
+    chunk written before the crash. Each chunk's sim velocity and acceleration are
+    derived together as arrays (history.derive_series_rate), carrying the last row
+    of the previous chunk across the boundary: velocity from consecutive
+    altitudes, acceleration from the source's truth value when it has one and from
+    velocity otherwise. The first row's derivatives are backfilled from the
+    second's, so it is written with the first chunk of two or more rows.
+
+    ``csv`` writes the FC telemetry values as columns (or raw under FC_Raw_Data
+    before a TELEM header is known); ``columnar`` writes an ASTRACOL log (see
+    docs/columnar-log-format.md) with the raw values joined by commas.
+    """
+
+    def __init__(self, path: Path, fc_header_names: list[str], *, fmt: str = "csv", chunk_rows: int = LOG_CHUNK_ROWS):
+        if fmt not in LOG_FORMATS:
+            raise ValueError(f"Unknown sim log format '{fmt}'")
+        self.path = Path(path)
+        self.fc_header_names = list(fc_header_names or [])
+        self.chunk_rows = max(1, chunk_rows)
+        self.rows = 0
+        header = SIM_LOG_COLUMNS + (self.fc_header_names or ["FC_Raw_Data"])
+        self._columnar: ColumnarLogWriter | None = None
+        self._handle = None
+        if fmt == "columnar":
+            self._columnar = ColumnarLogWriter(self.path, header, block_rows=self.chunk_rows)
+        else:
+            self._handle = self.path.open("w", newline="", encoding="utf-8")
+            self._csv = csv.writer(self._handle)
+            self._csv.writerow(header)
+        self._rows: list[list[object]] = []  # current chunk; velocity and accel are filled in when it is written
+        self._prev: tuple[float, float, float] | None = None  # time, sim_alt, velocity of the last written row
+
+    def append(self, record: dict[str, object]) -> None:
+        row = [
+            record["time"],
+            record["sim_alt"],
+            record["sensor_alt_agl_m"],
+            "",
+            record.get("sim_acc_mps2", math.nan),
+            _nan_to_empty(record.get("sensor_acc_z_mps2", math.nan)),
+        ]
+        row.extend(self._fc_columns(record.get("fc_values") or []))
+        self._rows.append(row)
+        self.rows += 1
+        if len(self._rows) >= self.chunk_rows:
+            self._write_chunk()
+
+    def flush(self) -> None:
+        self._write_chunk()
+        if self._columnar is not None:
+            self._columnar.flush()
+
+    def close(self) -> None:
+        self._write_chunk(final=True)
+        self.flush()
+        if self._handle is not None and not self._handle.closed:
+            self._handle.close()
+        if self._columnar is not None:
+            self._columnar.close()
+
+    def __enter__(self) -> "SimLogWriter":
+        return self
+
+    def __exit__(self, *_exc) -> None:
+        self.close()
+
+    def _fc_columns(self, fc_values: list[str]) -> list[object]:
+        if self._columnar is not None and not self.fc_header_names:
+            return [",".join(fc_values)]
+        if not self.fc_header_names:
+            return list(fc_values)
+        row = list(fc_values[: len(self.fc_header_names)])
+        if len(row) < len(self.fc_header_names):
+            row.extend([""] * (len(self.fc_header_names) - len(row)))
+        return row
+
+    def _write_chunk(self, *, final: bool = False) -> None:
+        count = len(self._rows)
+        if count == 0 or (self._prev is None and count == 1 and not final):
+            return  # the first row waits for the second to backfill its derivatives
+        rows = self._rows
+        times = _float_column([row[0] for row in rows])
+        alts = _float_column([row[1] for row in rows])
+        use_derived = np.isnan(_float_column([row[4] for row in rows]))
+        if self._prev is None:
+            velocity = derive_series_rate(times, alts)
+            derived = derive_series_rate(times, velocity)
+        else:
+            prev_time, prev_alt, prev_velocity = self._prev
+            times = np.concatenate(([prev_time], times))
+            velocity = derive_series_rate(times, np.concatenate(([prev_alt], alts)), backfill=False)
+            velocity[0] = prev_velocity
+            derived = derive_series_rate(times, velocity, backfill=False)[1:]
+            velocity = velocity[1:]
+            times = times[1:]
+        self._prev = (times[-1], alts[-1], velocity[-1])
+
+        for row, vel, acc, derive in zip(rows, velocity.tolist(), derived.tolist(), use_derived.tolist()):
+            row[3] = _nan_to_empty(vel)
+            row[4] = _nan_to_empty(acc) if derive else row[4]
+        self._rows = []
+        if self._columnar is not None:
+            for row in rows:
+                self._columnar.append_row(row)
+        else:
+            self._csv.writerows(rows)
+            self._handle.flush()
+
+
+def _at(values: list, index: int):
+    return values[index] if index < len(values) else math.nan
+
+
+def _float_column(values: list) -> np.ndarray:
+    """`values` as float64, NaN for anything that is not a number."""
+    column = np.array(values)
+    if column.dtype.kind in "biuf":
+        return column.astype(np.float64)
+    return np.array([value if _is_number(value) else math.nan for value in values], dtype=np.float64)
 
 
 def _is_number(value) -> bool:
@@ -46,25 +162,3 @@ def _nan_to_empty(value):
     if _is_number(value):
         return value
     return ""
-
-
-def _derive_series_rate(time_values: list[float], sample_values: list[float]) -> list[float]:
-    if not time_values or not sample_values:
-        return []
-
-    derived = [float("nan")] * min(len(time_values), len(sample_values))
-    for index in range(1, len(derived)):
-        prev_time = time_values[index - 1]
-        curr_time = time_values[index]
-        prev_value = sample_values[index - 1]
-        curr_value = sample_values[index]
-        if not (_is_number(prev_value) and _is_number(curr_value)):
-            continue
-        dt = curr_time - prev_time
-        if dt <= 0:
-            continue
-        derived[index] = (curr_value - prev_value) / dt
-
-    if len(derived) > 1 and _is_number(derived[1]):
-        derived[0] = derived[1]
-    return derived
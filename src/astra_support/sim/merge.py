@@ -0,0 +1,213 @@
+from __future__ import annotations
+
+import csv
+import heapq
+import math
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Iterator, Optional
+
+from .dataset_cache import GRAVITY_MPS2, SEA_LEVEL_PRESSURE_HPA, convert_units, match_columns
+
+FLIGHT_TIME_COLUMN = "Flight_Time_(s)"
+
+HOLD = "hold"      # last sample at or before t
+LINEAR = "linear"  # interpolated between the samples around t
+
+
+@dataclass(frozen=True)
+class ColumnSpec:
+    """One CSV column feeding a normalized key (dataset_cache.COLUMNS): ``(value + offset) * scale / divisor``."""
+
+    key: str
+    column: str
+    scale: float = 1.0
+    offset: float = 0.0
+    method: str = LINEAR
+    divisor: float = 1.0
+
+
+@dataclass(frozen=True)
+class MergeInput:
+    path: Path
+    columns: tuple[ColumnSpec, ...]
+    time_column: str = FLIGHT_TIME_COLUMN
+
+
+@dataclass
+class MergedSample:
+    time: float
+    values: dict[str, float]
+    fresh: frozenset[str] = field(default_factory=frozenset)  # keys with a real sample at `time`
+
+
+_DEG = math.pi / 180.0
+
+# Blue Raven recorder exports. The X axis runs along the rocket, which is the
+# sim's vertical z axis; Y and Z map onto the sim's x and y.
+BLUE_RAVEN_HIGH_RATE = (
+    ColumnSpec("acc_z", "Accel_X", GRAVITY_MPS2),
+    ColumnSpec("acc_x", "Accel_Y", GRAVITY_MPS2),
+    ColumnSpec("acc_y", "Accel_Z", GRAVITY_MPS2),
+    ColumnSpec("gyro_z", "Gyro_X", _DEG),
+    ColumnSpec("gyro_x", "Gyro_Y", _DEG),
+    ColumnSpec("gyro_y", "Gyro_Z", _DEG),
+)
+BLUE_RAVEN_LOW_RATE = (
+    ColumnSpec("truth_alt", "Baro_Altitude_AGL_(feet)", 0.3048),
+    ColumnSpec("pres", "Baro_Press_(atm)", SEA_LEVEL_PRESSURE_HPA),
+    ColumnSpec("temp", "Temperature_(F)", 5.0, -32.0, HOLD, divisor=9.0),
+)
+
+# Keys that are counts or flags and must not be interpolated.
+_HOLD_KEYS = {"fix", "sats"}
+
+
+def detect_columns(header: list[str]) -> tuple[ColumnSpec, ...]:
+    """Column specs for a CSV header: the Blue Raven layouts by name, anything else by keyword."""
+    names = {name.strip() for name in header}
+    specs = tuple(spec for spec in BLUE_RAVEN_HIGH_RATE + BLUE_RAVEN_LOW_RATE if spec.column in names)
+    if specs:
+        return specs
+
+    found = match_columns(header)
+    detected = []
+    for key, match in found.items():
+        if key == "time":
+            continue
+        detected.append(
+            ColumnSpec(
+                "truth_alt" if key == "alt" else key,
+                header[match.index].strip(),
+                match.scale,
+                match.offset,
+                HOLD if key in _HOLD_KEYS else LINEAR,
+                match.divisor,
+            )
+        )
+    return tuple(detected)
+
+
+def detect_time_column(header: list[str]) -> str:
+    names = [name.strip() for name in header]
+    if FLIGHT_TIME_COLUMN in names:
+        return FLIGHT_TIME_COLUMN
+    found = match_columns(header)
+    if "time" not in found:
+        raise ValueError("No time column found.")
+    return names[found["time"].index]
+
+
+def merge_input(path: Path | str) -> MergeInput:
+    """A MergeInput for `path` with its time column and columns detected from the header."""
+    path = Path(path)
+    with path.open("r", encoding="utf-8-sig", errors="ignore", newline="") as handle:
+        header = next(csv.reader(handle), [])
+    header = [name.replace("#", "").strip() for name in header]
+    columns = detect_columns(header)
+    if not columns:
+        raise ValueError(f"{path.name}: no sensor columns recognized.")
+    return MergeInput(path, columns, detect_time_column(header))
+
+
+def merge_streams(inputs: list[MergeInput]) -> Iterator[MergedSample]:
+    """Merge-joins time-sorted CSVs into one stream on the union of their timestamps.
+
+    Each file is read one row at a time, so memory does not grow with the run.
+    At every timestamp each key takes its own source's value: held from the last
+    sample or interpolated towards the next one, per ColumnSpec. Before a source's
+    first sample its first values are used, after its last sample they are held.
+    When two inputs provide the same key, the one listed first wins.
+    """
+    cursors: list[_Cursor] = []
+    claimed: set[str] = set()
+    for item in inputs:
+        columns = tuple(spec for spec in item.columns if spec.key not in claimed)
+        if not columns:
+            continue
+        claimed.update(spec.key for spec in columns)
+        cursor = _Cursor(item, columns)
+        if cursor.next is not None:
+            cursors.append(cursor)
+        else:
+            cursor.close()
+
+    try:
+        heap = [(cursor.next[0], index) for index, cursor in enumerate(cursors)]
+        heapq.heapify(heap)
+        while heap:
+            now = heap[0][0]
+            fresh: set[str] = set()
+            while heap and heap[0][0] == now:
+                _, index = heapq.heappop(heap)
+                cursor = cursors[index]
+                cursor.advance()
+                fresh.update(spec.key for spec in cursor.columns)
+                if cursor.next is not None:
+                    heapq.heappush(heap, (cursor.next[0], index))
+
+            values: dict[str, float] = {}
+            for cursor in cursors:
+                cursor.sample(now, values)
+            yield MergedSample(now, values, frozenset(fresh))
+    finally:
+        for cursor in cursors:
+            cursor.close()
+
+
+class _Cursor:
+    """Streams one CSV, keeping the samples either side of the merge time."""
+
+    def __init__(self, item: MergeInput, columns: tuple[ColumnSpec, ...]):
+        self.columns = columns
+        self._handle = item.path.open("r", encoding="utf-8-sig", errors="ignore", newline="")
+        self._reader = csv.reader(self._handle)
+        header = [name.replace("#", "").strip() for name in next(self._reader, [])]
+        try:
+            self._time_index = header.index(item.time_column)
+            self._indices = [header.index(spec.column) for spec in columns]
+        except ValueError as exc:
+            self._handle.close()
+            raise ValueError(f"{item.path.name}: {exc}") from None
+        self.prev: Optional[tuple[float, list[float]]] = None
+        self.next = self._read()
+
+    def advance(self) -> None:
+        self.prev = self.next
+        self.next = self._read()
+
+    def sample(self, now: float, out: dict[str, float]) -> None:
+        prev = self.prev or self.next
+        after = self.next
+        for slot, spec in enumerate(self.columns):
+            value = prev[1][slot]
+            if spec.method == LINEAR and after is not None and after[0] > prev[0] and now > prev[0]:
+                fraction = (now - prev[0]) / (after[0] - prev[0])
+                value += (after[1][slot] - value) * fraction
+            out[spec.key] = value
+
+    def close(self) -> None:
+        self._handle.close()
+
+    def _read(self) -> Optional[tuple[float, list[float]]]:
+        last_time = self.prev[0] if self.prev is not None else -math.inf
+        last_values = self.prev[1] if self.prev is not None else None
+        for row in self._reader:
+            try:
+                now = float(row[self._time_index])
+            except (ValueError, IndexError):
+                continue
+            if not now > last_time:
+                continue  # out-of-order or repeated timestamp
+            values = []
+            for slot, (spec, index) in enumerate(zip(self.columns, self._indices)):
+                try:
+                    value = convert_units(float(row[index]), spec.scale, spec.offset, spec.divisor)
+                except (ValueError, IndexError):
+                    value = math.nan
+                if math.isnan(value):
+                    # A missing cell keeps the previous sample's value.
+                    value = last_values[slot] if last_values is not None else math.nan
+                values.append(value)
+            return now, values
+        return None
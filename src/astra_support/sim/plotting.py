@@ -1,36 +1,60 @@
 from __future__ import annotations
 
 import math
+import time
 
 import matplotlib.pyplot as plt
+import numpy as np
 
+from .history import derive_series_rate, to_float
 
-def plot_history(history: dict[str, list], *, source_name: str) -> None:
-    if not history["time"]:
+# Points drawn per line for each horizontal pixel of the axes.
+POINTS_PER_PIXEL = 2
+LIVE_PLOT_POINTS = 2000
+LIVE_PLOT_REFRESH_ROWS = 250
+LIVE_PLOT_DRAW_INTERVAL_S = 0.5
+
+
+def plot_history(history, *, source_name: str) -> None:
+    """Plots a HistoryStore (or any mapping of equal-length columns).
+
+    Each line is decimated with LTTB to about POINTS_PER_PIXEL points per pixel
+    of figure width, so drawing time does not grow with the run. Stage-change
+    samples are always kept and their markers use the full-resolution times.
+    """
+    time_values = _column(history, "time")
+    if not len(time_values):
         return
 
     # Velocity and acceleration panels are temporarily disabled.
-    # real_velocity = _derive_series_rate(history["time"], history["sim_alt"])
+    # real_velocity = derive_series_rate(history["time"], history["sim_alt"])
     # real_accel = history["sim_acc_mps2"]
     # if not any(_is_number(value) for value in real_accel):
-    #     real_accel = _derive_series_rate(history["time"], real_velocity)
+    #     real_accel = derive_series_rate(history["time"], real_velocity)
 
     fig, (ax_alt, ax_ctrl) = plt.subplots(2, 1, figsize=(12, 8), sharex=True)
-    ax_alt.plot(history["time"], history["sim_alt"], label="Real altitude", color="tab:blue")
-    if any(_is_number(value) for value in history["sensor_alt_agl_m"]):
-        ax_alt.plot(
-            history["time"],
-            [_nan_to_none(value) for value in history["sensor_alt_agl_m"]],
+    points = plot_points(fig)
+    stage_indices = _stage_change_indices(history)
+
+    def plot(axis, key, **style):
+        x, y = decimate_series(time_values, _column(history, key), points, keep=stage_indices)
+        axis.plot(x, y, **style)
+
+    plot(ax_alt, "sim_alt", label="Real altitude", color="tab:blue")
+    if _has_numbers(history, "sensor_alt_agl_m"):
+        plot(
+            ax_alt,
+            "sensor_alt_agl_m",
             label="Sensor altitude",
             color="tab:cyan",
             linestyle="--",
         )
-    if any(_is_number(value) for value in history["fc_alt"]):
-        ax_alt.plot(history["time"], [_nan_to_none(value) for value in history["fc_alt"]], label="FC altitude", color="tab:orange")
-    if any(_is_number(value) for value in history["fc_est_apogee_m"]):
-        ax_alt.plot(history["time"], [_nan_to_none(value) for value in history["fc_est_apogee_m"]], label="Pred apogee", color="tab:red")
-    if any(_is_number(value) for value in history["fc_target_apogee_m"]):
-        ax_alt.plot(history["time"], [_nan_to_none(value) for value in history["fc_target_apogee_m"]], label="Target apogee", color="tab:purple")
+    if _has_numbers(history, "fc_alt"):
+        plot(ax_alt, "fc_alt", label="FC altitude", color="tab:orange")
+    if _has_numbers(history, "fc_est_apogee_m"):
+        plot(ax_alt, "fc_est_apogee_m", label="Pred apogee", color="tab:red")
+    if _has_numbers(history, "fc_target_apogee_m"):
+        plot(ax_alt, "fc_target_apogee_m", label="Target apogee", color="tab:purple")
     ax_alt.set_ylabel("Altitude (m)")
     ax_alt.grid(True, linestyle="--", alpha=0.3)
 
@@ -78,10 +102,10 @@ def plot_history(history: dict[str, list], *, source_name: str) -> None:
     # _show_legend_if_needed(ax_vel)
     # _show_legend_if_needed(ax_acc)
 
-    if any(_is_number(value) for value in history["fc_flap_cmd_deg"]):
-        ax_ctrl.plot(history["time"], [_nan_to_none(value) for value in history["fc_flap_cmd_deg"]], label="Flap cmd", color="tab:green")
-    if any(_is_number(value) for value in history["fc_flap_actual_deg"]):
-        ax_ctrl.plot(history["time"], [_nan_to_none(value) for value in history["fc_flap_actual_deg"]], label="Flap actual", color="tab:brown")
+    if _has_numbers(history, "fc_flap_cmd_deg"):
+        plot(ax_ctrl, "fc_flap_cmd_deg", label="Flap cmd", color="tab:green")
+    if _has_numbers(history, "fc_flap_actual_deg"):
+        plot(ax_ctrl, "fc_flap_actual_deg", label="Flap actual", color="tab:brown")
     ax_ctrl.set_xlabel("Time (s)")
     ax_ctrl.set_ylabel("Control")
     ax_ctrl.grid(True, linestyle="--", alpha=0.3)
@@ -91,48 +115,184 @@ def plot_history(history: dict[str, list], *, source_name: str) -> None:
     plt.show()
 
 
-def _is_number(value) -> bool:
-    return isinstance(value, (int, float)) and not math.isnan(value)
-
-
-def _nan_to_none(value):
-    if _is_number(value):
-        return value
-    return None
-
-
-def _stage_changes(history: dict[str, list]) -> list[tuple[float, object]]:
-    changes: list[tuple[float, object]] = []
-    last_stage = object()
-    for timestamp, stage_value in zip(history.get("time", []), history.get("fc_stage", [])):
-        if stage_value in ("", None, "unknown"):
-            continue
-        if stage_value != last_stage:
-            changes.append((timestamp, stage_value))
-            last_stage = stage_value
-    return changes
-
-
-def _derive_series_rate(time_values: list[float], sample_values: list[float]) -> list[float]:
-    if not time_values or not sample_values:
-        return []
-
-    derived = [math.nan] * min(len(time_values), len(sample_values))
-    for index in range(1, len(derived)):
-        prev_time = time_values[index - 1]
-        curr_time = time_values[index]
-        prev_value = sample_values[index - 1]
-        curr_value = sample_values[index]
-        if not (_is_number(prev_value) and _is_number(curr_value)):
-            continue
-        dt = curr_time - prev_time
-        if dt <= 0:
-            continue
-        derived[index] = (curr_value - prev_value) / dt
-
-    if len(derived) > 1 and _is_number(derived[1]):
-        derived[0] = derived[1]
-    return derived
+class LivePlot:
+    """Altitude and control plot that is updated while the sim runs.
+
+    Records are buffered and added every `refresh_rows` records. Each block is
+    decimated with LTTB at the current keep ratio before it is appended; when a
+    line passes `max_points` the drawn points are decimated again to half that
+    and the ratio halves, so every refresh costs the same however long the run.
+    The figure is redrawn at most every `draw_interval_s`. Stage changes are
+    marked at their exact times.
+    """
+
+    SERIES = (
+        (0, "sim_alt", {"label": "Real altitude", "color": "tab:blue"}),
+        (0, "sensor_alt_agl_m", {"label": "Sensor altitude", "color": "tab:cyan", "linestyle": "--"}),
+        (0, "fc_alt", {"label": "FC altitude", "color": "tab:orange"}),
+        (1, "fc_flap_cmd_deg", {"label": "Flap cmd", "color": "tab:green"}),
+        (1, "fc_flap_actual_deg", {"label": "Flap actual", "color": "tab:brown"}),
+    )
+
+    def __init__(
+        self,
+        *,
+        source_name: str,
+        max_points: int = LIVE_PLOT_POINTS,
+        refresh_rows: int = LIVE_PLOT_REFRESH_ROWS,
+        draw_interval_s: float = LIVE_PLOT_DRAW_INTERVAL_S,
+    ):
+        self.max_points = max(4, max_points)
+        self.refresh_rows = max(1, refresh_rows)
+        self.draw_interval_s = draw_interval_s
+        self._last_draw = -math.inf
+        self.ratio = 1.0
+        self.fig, self.axes = plt.subplots(2, 1, figsize=(12, 8), sharex=True)
+        self.fig.suptitle(f"Astra Support Simulation (live): {source_name}")
+        self.axes[0].set_ylabel("Altitude (m)")
+        self.axes[1].set_xlabel("Time (s)")
+        self.axes[1].set_ylabel("Control")
+        for axis in self.axes:
+            axis.grid(True, linestyle="--", alpha=0.3)
+        self.lines = [self.axes[panel].plot([], [], **style)[0] for panel, _, style in self.SERIES]
+        self._data = [(np.empty(0), np.empty(0)) for _ in self.SERIES]
+        self._rows: list[list[float]] = []
+        self._last_stage: object = None
+        plt.show(block=False)
+
+    def append(self, record: dict[str, object]) -> None:
+        self._rows.append([to_float(record.get("time"))] + [to_float(record.get(key)) for _, key, _ in self.SERIES])
+        stage = record.get("fc_stage")
+        if stage not in ("", None, "unknown") and stage != self._last_stage:
+            self._last_stage = stage
+            for axis in self.axes:
+                axis.axvline(to_float(record.get("time")), color="tab:gray", linestyle="--", linewidth=1.0, alpha=0.45)
+        if len(self._rows) >= self.refresh_rows:
+            self._add_rows()
+            if time.monotonic() - self._last_draw >= self.draw_interval_s:
+                self.refresh()
+
+    def refresh(self) -> None:
+        """Adds any buffered records and redraws."""
+        self._add_rows()
+        for line, (x, y) in zip(self.lines, self._data):
+            line.set_data(x, y)
+        for axis in self.axes:
+            axis.relim()
+            axis.autoscale_view()
+            _show_legend_if_needed(axis)
+        self.fig.canvas.draw_idle()
+        self.fig.canvas.flush_events()
+        self._last_draw = time.monotonic()
+
+    def _add_rows(self) -> None:
+        if not self._rows:
+            return
+        block = np.array(self._rows, dtype=np.float64)
+        self._rows = []
+        points = max(2, int(round(len(block) * self.ratio)))
+        for index, line in enumerate(self.lines):
+            x, y = decimate_series(block[:, 0], block[:, index + 1], points)
+            old_x, old_y = self._data[index]
+            self._data[index] = (np.concatenate((old_x, x)), np.concatenate((old_y, y)))
+        if max(len(x) for x, _ in self._data) > self.max_points:
+            self._data = [decimate_series(x, y, self.max_points // 2) for x, y in self._data]
+            self.ratio /= 2
+
+    def points(self) -> int:
+        """Points currently drawn across all lines."""
+        return sum(len(x) for x, _ in self._data)
+
+    def close(self) -> None:
+        plt.close(self.fig)
+
+
+def _column(history, key: str) -> np.ndarray:
+    # NaN entries leave gaps in the plotted line.
+    return np.asarray(history.get(key, ()), dtype=np.float64)
+
+
+def _has_numbers(history, key: str) -> bool:
+    return bool(np.isfinite(_column(history, key)).any())
+
+
+def _stage_change_indices(history) -> np.ndarray:
+    """Indices of the samples where a known FC stage first appears or changes."""
+    stages = np.asarray(history.get("fc_stage", ()), dtype=object)[: len(_column(history, "time"))]
+    known = np.flatnonzero([stage not in ("", None, "unknown") for stage in stages])
+    if not len(known):
+        return known
+    known_stages = stages[known]
+    return known[np.concatenate(([True], known_stages[1:] != known_stages[:-1]))]
+
+
+def _stage_changes(history) -> list[tuple[float, object]]:
+    indices = _stage_change_indices(history)
+    stages = np.asarray(history.get("fc_stage", ()), dtype=object)
+    return list(zip(_column(history, "time")[indices].tolist(), stages[indices].tolist()))
+
+
+def plot_points(fig) -> int:
+    """Points per line that the figure can show: POINTS_PER_PIXEL per pixel of width."""
+    return max(3, int(fig.get_figwidth() * fig.dpi * POINTS_PER_PIXEL))
+
+
+def lttb_indices(x, y, threshold: int) -> np.ndarray:
+    """Largest-Triangle-Three-Buckets: indices of `threshold` points that keep the shape of y(x).
+
+    The first and last points are always kept. Between them the points are split
+    into threshold - 2 equal buckets, and from each the point forming the largest
+    triangle with the previously kept point and the next bucket's mean is kept.
+    `x` and `y` must be finite.
+    """
+    x = np.asarray(x, dtype=np.float64)
+    y = np.asarray(y, dtype=np.float64)
+    count = len(x)
+    if threshold >= count or threshold < 3:
+        return np.arange(count)
+
+    edges = np.linspace(1, count - 1, threshold - 1).astype(np.int64)
+    # Mean of every bucket, plus the last point standing in for the bucket after the last.
+    sizes = np.diff(edges)
+    mean_x = np.append(np.add.reduceat(x[: count - 1], edges[:-1]) / sizes, x[-1])
+    mean_y = np.append(np.add.reduceat(y[: count - 1], edges[:-1]) / sizes, y[-1])
+
+    selected = np.empty(threshold, dtype=np.int64)
+    selected[0] = 0
+    selected[-1] = count - 1
+    previous = 0
+    for bucket in range(threshold - 2):
+        start, stop = edges[bucket], edges[bucket + 1]
+        ax, ay = x[previous], y[previous]
+        area = np.abs((ax - mean_x[bucket + 1]) * (y[start:stop] - ay) - (ax - x[start:stop]) * (mean_y[bucket + 1] - ay))
+        previous = start + int(np.argmax(area))
+        selected[bucket + 1] = previous
+    return selected
+
+
+def decimate_series(x, y, threshold: int, *, keep=()) -> tuple[np.ndarray, np.ndarray]:
+    """`threshold` LTTB points of y(x) plus the indices in `keep`.
+
+    LTTB runs over the finite samples only; a NaN is put back wherever kept points
+    straddle missing samples, so gaps still show as gaps.
+    """
+    x = np.asarray(x, dtype=np.float64)
+    y = np.asarray(y, dtype=np.float64)
+    count = min(len(x), len(y))
+    x, y = x[:count], y[:count]
+    finite = np.flatnonzero(np.isfinite(x) & np.isfinite(y))
+    if len(finite) == count and threshold >= count:
+        return x, y
+
+    chosen = finite[lttb_indices(x[finite], y[finite], threshold)]
+    keep = np.asarray(keep, dtype=np.int64)
+    keep = keep[(keep < count)]
+    if len(keep):
+        chosen = np.union1d(chosen, keep[np.isfinite(y[keep]) & np.isfinite(x[keep])])
+    # A kept pair with a missing sample between them gets a NaN break.
+    positions = np.searchsorted(finite, chosen)
+    breaks = np.flatnonzero(np.diff(chosen) != np.diff(positions)) + 1
+    return np.insert(x[chosen], breaks, np.nan), np.insert(y[chosen], breaks, np.nan)
 
 
 def _show_legend_if_needed(axis) -> None:
@@ -0,0 +1,470 @@
+from __future__ import annotations
+
+import heapq
+import math
+import random
+import selectors
+import socket
+import threading
+import time
+from collections import deque
+from dataclasses import dataclass, field
+from typing import Optional
+
+BITS_PER_BYTE = 10  # 8N1 framing, same as the native UART model
+DEFAULT_MAX_PACKET = 255
+DEFAULT_IDLE_FLUSH_S = 0.02
+# Latency histogram buckets are this ratio wide, so percentiles are within 5%.
+LATENCY_BUCKET_RATIO = 1.05
+_LATENCY_FLOOR_S = 1e-6
+
+
+@dataclass
+class LinkImpairments:
+    """Channel model applied independently to each direction of the link.
+
+    A packet is one line (up to and including ``\\n``) or ``max_packet`` bytes,
+    whichever comes first; bytes without a newline go out as a short packet once
+    the sender has been quiet for ``idle_flush_s``. Loss follows a Gilbert-Elliott model: in the good
+    state packets drop with probability ``loss``, in the bad (burst) state with
+    ``burst_loss``; the channel enters a burst with probability ``burst_enter``
+    and leaves it with ``burst_exit`` per packet.
+    """
+
+    bandwidth_bps: Optional[float] = None  # None: unlimited
+    latency_s: float = 0.0
+    jitter_s: float = 0.0
+    loss: float = 0.0
+    burst_enter: float = 0.0
+    burst_exit: float = 1.0
+    burst_loss: float = 1.0
+    max_packet: int = DEFAULT_MAX_PACKET
+    idle_flush_s: float = DEFAULT_IDLE_FLUSH_S
+
+    def __post_init__(self) -> None:
+        if self.max_packet < 1:
+            raise ValueError(f"max_packet must be at least 1, got {self.max_packet}")
+
+
+class GilbertElliott:
+    """Two-state burst loss channel; deterministic for a given rng."""
+
+    def __init__(self, impairments: LinkImpairments, rng: random.Random):
+        self.impairments = impairments
+        self.rng = rng
+        self.in_burst = False
+
+    def drop(self) -> bool:
+        imp = self.impairments
+        if self.in_burst:
+            if self.rng.random() < imp.burst_exit:
+                self.in_burst = False
+        elif imp.burst_enter > 0 and self.rng.random() < imp.burst_enter:
+            self.in_burst = True
+        probability = imp.burst_loss if self.in_burst else imp.loss
+        return probability > 0 and self.rng.random() < probability
+
+
+class LatencyHistogram:
+    """Latency count, sum and max plus log-spaced buckets for percentiles.
+
+    Memory stays bounded however long the link runs, and a latency can be
+    taken back out when its packet turns out not to be delivered.
+    """
+
+    def __init__(self) -> None:
+        self.count = 0
+        self.total_s = 0.0
+        self.max_s = 0.0
+        self._buckets: dict[int, list] = {}  # bucket -> [count, largest latency added]
+
+    def add(self, latency_s: float) -> None:
+        self.count += 1
+        self.total_s += latency_s
+        self.max_s = max(self.max_s, latency_s)
+        bucket = self._buckets.setdefault(_latency_bucket(latency_s), [0, 0.0])
+        bucket[0] += 1
+        bucket[1] = max(bucket[1], latency_s)
+
+    def remove(self, latency_s: float) -> None:
+        index = _latency_bucket(latency_s)
+        bucket = self._buckets.get(index)
+        if bucket is None:
+            return
+        bucket[0] -= 1
+        if bucket[0] == 0:
+            del self._buckets[index]
+        self.count -= 1
+        self.total_s = max(self.total_s - latency_s, 0.0) if self.count else 0.0
+        if latency_s >= self.max_s:
+            # Exact unless the removed latency shared its bucket; then within one bucket.
+            top = max(self._buckets, default=None)
+            self.max_s = self._buckets[top][1] if top is not None else 0.0
+
+    def mean(self) -> float:
+        return self.total_s / self.count if self.count else 0.0
+
+    def percentile(self, fraction: float) -> float:
+        """Largest latency in the bucket holding the value at ``fraction``."""
+        if not self.count:
+            return 0.0
+        index = min(int(fraction * self.count), self.count - 1)
+        seen = 0
+        for bucket in sorted(self._buckets):
+            count, largest = self._buckets[bucket]
+            seen += count
+            if seen > index:
+                return largest
+        return self.max_s
+
+
+@dataclass
+class DirectionStats:
+    packets_in: int = 0
+    packets_delivered: int = 0
+    packets_lost: int = 0
+    packets_burst_lost: int = 0
+    packets_unrouted: int = 0  # delivered while the far side was disconnected
+    bytes_in: int = 0
+    bytes_delivered: int = 0
+    latencies: LatencyHistogram = field(default_factory=LatencyHistogram)
+    first_in: Optional[float] = None
+    last_delivered: Optional[float] = None
+
+    def summary(self) -> dict[str, float]:
+        elapsed = 0.0
+        if self.first_in is not None and self.last_delivered is not None:
+            elapsed = max(self.last_delivered - self.first_in, 0.0)
+        return {
+            "packets_in": self.packets_in,
+            "packets_delivered": self.packets_delivered,
+            "packets_lost": self.packets_lost,
+            "packets_burst_lost": self.packets_burst_lost,
+            "packets_unrouted": self.packets_unrouted,
+            "bytes_in": self.bytes_in,
+            "bytes_delivered": self.bytes_delivered,
+            "loss_ratio": self.packets_lost / self.packets_in if self.packets_in else 0.0,
+            "throughput_bps": self.bytes_delivered * 8 / elapsed if elapsed > 0 else 0.0,
+            "latency_mean_ms": 1000.0 * self.latencies.mean(),
+            "latency_p95_ms": 1000.0 * self.latencies.percentile(0.95),
+            "latency_max_ms": 1000.0 * self.latencies.max_s,
+        }
+
+
+class _Direction:
+    def __init__(self, name: str, impairments: LinkImpairments, rng: random.Random):
+        self.name = name
+        self.impairments = impairments
+        self.rng = rng
+        self.channel = GilbertElliott(impairments, rng)
+        self.stats = DirectionStats()
+        self.partial = b""
+        self.partial_since: Optional[float] = None
+        self.last_byte_at = 0.0
+        self.wire_free_at = 0.0
+        self.last_deliver_at = 0.0
+
+    def accept(self, data: bytes, now: float) -> list[tuple[float, float, bytes]]:
+        """Packetizes incoming bytes; returns (deliver_at, sent_at, payload) for survivors."""
+        if self.partial_since is None:
+            self.partial_since = now
+        self.last_byte_at = now
+        buffer = self.partial + data
+        max_packet = self.impairments.max_packet
+        start = 0
+        scheduled = []
+        while start < len(buffer):
+            cut = buffer.find(b"\n", start, start + max_packet)
+            if cut < 0:
+                if len(buffer) - start < max_packet:
+                    break
+                cut = start + max_packet - 1
+            sent_at = self.partial_since
+            self.partial_since = now if cut + 1 < len(buffer) else None
+            result = self._transmit(buffer[start : cut + 1], sent_at)
+            if result is not None:
+                scheduled.append(result)
+            start = cut + 1
+        self.partial = buffer[start:]
+        return scheduled
+
+    def flush_deadline(self) -> Optional[float]:
+        """When the buffered partial packet goes out if no more bytes arrive."""
+        return self.last_byte_at + self.impairments.idle_flush_s if self.partial else None
+
+    def flush_idle(self, now: float) -> list[tuple[float, float, bytes]]:
+        """Sends a partial packet (no newline yet) once the inter-byte timeout passed."""
+        deadline = self.flush_deadline()
+        if deadline is None or now < deadline:
+            return []
+        packet, sent_at = self.partial, self.partial_since
+        self.partial, self.partial_since = b"", None
+        result = self._transmit(packet, sent_at)
+        return [] if result is None else [result]
+
+    def _transmit(self, packet: bytes, sent_at: float) -> Optional[tuple[float, float, bytes]]:
+        imp = self.impairments
+        stats = self.stats
+        stats.packets_in += 1
+        stats.bytes_in += len(packet)
+        if stats.first_in is None:
+            stats.first_in = sent_at
+        # The packet occupies the air even if it is corrupted on the way.
+        start = max(sent_at, self.wire_free_at)
+        if imp.bandwidth_bps:
+            self.wire_free_at = start + len(packet) * BITS_PER_BYTE / imp.bandwidth_bps
+        else:
+            self.wire_free_at = start
+        if self.channel.drop():
+            stats.packets_lost += 1
+            if self.channel.in_burst:
+                stats.packets_burst_lost += 1
+            return None
+        delay = imp.latency_s
+        if imp.jitter_s > 0:
+            delay += self.rng.uniform(0.0, imp.jitter_s)
+        # Keep ordering: a radio does not reorder frames.
+        self.last_deliver_at = max(self.wire_free_at + delay, self.last_deliver_at)
+        return self.last_deliver_at, sent_at, packet
+
+
+class RadioLinkBroker:
+    """Cross-connects two native processes' SITL serial ports through a lossy radio model.
+
+    Each side connects with ``SerialN.connectSITL(host, port)``; bytes one side
+    writes are packetized, impaired and delivered to the other side.
+    """
+
+    def __init__(
+        self,
+        host: str = "127.0.0.1",
+        a_port: int = 5601,
+        b_port: int = 5602,
+        *,
+        a_to_b: Optional[LinkImpairments] = None,
+        b_to_a: Optional[LinkImpairments] = None,
+        seed: Optional[int] = None,
+    ):
+        rng = random.Random(seed)
+        self._directions = {
+            "a": _Direction("a->b", a_to_b or LinkImpairments(), random.Random(rng.random())),
+            "b": _Direction("b->a", b_to_a or LinkImpairments(), random.Random(rng.random())),
+        }
+        self._selector = selectors.DefaultSelector()
+        self._listeners = {
+            "a": self._listen(host, a_port, "a"),
+            "b": self._listen(host, b_port, "b"),
+        }
+        self._conns: dict[str, Optional[socket.socket]] = {"a": None, "b": None}
+        # Delivered packets not yet written to each side: (unsent bytes, source side, latency).
+        self._outbox: dict[str, deque[tuple[memoryview, str, float]]] = {"a": deque(), "b": deque()}
+        self._pending: list[tuple[float, int, str, float, bytes]] = []
+        self._sequence = 0
+        self._stop = threading.Event()
+        self._thread: Optional[threading.Thread] = None
+
+    @property
+    def ports(self) -> tuple[int, int]:
+        return self._listeners["a"].getsockname()[1], self._listeners["b"].getsockname()[1]
+
+    def connected(self, side: str) -> bool:
+        return self._conns[side] is not None
+
+    def stats(self) -> dict[str, dict[str, float]]:
+        return {d.name: d.stats.summary() for d in self._directions.values()}
+
+    def start(self) -> "RadioLinkBroker":
+        self._thread = threading.Thread(target=self.serve, daemon=True)
+        self._thread.start()
+        return self
+
+    def stop(self) -> None:
+        self._stop.set()
+        if self._thread is not None:
+            self._thread.join(timeout=2.0)
+            self._thread = None
+        for conn in self._conns.values():
+            if conn is not None:
+                conn.close()
+        for listener in self._listeners.values():
+            listener.close()
+        self._selector.close()
+
+    def serve(self, duration_s: Optional[float] = None) -> None:
+        deadline = None if duration_s is None else time.monotonic() + duration_s
+        while not self._stop.is_set():
+            now = time.monotonic()
+            if deadline is not None and now >= deadline:
+                break
+            timeout = 0.05
+            if self._pending:
+                timeout = min(timeout, max(self._pending[0][0] - now, 0.0))
+            for direction in self._directions.values():
+                flush_at = direction.flush_deadline()
+                if flush_at is not None:
+                    timeout = min(timeout, max(flush_at - now, 0.0))
+            for key, events in self._selector.select(timeout):
+                kind, side = key.data
+                if kind == "listen":
+                    self._accept(side)
+                    continue
+                if events & selectors.EVENT_READ:
+                    self._receive(side)
+                if events & selectors.EVENT_WRITE:
+                    self._send_queued(side)
+            now = time.monotonic()
+            for side, direction in self._directions.items():
+                self._schedule(side, direction.flush_idle(now))
+            self._deliver_due(now)
+
+    def _listen(self, host: str, port: int, side: str) -> socket.socket:
+        listener = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        listener.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        listener.bind((host, port))
+        listener.listen(1)
+        listener.setblocking(False)
+        self._selector.register(listener, selectors.EVENT_READ, ("listen", side))
+        return listener
+
+    def _accept(self, side: str) -> None:
+        conn, addr = self._listeners[side].accept()
+        if self._conns[side] is not None:
+            self._drop_connection(side)
+        conn.setblocking(False)
+        conn.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        self._conns[side] = conn
+        self._selector.register(conn, selectors.EVENT_READ, ("conn", side))
+        print(f"[Link] Side {side.upper()} connected from {addr}")
+
+    def _drop_connection(self, side: str) -> None:
+        conn = self._conns[side]
+        if conn is None:
+            return
+        self._selector.unregister(conn)
+        conn.close()
+        self._conns[side] = None
+        for data, source, latency in self._outbox[side]:
+            # Counted as delivered when queued; it never fully reached the far side.
+            stats = self._directions[source].stats
+            stats.packets_delivered -= 1
+            stats.bytes_delivered -= len(data.obj)
+            stats.latencies.remove(latency)
+            stats.packets_unrouted += 1
+        self._outbox[side].clear()
+        print(f"[Link] Side {side.upper()} disconnected")
+
+    def _receive(self, side: str) -> None:
+        conn = self._conns[side]
+        if conn is None:
+            return
+        try:
+            data = conn.recv(65536)
+        except BlockingIOError:
+            return
+        except OSError:
+            data = b""
+        if not data:
+            self._drop_connection(side)
+            return
+        self._schedule(side, self._directions[side].accept(data, time.monotonic()))
+
+    def _schedule(self, side: str, packets: list[tuple[float, float, bytes]]) -> None:
+        for deliver_at, sent_at, packet in packets:
+            self._sequence += 1
+            heapq.heappush(self._pending, (deliver_at, self._sequence, side, sent_at, packet))
+
+    def _deliver_due(self, now: float) -> None:
+        targets = set()
+        while self._pending and self._pending[0][0] <= now:
+            deliver_at, _, side, sent_at, packet = heapq.heappop(self._pending)
+            stats = self._directions[side].stats
+            target = "b" if side == "a" else "a"
+            if self._conns[target] is None:
+                stats.packets_unrouted += 1
+                continue
+            # Counted before the send so readers of the far side never see stale stats.
+            latency = now - sent_at
+            stats.packets_delivered += 1
+            stats.bytes_delivered += len(packet)
+            stats.latencies.add(latency)
+            stats.last_delivered = now
+            self._outbox[target].append((memoryview(packet), side, latency))
+            targets.add(target)
+        for target in targets:
+            self._send_queued(target)
+
+    def _send_queued(self, side: str) -> None:
+        """Writes queued packets until the socket would block; never blocks the selector thread."""
+        conn = self._conns[side]
+        outbox = self._outbox[side]
+        if conn is None:
+            return
+        while outbox:
+            data, source, latency = outbox[0]
+            try:
+                sent = conn.send(data)
+            except BlockingIOError:
+                break
+            except OSError:
+                self._drop_connection(side)
+                return
+            if sent < len(data):
+                outbox[0] = (data[sent:], source, latency)
+                break
+            outbox.popleft()
+        events = selectors.EVENT_READ | (selectors.EVENT_WRITE if outbox else 0)
+        if self._selector.get_key(conn).events != events:
+            self._selector.modify(conn, events, ("conn", side))
+
+
+def format_link_report(stats: dict[str, dict[str, float]]) -> str:
+    lines = []
+    for name, summary in stats.items():
+        lines.append(
+            f"{name}: {summary['packets_delivered']}/{summary['packets_in']} packets "
+            f"({summary['loss_ratio'] * 100:.1f}% lost, {summary['packets_burst_lost']} in bursts), "
+            f"{summary['throughput_bps'] / 1000:.1f} kbit/s, latency mean {summary['latency_mean_ms']:.1f} ms "
+            f"p95 {summary['latency_p95_ms']:.1f} ms max {summary['latency_max_ms']:.1f} ms"
+        )
+    return "\n".join(lines)
+
+
+def run_link_broker(args) -> int:
+    impairments = LinkImpairments(
+        bandwidth_bps=args.bandwidth if args.bandwidth and args.bandwidth > 0 else None,
+        latency_s=args.latency_ms / 1000.0,
+        jitter_s=args.jitter_ms / 1000.0,
+        loss=args.loss,
+        burst_enter=args.burst_enter,
+        burst_exit=args.burst_exit,
+        burst_loss=args.burst_loss,
+        max_packet=args.max_packet,
+        idle_flush_s=args.idle_flush_ms / 1000.0,
+    )
+    try:
+        broker = RadioLinkBroker(
+            args.host,
+            args.a_port,
+            args.b_port,
+            a_to_b=impairments,
+            b_to_a=impairments,
+            seed=args.seed,
+        )
+    except OSError as exc:
+        print(f"[Link] Could not listen on {args.host}: {exc}")
+        return 1
+    a_port, b_port = broker.ports
+    print(f"[Link] Radio link broker on {args.host}: side A port {a_port}, side B port {b_port}")
+    try:
+        broker.serve(duration_s=args.duration)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        report = format_link_report(broker.stats())
+        broker.stop()
+    print(report)
+    return 0
+
+
+def _latency_bucket(latency_s: float) -> int:
+    return math.floor(math.log(max(latency_s, _LATENCY_FLOOR_S) / _LATENCY_FLOOR_S, LATENCY_BUCKET_RATIO))
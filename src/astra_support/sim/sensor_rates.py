@@ -0,0 +1,83 @@
+from __future__ import annotations
+
+SENSOR_KINDS = ("imu", "baro", "gps")
+DEFAULT_SENSOR_RATES_HZ = {"imu": 1000.0, "baro": 50.0, "gps": 10.0}
+
+# Normalized dataset keys (dataset_cache.COLUMNS) each sensor line carries.
+SENSOR_KEYS = {
+    "imu": {"acc_x", "acc_y", "acc_z", "gyro_x", "gyro_y", "gyro_z", "mag_x", "mag_y", "mag_z"},
+    "baro": {"pres", "temp"},
+    "gps": {"lat", "lon", "gps_alt", "fix", "sats", "heading"},
+}
+
+# Scheduling slack so a sample landing a hair before its due time (float
+# timestamps from CSVs) is not pushed back a whole source step.
+_DUE_EPSILON_S = 1e-6
+
+
+def parse_sensor_rates(text: str | None) -> dict[str, float] | None:
+    """Parses ``--sensor-rates``: ``default`` or ``imu=1000,baro=50,gps=10``.
+
+    Kinds left out keep their default rate; a rate of 0 stops sending that
+    sensor. Returns None when multi-rate packets are off.
+    """
+    if text is None:
+        return None
+    rates = dict(DEFAULT_SENSOR_RATES_HZ)
+    text = text.strip().lower()
+    if text in ("", "default"):
+        return rates
+    for item in text.split(","):
+        kind, sep, value = item.partition("=")
+        kind = kind.strip()
+        if not sep or kind not in rates:
+            raise ValueError(f"Bad sensor rate '{item}'; expected one of {', '.join(SENSOR_KINDS)} as kind=hz.")
+        rate = float(value)
+        if rate < 0:
+            raise ValueError(f"Sensor rate for {kind} must not be negative.")
+        rates[kind] = rate
+    return rates
+
+
+class SensorScheduler:
+    """Decides which per-sensor HITL lines go out at each source timestamp.
+
+    A sensor is sent when its next due time has been reached, then becomes due
+    one period later. A source slower than a sensor's rate sends that sensor on
+    every packet; due times that fall between packets are not made up later.
+    """
+
+    def __init__(self, rates_hz: dict[str, float]):
+        self.periods = {kind: 1.0 / rate for kind, rate in rates_hz.items() if rate > 0}
+        self._next_due: dict[str, float] = {}
+        self.sent = {kind: 0 for kind in self.periods}
+
+    def due(self, timestamp: float, skip: frozenset[str] = frozenset()) -> list[str]:
+        kinds = []
+        for kind, period in self.periods.items():
+            if kind in skip:
+                continue
+            next_due = self._next_due.get(kind)
+            if next_due is not None and timestamp + _DUE_EPSILON_S < next_due:
+                continue
+            next_due = timestamp + period if next_due is None else next_due + period
+            if next_due <= timestamp + _DUE_EPSILON_S:
+                next_due = timestamp + period
+            self._next_due[kind] = next_due
+            self.sent[kind] += 1
+            kinds.append(kind)
+        return kinds
+
+    def lines(self, packet, fresh: frozenset[str] | None = None, sampled: frozenset[str] = frozenset()) -> list[str]:
+        """The HITL lines for `packet` that are due, in SENSOR_KINDS order.
+
+        `fresh` and `sampled` come from sources that know which keys were really
+        measured at this timestamp (MergedCSVSim). A sensor the source samples is
+        only sent when at least one of its keys is fresh; values held between its
+        samples are not resent.
+        """
+        skip = frozenset()
+        if fresh is not None:
+            skip = frozenset(kind for kind, keys in SENSOR_KEYS.items() if keys & sampled and not keys & fresh)
+        due = set(self.due(packet.timestamp, skip))
+        return [packet.to_sensor_string(kind) for kind in SENSOR_KINDS if kind in due]
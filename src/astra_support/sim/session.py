@@ -3,16 +3,19 @@ from __future__ import annotations
 import math
 import subprocess
 import time
+from collections import deque
 from pathlib import Path
 
 from ..console import Ansi, configure_console_output, paint
 from ..prereqs import check_toolchain
 from . import data_sources
-from .logging import write_sim_log
-from .plotting import plot_history
+from .history import HistoryStore
+from .logging import LOG_SUFFIXES, SimLogWriter
+from .plotting import LivePlot, plot_history
+from .sensor_rates import SensorScheduler, parse_sensor_rates
 from .sitl_process import SitlProcess, default_sitl_executable
 from .sources import invoke_hook, load_custom_sim_hooks, resolve_csv_source, source_kind
-from .telemetry import extract_fc_fields, parse_telem_header
+from .telemetry import extract_fc_fields, frame_sequenced, parse_telem_header, split_sequence
 from .transport import SerialLink, TCPLink
 
 
@@ -30,6 +33,10 @@ def run_simulation(args, project_root: Path) -> int:
     fc_header_names: list[str] = []
     fc_col_map = None
     history = _new_history()
+    log_format = getattr(args, "log_format", None) or "csv"
+    log_path = Path(f"sim_log_{time.strftime('%Y%m%d_%H%M%S')}{LOG_SUFFIXES[log_format]}")
+    log_writer = None
+    live_plot = None
     sim_pressure_alt_baseline_m = math.nan
     run_failed = False
 
@@ -49,54 +56,100 @@ def run_simulation(args, project_root: Path) -> int:
         fc_col_map, fc_header_names = _handshake(link, args, sitl=sitl)
         if args.target_apogee is not None:
             _send_preflight_airbrake_target(link, args.target_apogee)
-
+        log_writer = SimLogWriter(log_path, fc_header_names, fmt=log_format)
+        if getattr(args, "live_plot", False) and not getattr(args, "no_plot", False):
+            live_plot = LivePlot(source_name=args.source)
+
+        window = max(1, int(getattr(args, "window", 1) or 1))
+        if window > 1 and args.mode != "sitl":
+            # Envelopes are stripped by the native Stream; target firmware does not know them.
+            print(paint("--window only applies to SITL; using lockstep.", Ansi.YELLOW))
+            window = 1
+        sequenced = window > 1
+        sensor_rates = parse_sensor_rates(getattr(args, "sensor_rates", None))
+        scheduler = SensorScheduler(sensor_rates) if sensor_rates is not None else None
+        if scheduler is not None:
+            rates_text = ", ".join(f"{kind} {1.0 / period:g} Hz" for kind, period in scheduler.periods.items())
+            print(paint(f"Multi-rate sensor packets: {rates_text}", Ansi.BLUE))
+        # The FC answers each HITL line with one TELEM line, so every line is its
+        # own step; only the answer to a timestamp's last line is recorded.
+        in_flight: deque[tuple[int, object]] = deque()
+        unsent: deque[tuple[str, object]] = deque()
+        next_seq = 0
         last_stage = "unknown"
         start_wall = time.time()
         first_timestamp = None
-        while not sim.is_finished():
+        while not sim.is_finished() or in_flight or unsent:
             if sitl is not None:
                 sitl.ensure_running("SITL")
-            packet = sim.get_next_packet()
-            if first_timestamp is None:
-                first_timestamp = packet.timestamp
-            _pace_packet(args, packet.timestamp, first_timestamp, start_wall)
-            link.send(packet.to_hitl_string().encode("utf-8"))
-            response = _read_telem_response(link, fc_header_names)
-            current_values = response[6:].split(",") if response and response.startswith("TELEM/") else []
-            if _is_header_row(current_values, fc_header_names):
-                continue
-            fields = extract_fc_fields(current_values, fc_col_map)
-            if fields.get("Time - Seconds") == "Time - Seconds":
-                continue
-            if fields.get("State - Flight Stage") == "State - Flight Stage":
+            while len(in_flight) < window and (unsent or not sim.is_finished()):
+                if not unsent:
+                    packet = sim.get_next_packet()
+                    if first_timestamp is None:
+                        first_timestamp = packet.timestamp
+                    lines = (
+                        scheduler.lines(packet, *_sample_freshness(sim))
+                        if scheduler is not None
+                        else [packet.to_hitl_string()]
+                    )
+                    if not lines:
+                        continue  # no sensor due at this timestamp
+                    _pace_packet(args, packet.timestamp, first_timestamp, start_wall)
+                    unsent.extend((line, None) for line in lines[:-1])
+                    unsent.append((lines[-1], packet))
+                line, packet = unsent.popleft()
+                next_seq += 1
+                if sequenced:
+                    line = frame_sequenced(line, next_seq)
+                link.send(line.encode("utf-8"))
+                in_flight.append((next_seq, packet))
+
+            if not in_flight:
                 continue
-
-            if hasattr(custom_sim, "on_fc_telemetry"):
-                custom_sim.on_fc_telemetry(fields)
-
-            record = _record_packet(packet, fields, current_values)
-            sim_pressure_alt_baseline_m = _apply_pressure_altitude_baseline(record, sim_pressure_alt_baseline_m)
-            for key, value in record.items():
-                history[key].append(value)
-
-            stage_value = record["fc_stage"]
-            if stage_value != last_stage:
-                print(
-                    f"{paint(f'{packet.timestamp:8.2f}s', Ansi.YELLOW)} "
-                    f"stage -> {paint(str(stage_value), Ansi.CYAN)}"
-                )
-                last_stage = stage_value
-            elif len(history["time"]) % 50 == 0:
-                sim_alt_text = f"{record['sim_alt']:8.1f}"
-                sensor_alt_text = _format_optional(record["sensor_alt_agl_m"])
-                fc_alt_text = _format_optional(record["fc_alt"])
-                print(
-                    f"{paint(f'{packet.timestamp:8.2f}s', Ansi.DIM)} "
-                    f"real_alt={paint(sim_alt_text, Ansi.CYAN)} "
-                    f"sensor_alt={paint(sensor_alt_text, Ansi.BLUE)} "
-                    f"fc_alt={paint(fc_alt_text, Ansi.YELLOW)} "
-                    f"stage={paint(str(stage_value), Ansi.GRAY)}"
-                )
+            response_seq, response = _read_telem_response(link, fc_header_names, sequenced=sequenced)
+            for packet, matched in _match_responses(in_flight, response_seq, response, sequenced=sequenced):
+                if packet is None:
+                    continue  # answer to an earlier line of a multi-line step
+                current_values = matched[6:].split(",") if matched and matched.startswith("TELEM/") else []
+                if _is_header_row(current_values, fc_header_names):
+                    continue
+                fields = extract_fc_fields(current_values, fc_col_map)
+                if fields.get("Time - Seconds") == "Time - Seconds":
+                    continue
+                if fields.get("State - Flight Stage") == "State - Flight Stage":
+                    continue
+
+                if matched and hasattr(custom_sim, "on_fc_telemetry"):
+                    custom_sim.on_fc_telemetry(fields)
+
+                record = _record_packet(packet, fields, current_values)
+                if not matched:
+                    # Skipped or timed out: the FC said nothing about its stage, so it has not changed.
+                    record["fc_stage"] = last_stage
+                sim_pressure_alt_baseline_m = _apply_pressure_altitude_baseline(record, sim_pressure_alt_baseline_m)
+                log_writer.append(record)
+                stage_value = record["fc_stage"]
+                history.append(record, keep=stage_value != last_stage)
+                if live_plot is not None:
+                    live_plot.append(record)
+
+                if stage_value != last_stage:
+                    print(
+                        f"{paint(f'{packet.timestamp:8.2f}s', Ansi.YELLOW)} "
+                        f"stage -> {paint(str(stage_value), Ansi.CYAN)}"
+                    )
+                    last_stage = stage_value
+                elif history.count % 50 == 0:
+                    sim_alt_text = f"{record['sim_alt']:8.1f}"
+                    sensor_alt_text = _format_optional(record["sensor_alt_agl_m"])
+                    fc_alt_text = _format_optional(record["fc_alt"])
+                    print(
+                        f"{paint(f'{packet.timestamp:8.2f}s', Ansi.DIM)} "
+                        f"real_alt={paint(sim_alt_text, Ansi.CYAN)} "
+                        f"sensor_alt={paint(sensor_alt_text, Ansi.BLUE)} "
+                        f"fc_alt={paint(fc_alt_text, Ansi.YELLOW)} "
+                        f"stage={paint(str(stage_value), Ansi.GRAY)}"
+                    )
     except Exception as exc:
         print(paint(f"Simulation failed: {exc}", Ansi.RED))
         run_failed = True
@@ -108,9 +161,12 @@ def run_simulation(args, project_root: Path) -> int:
             link.close()
         if sitl is not None:
             sitl.stop()
+        if log_writer is None:
+            log_writer = SimLogWriter(log_path, fc_header_names, fmt=log_format)
+        log_writer.close()
+        if live_plot is not None:
+            live_plot.close()
 
-    log_path = Path(f"sim_log_{time.strftime('%Y%m%d_%H%M%S')}.csv")
-    write_sim_log(log_path, history, fc_header_names)
     print(paint(f"Saved log to {log_path}", Ansi.GREEN))
     if not getattr(args, "no_plot", False):
         plot_history(history, source_name=args.source)
@@ -147,6 +203,11 @@ def _create_builtin_sim(args, project_root: Path):
         base = data_sources.NetworkStreamSim(args.udp_port)
     elif kind == "physics":
         base = data_sources.PhysicsSim()
+    elif kind == "merge":
+        extra_roots = getattr(args, "dataset_root", None)
+        base = data_sources.MergedCSVSim(
+            [str(resolve_csv_source(part, project_root, extra_roots=extra_roots)) for part in args.source.split("+")]
+        )
     else:
         csv_path = resolve_csv_source(args.source, project_root, extra_roots=getattr(args, "dataset_root", None))
         base = data_sources.CSVSim(str(csv_path))
@@ -215,9 +276,9 @@ def _handshake(link, args, *, sitl: SitlProcess | None):
             link.send(args.ready_probe.encode("utf-8"))
             next_ready_probe_at = now + 0.5
 
-        line = link.read_line()
+        next_probe_at = min(next_header_probe_at, next_ready_probe_at, deadline)
+        line = link.read_line(timeout=max(next_probe_at - time.monotonic(), 0.0))
         if not line:
-            time.sleep(0.01)
             continue
         if require_ready and ready_token in line:
             ready_seen = True
@@ -233,10 +294,18 @@ def _send_preflight_airbrake_target(link, target_apogee_m: float) -> None:
     link.send(f"AB/TARGET_APOGEE {target_apogee_m:.2f}\n".encode("utf-8"))
     deadline = time.monotonic() + 1.0
     while time.monotonic() < deadline:
-        line = link.read_line()
+        line = link.read_line(timeout=deadline - time.monotonic())
         if line and line.startswith("AB OK"):
             return
-        time.sleep(0.01)
+
+
+def _sample_freshness(sim) -> tuple[frozenset[str] | None, frozenset[str]]:
+    """(fresh, sampled) keys from the innermost source that tracks them, through wrappers."""
+    while sim is not None:
+        if hasattr(sim, "fresh") and hasattr(sim, "sampled"):
+            return sim.fresh, sim.sampled
+        sim = getattr(sim, "source", None)
+    return None, frozenset()
 
 
 def _pace_packet(args, timestamp: float, first_timestamp: float, start_wall: float) -> None:
@@ -249,18 +318,47 @@ def _pace_packet(args, timestamp: float, first_timestamp: float, start_wall: flo
         time.sleep(remaining)
 
 
-def _read_telem_response(link, fc_header_names: list[str] | None = None) -> str:
-    deadline = time.time() + 1.0
-    while time.time() < deadline:
-        line = link.read_line()
+def _read_telem_response(
+    link, fc_header_names: list[str] | None = None, *, sequenced: bool = False
+) -> tuple[int | None, str]:
+    deadline = time.monotonic() + 1.0
+    while True:
+        remaining = deadline - time.monotonic()
+        if remaining <= 0:
+            return None, ""
+        line = link.read_line(timeout=remaining)
+        seq = None
+        if line and sequenced:
+            seq, line = split_sequence(line)
+            if seq is None:
+                continue  # emitted before the FC consumed a sequenced packet
         if line and line.startswith("TELEM/"):
             values = line[6:].split(",")
             if _is_header_row(values, fc_header_names):
-                time.sleep(0.01)
                 continue
-            return line
-        time.sleep(0.01)
-    return ""
+            return seq, line
+
+
+def _match_responses(in_flight: deque, response_seq: int | None, response: str, *, sequenced: bool):
+    """Pairs in-flight packets with an FC response.
+
+    Lockstep (window 1) pairs the oldest packet with whatever came back. With a
+    window, the FC echoes the sequence number of the last packet it consumed:
+    that packet gets the response and older ones it skipped over are recorded
+    with empty FC fields. A timeout retires the oldest packet.
+    """
+    if not in_flight:
+        return []
+    if not sequenced or response_seq is None:
+        _, packet = in_flight.popleft()
+        return [(packet, response if not sequenced else "")]
+    if response_seq < in_flight[0][0]:
+        return []  # stale echo for a packet already retired
+    matched = []
+    while in_flight and in_flight[0][0] <= response_seq:
+        seq, packet = in_flight.popleft()
+        matched.append((packet, response if seq == response_seq else ""))
+    return matched
 
 
 def _record_packet(packet, fields: dict[str, str], current_values: list[str]) -> dict[str, object]:
@@ -339,25 +437,9 @@ def _apply_pressure_altitude_baseline(record: dict[str, object], baseline_m: flo
     return baseline_m
 
 
-def _new_history() -> dict[str, list]:
-    return {
-        "time": [],
-        "sim_alt": [],
-        "sensor_alt_agl_m": [],
-        "sim_acc_mps2": [],
-        "sensor_acc_z_mps2": [],
-        "sensor_alt": [],
-        "fc_alt": [],
-        "fc_stage": [],
-        "fc_vel_z_mps": [],
-        "fc_acc_z_mps2": [],
-        "fc_flap_cmd_deg": [],
-        "fc_flap_actual_deg": [],
-        "fc_est_apogee_m": [],
-        "fc_target_apogee_m": [],
-        "fc_mach": [],
-        "fc_values": [],
-    }
+def _new_history() -> HistoryStore:
+    # Per-packet FC values only go to the log; the store keeps what is displayed and plotted.
+    return HistoryStore()
 
 
 def _is_header_row(values: list[str], fc_header_names: list[str] | None) -> bool:
@@ -15,6 +15,8 @@ def source_kind(source_text: str) -> str:
         return "physics"
     if token in {"net", "network", "udp"}:
         return "net"
+    if "+" in token:
+        return "merge"
     return "csv"
 
 
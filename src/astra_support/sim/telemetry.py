@@ -16,3 +16,18 @@ def extract_fc_fields(current_values: list[str], fc_col_map: dict[str, int] | No
         for key, index in fc_col_map.items()
         if index < len(current_values)
     }
+
+
+def frame_sequenced(line: str, seq: int) -> str:
+    """Wraps one outbound line in the windowed-protocol envelope ``@<seq>|<line>``."""
+    return f"@{seq}|{line}"
+
+
+def split_sequence(line: str) -> tuple[int | None, str]:
+    """Splits an ``@<seq>|`` envelope off an FC line; returns ``(None, line)`` when absent."""
+    if not line.startswith("@"):
+        return None, line
+    bar = line.find("|", 1)
+    if bar < 2 or not line[1:bar].isdigit():
+        return None, line
+    return int(line[1:bar]), line[bar + 1 :]
@@ -1,24 +1,59 @@
+import selectors
 import serial
 import socket
 import time
+from collections import deque
 from typing import Optional
 
 class FlightComputerLink:
-    """Base interface for connecting to the Flight Computer."""
+    """Base interface for connecting to the Flight Computer.
+
+    Received bytes are split into lines as they arrive; every complete line from
+    one wakeup is queued, so a burst of FC output costs one wait, not one per line.
+    """
+    def __init__(self):
+        self._buffer = b''
+        self._lines: deque = deque()
+
     def send(self, data: bytes):
         raise NotImplementedError
-    
-    def read_line(self) -> Optional[str]:
-        raise NotImplementedError
-        
+
+    def read_line(self, timeout: float = 0.0) -> Optional[str]:
+        """Next complete line, waiting up to `timeout` seconds (0: only what is already here)."""
+        if self._lines:
+            return self._lines.popleft()
+        deadline = time.monotonic() + max(timeout, 0.0)
+        while True:
+            chunk = self._recv(max(deadline - time.monotonic(), 0.0))
+            if chunk:
+                self._feed(chunk)
+                if self._lines:
+                    return self._lines.popleft()
+                continue
+            if time.monotonic() >= deadline:
+                return None
+
     def close(self):
         raise NotImplementedError
 
+    def _recv(self, timeout: float) -> bytes:
+        """Waits up to `timeout` for data and returns everything available (b'' on timeout)."""
+        raise NotImplementedError
+
+    def _feed(self, chunk: bytes) -> None:
+        self._buffer += chunk
+        if b'\n' not in chunk:
+            return
+        *complete, self._buffer = self._buffer.split(b'\n')
+        for line in complete:
+            self._lines.append(line.decode('utf-8', errors='ignore').strip())
+
 class SerialLink(FlightComputerLink):
     """HITL: Connect via USB Serial."""
     def __init__(self, port: str, baudrate: int = 115200):
+        super().__init__()
         try:
-            self.ser = serial.Serial(port, baudrate, timeout=0.01)
+            self.ser = serial.Serial(port, baudrate, timeout=0)
             print(f"[Link] Connected to Serial Port: {port}")
         except serial.SerialException as e:
             raise ConnectionError(f"Could not open serial port {port}: {e}")
@@ -29,16 +64,24 @@ class SerialLink(FlightComputerLink):
         except serial.SerialException:
             raise ConnectionError("Serial cable disconnected")
 
-    def read_line(self) -> Optional[str]:
-        if self.ser.in_waiting:
-            try:
-                line = self.ser.readline()
-                return line.decode('utf-8', errors='ignore').strip()
-            except serial.SerialException as e:
-                raise ConnectionError(f"Serial read error: {e}")
-            except Exception:
-                return None
-        return None
+    def _recv(self, timeout: float) -> bytes:
+        try:
+            waiting = self.ser.in_waiting
+            if waiting:
+                return self.ser.read(waiting)
+            if timeout <= 0:
+                return b''
+            # Block in the driver until the first byte (or the deadline), then
+            # take whatever else arrived with it.
+            self.ser.timeout = timeout
+            first = self.ser.read(1)
+            self.ser.timeout = 0
+            if not first:
+                return b''
+            waiting = self.ser.in_waiting
+            return first + (self.ser.read(waiting) if waiting else b'')
+        except serial.SerialException as e:
+            raise ConnectionError(f"Serial read error: {e}")
 
     def close(self):
         if hasattr(self, 'ser') and self.ser.is_open:
@@ -53,6 +96,7 @@ class TCPLink(FlightComputerLink):
         connect_timeout_s: Optional[float] = None,
         auto_accept: bool = True,
     ):
+        super().__init__()
         self.server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
         self.server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
         self.server.bind((host, port))
@@ -61,7 +105,7 @@ class TCPLink(FlightComputerLink):
 
         print(f"[Link] SITL Server listening on {host}:{port}...")
         self.conn = None
-        self._buffer = b''
+        self._selector = selectors.DefaultSelector()
         if auto_accept:
             self.wait_for_connection(connect_timeout_s=connect_timeout_s)
 
@@ -84,6 +128,8 @@ class TCPLink(FlightComputerLink):
                 try:
                     self.conn, addr = self.server.accept()
                     self.conn.setblocking(False)
+                    self.conn.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+                    self._selector.register(self.conn, selectors.EVENT_READ)
                     print(f"[Link] Flight Software connected from {addr}")
                 except socket.timeout:
                     if on_wait is not None:
@@ -101,29 +147,33 @@ class TCPLink(FlightComputerLink):
         except (BrokenPipeError, ConnectionResetError):
             raise ConnectionError("TCP Connection reset by peer")
 
-    def read_line(self) -> Optional[str]:
+    def _recv(self, timeout: float) -> bytes:
         if self.conn is None:
             raise ConnectionError("TCP Connection has not been established")
-        try:
-            chunk = self.conn.recv(4096)
-            if chunk == b'': 
+        if timeout > 0 and not self._selector.select(timeout):
+            return b''
+        chunks = []
+        while True:
+            try:
+                chunk = self.conn.recv(65536)
+            except BlockingIOError:
+                break  # drained
+            except ConnectionError:
+                raise
+            except Exception as e:
+                # Catch other socket weirdness
+                raise ConnectionError(f"Socket error: {e}")
+            if chunk == b'':
+                if chunks:
+                    break  # deliver what we have; the close is reported next call
                 # Empty bytes means the other side closed the connection cleanly
                 raise ConnectionError("TCP Connection closed by Flight Computer")
-            self._buffer += chunk
-        except BlockingIOError:
-            pass # No data waiting, that's fine
-        except ConnectionError:
-            raise # Re-raise known connection errors
-        except Exception as e:
-            # Catch other socket weirdness
-            raise ConnectionError(f"Socket error: {e}")
-
-        if b'\n' in self._buffer:
-            line, self._buffer = self._buffer.split(b'\n', 1)
-            return line.decode('utf-8', errors='ignore').strip()
-        return None
+            chunks.append(chunk)
+        return b''.join(chunks)
 
     def close(self):
         if getattr(self, 'conn', None) is not None:
             self.conn.close()
+        if getattr(self, '_selector', None) is not None:
+            self._selector.close()
         self.server.close()
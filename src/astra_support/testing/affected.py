@@ -0,0 +1,182 @@
+from __future__ import annotations
+
+import hashlib
+import json
+import os
+import re
+import subprocess
+import tempfile
+from dataclasses import dataclass, field
+from pathlib import Path
+
+from .analyze import STATUS_PASS
+
+DEPS_PATH = Path(".pio") / "astra-support" / "test-deps.json"
+DEPS_VERSION = 1
+# Added to PLATFORMIO_BUILD_FLAGS for test builds: every object gets a .d
+# file listing the sources and project headers it was compiled from.
+DEPFILE_FLAG = "-MMD"
+
+_DEPFILE_SPLIT_RE = re.compile(r"(?<!\\)\s+")
+
+
+@dataclass
+class FolderRecord:
+    """What a test folder's program was built from at its last run."""
+
+    status: str
+    files: dict[str, tuple[int, int]] = field(default_factory=dict)  # path -> (mtime_ns, size)
+
+
+class DependencyGraph:
+    """Test folder -> files its program depends on, from compiler depfiles.
+
+    Saved under DEPS_PATH. A folder is affected when a file it depends on
+    changed since its last run (or since a git ref), when it did not pass last
+    time, when it has a file its record does not know, or when the build
+    context (platformio.ini, env, extra flags) changed.
+    """
+
+    def __init__(self, path: Path, context: str = "", folders: dict[str, FolderRecord] | None = None):
+        self.path = path
+        self.context = context
+        self.folders = dict(folders or {})
+
+    @classmethod
+    def load(cls, project_root: Path) -> DependencyGraph:
+        path = project_root / DEPS_PATH
+        try:
+            data = json.loads(path.read_text(encoding="utf-8"))
+        except (OSError, ValueError):
+            return cls(path)
+        if not isinstance(data, dict) or data.get("version") != DEPS_VERSION:
+            return cls(path)
+        folders = {
+            name: FolderRecord(record.get("status", ""), {file: tuple(stamp) for file, stamp in record.get("files", {}).items()})
+            for name, record in data.get("folders", {}).items()
+        }
+        return cls(path, data.get("context", ""), folders)
+
+    def save(self) -> None:
+        self.path.parent.mkdir(parents=True, exist_ok=True)
+        payload = {
+            "version": DEPS_VERSION,
+            "context": self.context,
+            "folders": {
+                name: {"status": record.status, "files": dict(sorted(record.files.items()))}
+                for name, record in sorted(self.folders.items())
+            },
+        }
+        handle, temp_name = tempfile.mkstemp(prefix=".test-deps-", dir=self.path.parent)
+        try:
+            with os.fdopen(handle, "w", encoding="utf-8") as stream:
+                json.dump(payload, stream, indent=1)
+            os.replace(temp_name, self.path)
+        except BaseException:
+            Path(temp_name).unlink(missing_ok=True)
+            raise
+
+    def update(self, folder: str, files: set[Path], status: str) -> None:
+        self.folders[folder] = FolderRecord(status, {str(path): stamp for path in files if (stamp := _stamp(path))})
+
+    def affected(
+        self, folders: list[str], test_dir: Path, context: str, changed: set[Path] | None = None
+    ) -> tuple[list[str], list[str]]:
+        """Splits folders into (affected, unaffected), keeping their order."""
+        if context != self.context:
+            return list(folders), []
+        changed_names = {str(path) for path in changed or ()}
+        selected: list[str] = []
+        skipped: list[str] = []
+        for folder in folders:
+            record = self.folders.get(folder)
+            if record is None or record.status != STATUS_PASS or self._folder_changed(record, test_dir / folder, changed_names):
+                selected.append(folder)
+            else:
+                skipped.append(folder)
+        return selected, skipped
+
+    @staticmethod
+    def _folder_changed(record: FolderRecord, folder_dir: Path, changed_names: set[str]) -> bool:
+        if any(name in record.files for name in changed_names):
+            return True
+        if any(name.startswith(f"{folder_dir.resolve()}{os.sep}") for name in changed_names):
+            return True
+        for path in folder_dir.rglob("*"):
+            if path.is_file() and str(path.resolve()) not in record.files and path.suffix in _SOURCE_SUFFIXES:
+                return True  # a source the last build did not see
+        return any(_stamp(Path(name)) != stamp for name, stamp in record.files.items())
+
+
+_SOURCE_SUFFIXES = {".c", ".cc", ".cpp", ".cxx", ".h", ".hh", ".hpp", ".hxx", ".inl", ".ipp", ".tpp"}
+
+
+def context_key(project_root: Path, env_name: str, build_flags: str = "", shared_build_key: str = "") -> str:
+    """Hash of the build settings every folder shares; a change affects them all.
+
+    `shared_build_key` stands for the shared library archive, whose sources and
+    headers leave no entries in the folders' depfiles.
+    """
+    digest = hashlib.sha256()
+    config = project_root / "platformio.ini"
+    digest.update(config.read_bytes() if config.exists() else b"")
+    digest.update(f"\0{env_name}\0{build_flags}\0{shared_build_key}".encode("utf-8"))
+    return digest.hexdigest()
+
+
+def parse_depfile(text: str) -> list[str]:
+    """Prerequisites listed in a make-style depfile written by -MMD."""
+    paths: list[str] = []
+    for rule in text.replace("\\\r\n", " ").replace("\\\n", " ").splitlines():
+        # The target ends at the first ": "; a Windows drive colon has no space after it.
+        _, separator, prerequisites = rule.partition(": ")
+        if not separator:
+            continue
+        for item in _DEPFILE_SPLIT_RE.split(prerequisites.strip()):
+            if item:
+                paths.append(item.replace("\\ ", " ").replace("$$", "$"))
+    return paths
+
+
+def collect_dependencies(build_dir: Path, project_root: Path, *, depfiles=None) -> set[Path]:
+    """Every file named by the depfiles under build_dir, as absolute paths."""
+    files: set[Path] = set()
+    for depfile in depfiles if depfiles is not None else build_dir.rglob("*.d"):
+        try:
+            text = Path(depfile).read_text(encoding="utf-8", errors="replace")
+        except OSError:
+            continue
+        for name in parse_depfile(text):
+            path = Path(name)
+            files.add((path if path.is_absolute() else project_root / path).resolve())
+    return files
+
+
+def changed_since(project_root: Path, ref: str) -> set[Path]:
+    """Files changed in the working tree since `ref`, plus untracked files.
+
+    Raises ValueError when git cannot answer (not a repository, unknown ref).
+    """
+    def git(*args: str) -> str:
+        result = subprocess.run(
+            ["git", *args], cwd=project_root, stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True
+        )
+        if result.returncode != 0:
+            raise ValueError(f"git {' '.join(args)}: {result.stderr.strip() or 'failed'}")
+        return result.stdout
+
+    try:
+        top = Path(git("rev-parse", "--show-toplevel").strip())
+        names = git("diff", "--name-only", ref, "--").splitlines()
+        names += git("ls-files", "--others", "--exclude-standard", "--full-name").splitlines()
+    except OSError as exc:
+        raise ValueError(f"git is not available: {exc}") from exc
+    return {(top / name).resolve() for name in names if name}
+
+
+def _stamp(path: Path) -> tuple[int, int] | None:
+    try:
+        info = path.stat()
+    except OSError:
+        return None
+    return info.st_mtime_ns, info.st_size
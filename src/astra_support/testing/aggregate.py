@@ -0,0 +1,291 @@
+from __future__ import annotations
+
+import re
+import shutil
+import subprocess
+from dataclasses import dataclass, field
+from pathlib import Path
+
+from .analyze import STATUS_PASS, STATUS_SYSTEM_ERR, analyze_output
+from .elf_symbols import weak_definitions
+from .models import TestRunResult
+
+AGGREGATE_SUITE = "test_astra_aggregate"
+SUITE_BEGIN = "::astra-suite-begin "
+SUITE_END = "::astra-suite-end "
+RUNNER_ASSETS = ("astra_aggregate.h", "astra_aggregate_main.cpp")
+# Unity and test-entry names every suite defines; each gets a per-suite name.
+RENAMED_SYMBOLS = ("main", "setUp", "tearDown", "astraSuiteReset")
+
+_SOURCE_SUFFIXES = {".c", ".cpp", ".cc", ".cxx"}
+_MAIN_RE = re.compile(r"^[ \t]*int\s+main\s*\([^)]*\)\s*\{", re.MULTILINE)
+_LOCAL_INCLUDE_RE = re.compile(r'^([ \t]*#[ \t]*include[ \t]*)"([^"]+)"', re.MULTILINE)
+_UNITY_SUMMARY_RE = re.compile(r"^(\d+) Tests (\d+) Failures (\d+) Ignored", re.MULTILINE)
+# GNU ld / gold: "multiple definition of `x'"; lld and ld64: "duplicate symbol: x" / "duplicate symbol 'x' in:".
+_CLASH_RE = re.compile(r"(?:multiple definition of|duplicate symbol:?)\s*[`'\"]?([^`'\";\n]*)")
+_OBJECT_RE = re.compile(r"[^\s:;'\"`()]+\.(?:o|obj)\b")
+# Lines after a clash report that name the objects involved (lld's ">>>" lines, ld64's list).
+_CLASH_CONTEXT_LINES = 6
+
+
+@dataclass
+class AggregatePlan:
+    """Generated PlatformIO test dir holding one program for many test folders.
+
+    `suites` are the folders compiled into the program; `skipped` maps folders
+    that cannot be aggregated to the reason, and those run one by one.
+    """
+
+    test_dir: Path
+    suites: list[str] = field(default_factory=list)
+    skipped: dict[str, str] = field(default_factory=dict)
+    wrappers: dict[str, str] = field(default_factory=dict)  # wrapper file stem -> folder
+
+
+def generate_aggregate(
+    test_dir: Path, folders: list[str], out_dir: Path, skip: dict[str, str] | None = None
+) -> AggregatePlan:
+    """Writes out_dir/<AGGREGATE_SUITE>/ with the runner and one wrapper per source.
+
+    Every wrapper includes the original file with main, setUp, tearDown and
+    astraSuiteReset renamed per suite, so diagnostics point at the real files.
+    Other non-static names stay global; folders in `skip` (e.g. from
+    symbol_clashes after a failed link) are left out with the given reason.
+    Files are only rewritten when their content changes, which keeps the
+    aggregate build incremental.
+    """
+    suite_dir = out_dir / AGGREGATE_SUITE
+    suite_dir.mkdir(parents=True, exist_ok=True)
+    plan = AggregatePlan(out_dir)
+    wanted = {"patched"}
+    for asset in RUNNER_ASSETS:
+        _write_if_changed(suite_dir / asset, (_asset_dir() / asset).read_text(encoding="utf-8"))
+        wanted.add(asset)
+
+    for folder in sorted(folders):
+        if skip and folder in skip:
+            plan.skipped[folder] = skip[folder]
+            continue
+        sources = sorted(path for path in (test_dir / folder).rglob("*") if path.suffix in _SOURCE_SUFFIXES)
+        mains = [path for path in sources if _MAIN_RE.search(path.read_text(encoding="utf-8", errors="replace"))]
+        if len(mains) != 1:
+            plan.skipped[folder] = "no main()" if not mains else "more than one main()"
+            continue
+        if any(path.suffix == ".c" for path in sources):
+            plan.skipped[folder] = "C sources"
+            continue
+        # Named after the folder, not its position, so a different selection of
+        # folders leaves the other wrappers (and their objects) untouched.
+        prefix = f"astra_suite_{_identifier(folder)}"
+        for source_index, source in enumerate(sources):
+            name = f"{prefix}_{source_index}_{source.stem}.cpp"
+            text = _wrapper(folder, prefix, source, source == mains[0], suite_dir)
+            _write_if_changed(suite_dir / name, text)
+            wanted.add(name)
+            plan.wrappers[Path(name).stem] = folder
+        plan.suites.append(folder)
+
+    for stale in suite_dir.iterdir():
+        if stale.name not in wanted:
+            if stale.is_dir():
+                shutil.rmtree(stale)
+            else:
+                stale.unlink()
+    return plan
+
+
+def symbol_clashes(output: str, wrappers: dict[str, str]) -> dict[str, str]:
+    """Folders whose wrapper objects the linker reported as defining the same
+    symbol, mapped to a reason naming it. Empty when the link failed otherwise."""
+    lines = output.splitlines()
+    clashes: dict[str, str] = {}
+    for index, line in enumerate(lines):
+        match = _CLASH_RE.search(line)
+        if match is None:
+            continue
+        symbol = match.group(1).strip() or "a symbol"
+        # GNU ld names the object on this line or the "in function" line before it.
+        context = "\n".join(lines[max(index - 1, 0) : index + 1 + _CLASH_CONTEXT_LINES])
+        for token in _OBJECT_RE.findall(context):
+            folder = wrappers.get(wrapper_stem(token))
+            if folder is not None:
+                clashes.setdefault(folder, f"{symbol} defined in more than one folder")
+    return clashes
+
+
+def inline_clashes(objects: list[Path], wrappers: dict[str, str]) -> dict[str, str] | None:
+    """Folders whose wrapper objects define the same weak symbol differently,
+    mapped to a reason naming it; None when an object is not ELF.
+
+    Inline functions, class members defined in the class and template
+    instances link without complaint, and the linker keeps one copy for every
+    suite. Copies compiled from one shared header are identical, so only
+    same-named definitions whose bytes or relocations differ count as a clash.
+    """
+    seen: dict[str, dict[str, set[str]]] = {}
+    for path in objects:
+        folder = wrappers.get(wrapper_stem(path.name))
+        if folder is None:
+            continue
+        definitions = weak_definitions(path)
+        if definitions is None:
+            return None
+        for symbol, fingerprint in definitions.items():
+            seen.setdefault(symbol, {}).setdefault(fingerprint, set()).add(folder)
+    clashes: dict[str, str] = {}
+    for symbol, variants in sorted(seen.items()):
+        if len(variants) < 2:
+            continue
+        for folder in sorted(set().union(*variants.values())):
+            clashes.setdefault(folder, f"inline {_demangle(symbol)} differs between folders")
+    return clashes
+
+
+def wrapper_stem(file_name: str) -> str:
+    """Wrapper name for a build output of it: `x.cpp.o`, `x.o` and `x.cpp.d` give `x`."""
+    name = Path(file_name).name
+    for suffix in (".o", ".obj", ".d"):
+        if name.endswith(suffix):
+            name = name[: -len(suffix)]
+            break
+    stem, dot, suffix = name.rpartition(".")
+    return stem if dot and f".{suffix}" in _SOURCE_SUFFIXES else name
+
+
+def split_suite_output(output: str) -> dict[str, tuple[int, str, float]]:
+    """Splits runner output into {suite: (exit code, output, seconds)}.
+
+    A suite that began but never ended (the runner died) gets code -1.
+    """
+    suites: dict[str, tuple[int, str, float]] = {}
+    name = None
+    lines: list[str] = []
+    for line in output.splitlines():
+        if line.startswith(SUITE_BEGIN):
+            if name is not None:
+                suites[name] = (-1, "\n".join(lines), 0.0)
+            name, lines = line[len(SUITE_BEGIN) :].strip(), []
+        elif line.startswith(SUITE_END) and name is not None:
+            parts = line[len(SUITE_END) :].split()
+            code = int(parts[1]) if len(parts) > 1 and parts[1].lstrip("-").isdigit() else -1
+            millis = int(parts[2]) if len(parts) > 2 and parts[2].isdigit() else 0
+            suites[name] = (code, "\n".join(lines), millis / 1000.0)
+            name = None
+        elif name is not None:
+            lines.append(line)
+    if name is not None:
+        suites[name] = (-1, "\n".join(lines), 0.0)
+    return suites
+
+
+def suite_results(suites: list[str], output: str, runner_log: str = "") -> list[TestRunResult]:
+    """One TestRunResult per aggregated folder, as if it had run on its own."""
+    found = split_suite_output(output)
+    results = []
+    for suite in suites:
+        if suite not in found:
+            log = runner_log or "Suite did not run in the aggregate program."
+            results.append(TestRunResult(suite, STATUS_SYSTEM_ERR, -1, log, 0.0))
+            continue
+        code, text, duration = found[suite]
+        status, log = analyze_output(text, code)
+        if code < 0 and status == STATUS_PASS:
+            status, log = STATUS_SYSTEM_ERR, "Aggregate program stopped inside this suite."
+        total, passed, failed = parse_unity_counts(text)
+        results.append(TestRunResult(suite, status, code, log, duration, total, passed, failed))
+    return results
+
+
+def parse_unity_counts(text: str) -> tuple[int | None, int | None, int | None]:
+    """Sums Unity's `N Tests M Failures K Ignored` lines."""
+    matches = _UNITY_SUMMARY_RE.findall(text)
+    if not matches:
+        return None, None, None
+    total = sum(int(tests) for tests, _, _ in matches)
+    failed = sum(int(failures) for _, failures, _ in matches)
+    ignored = sum(int(skipped) for _, _, skipped in matches)
+    return total, total - failed - ignored, failed
+
+
+def _wrapper(folder: str, prefix: str, source: Path, has_main: bool, suite_dir: Path) -> str:
+    lines = [f"// Generated by astra-support for {folder}; do not edit."]
+    lines += [f"#define {symbol} {prefix}_{symbol}" for symbol in RENAMED_SYMBOLS]
+    lines.append(f'#include "{_included_source(source, has_main, suite_dir)}"')
+    lines += [f"#undef {symbol}" for symbol in RENAMED_SYMBOLS]
+    if has_main:
+        lines += [
+            '#include "astra_aggregate.h"',
+            f'extern "C" void {prefix}_setUp(void) __attribute__((weak));',
+            f'extern "C" void {prefix}_tearDown(void) __attribute__((weak));',
+            f"void {prefix}_astraSuiteReset() __attribute__((weak));",
+            f"static int {prefix}_run(int argc, char **argv) {{ return astraCallMain(&{prefix}_main, argc, argv); }}",
+            f"static AstraSuiteRegistrar {prefix}_registrar("
+            f'{{"{folder}", {prefix}_run, {prefix}_setUp, {prefix}_tearDown, {prefix}_astraSuiteReset}});',
+        ]
+    return "\n".join(lines) + "\n"
+
+
+def _included_source(source: Path, has_main: bool, suite_dir: Path) -> str:
+    """Path the wrapper includes. A main() that falls off its end returns 0 only
+    because it is main; renamed it must return, so such a file is copied with
+    `return` added and its local includes made absolute."""
+    if not has_main:
+        return source.resolve().as_posix()
+    text = source.read_text(encoding="utf-8", errors="replace")
+    patched = _add_main_return(text)
+    if patched is None:
+        return source.resolve().as_posix()
+
+    def absolute(match: re.Match) -> str:
+        target = source.parent / match.group(2)
+        return f'{match.group(1)}"{target.resolve().as_posix()}"' if target.exists() else match.group(0)
+
+    patched = _LOCAL_INCLUDE_RE.sub(absolute, patched)
+    # .inc so PlatformIO does not also compile the copy as a test source.
+    copy = suite_dir / "patched" / f"{source.parent.name}_{source.stem}.inc"
+    copy.parent.mkdir(exist_ok=True)
+    _write_if_changed(copy, f'#line 1 "{source.resolve().as_posix()}"\n{patched}')
+    return copy.resolve().as_posix()
+
+
+def _add_main_return(text: str) -> str | None:
+    """text with `return 0;` before main's closing brace, or None if main already returns."""
+    match = _MAIN_RE.search(text)
+    if match is None:
+        return None
+    depth = 0
+    for position in range(match.end() - 1, len(text)):
+        if text[position] == "{":
+            depth += 1
+        elif text[position] == "}":
+            depth -= 1
+            if depth == 0:
+                body = text[match.end() : position]
+                if re.search(r"\breturn\b", body):
+                    return None
+                return f"{text[:position]}    return 0;\n{text[position:]}"
+    return None
+
+
+def _demangle(symbol: str) -> str:
+    tool = shutil.which("c++filt")
+    if tool is None:
+        return symbol
+    try:
+        result = subprocess.run([tool, symbol], stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, text=True, check=False)
+    except OSError:
+        return symbol
+    return result.stdout.strip() or symbol
+
+
+def _identifier(name: str) -> str:
+    return re.sub(r"\W", "_", name)
+
+
+def _write_if_changed(path: Path, text: str) -> None:
+    if not path.exists() or path.read_text(encoding="utf-8") != text:
+        path.write_text(text, encoding="utf-8")
+
+
+def _asset_dir() -> Path:
+    return Path(__file__).resolve().parents[1] / "assets" / "testing"
@@ -0,0 +1,127 @@
+from __future__ import annotations
+
+import hashlib
+import struct
+from dataclasses import dataclass
+from pathlib import Path
+
+_ELF_MAGIC = b"\x7fELF"
+_SHT_SYMTAB = 2
+_SHT_RELA = 4
+_SHT_NOBITS = 8
+_SHT_REL = 9
+_SHT_SYMTAB_SHNDX = 18
+_STB_WEAK = 2
+_STB_GNU_UNIQUE = 10
+_STT_OBJECT = 1
+_STT_FUNC = 2
+_STT_SECTION = 3
+_SHN_UNDEF = 0
+_SHN_LORESERVE = 0xFF00
+_SHN_XINDEX = 0xFFFF
+
+
+@dataclass(frozen=True)
+class _Layout:
+    """struct formats for one ELF class and byte order."""
+
+    endian: str
+    address: str  # e_shoff and the other address-sized fields
+    shoff_offset: int
+    shnum_offset: int  # e_shentsize, e_shnum, e_shstrndx follow
+    section: str
+    symbol: str
+    rel: str
+    rela: str
+    is64: bool
+
+
+def _layout(is64: bool, endian: str) -> _Layout:
+    if is64:
+        return _Layout(endian, "Q", 0x28, 0x3A, endian + "IIQQQQIIQQ", endian + "IBBHQQ", endian + "QQ", endian + "QQq", True)
+    return _Layout(endian, "I", 0x20, 0x2E, endian + "IIIIIIIIII", endian + "IIIBBH", endian + "II", endian + "IIi", False)
+
+
+def weak_definitions(path: Path) -> dict[str, str] | None:
+    """Fingerprints of the weak (COMDAT, inline) functions and objects an ELF
+    object file defines, by mangled name; None when the file is not ELF.
+
+    A fingerprint hashes the symbol's bytes and the relocations inside them, so
+    two objects compiling the same inline definition the same way agree, while
+    same-named definitions with different bodies do not.
+    """
+    data = path.read_bytes()
+    if data[:4] != _ELF_MAGIC or data[4] not in (1, 2) or data[5] not in (1, 2):
+        return None
+    layout = _layout(data[4] == 2, "<" if data[5] == 1 else ">")
+    (shoff,) = struct.unpack_from(layout.endian + layout.address, data, layout.shoff_offset)
+    _, shnum, shstrndx = struct.unpack_from(layout.endian + "HHH", data, layout.shnum_offset)
+    if shoff == 0:
+        return {}
+    section_size = struct.calcsize(layout.section)
+
+    def section(index: int) -> tuple:
+        return struct.unpack_from(layout.section, data, shoff + index * section_size)
+
+    first = section(0)
+    if shnum == 0:  # extended numbering: the count lives in section 0
+        shnum = first[5]
+    if shstrndx == _SHN_XINDEX:
+        shstrndx = first[6]
+    sections = [section(index) for index in range(shnum)]
+    names = sections[shstrndx]
+
+    def string(table: tuple, offset: int) -> str:
+        start = table[4] + offset
+        return data[start : data.index(b"\0", start)].decode("utf-8", "replace")
+
+    symtab_index = next((index for index, header in enumerate(sections) if header[1] == _SHT_SYMTAB), None)
+    if symtab_index is None:
+        return {}
+    symtab = sections[symtab_index]
+    strtab = sections[symtab[6]]
+    extended = next(
+        (header for header in sections if header[1] == _SHT_SYMTAB_SHNDX and header[6] == symtab_index), None
+    )
+    symbol_size = struct.calcsize(layout.symbol)
+    symbols = []
+    for index in range(symtab[5] // symbol_size):
+        fields = struct.unpack_from(layout.symbol, data, symtab[4] + index * symbol_size)
+        if layout.is64:
+            name, info, _, shndx, value, size = fields
+        else:
+            name, value, size, info, _, shndx = fields
+        if shndx == _SHN_XINDEX and extended is not None:
+            (shndx,) = struct.unpack_from(layout.endian + "I", data, extended[4] + index * 4)
+        symbols.append((string(strtab, name), info >> 4, info & 0xF, shndx, value, size))
+
+    relocations: dict[int, list[tuple[int, int, int, str]]] = {}
+    for header in sections:
+        if header[1] not in (_SHT_REL, _SHT_RELA) or header[6] != symtab_index:
+            continue
+        fmt = layout.rela if header[1] == _SHT_RELA else layout.rel
+        entry_size = struct.calcsize(fmt)
+        target = relocations.setdefault(header[7], [])
+        for offset in range(header[4], header[4] + header[5], entry_size):
+            fields = struct.unpack_from(fmt, data, offset)
+            r_offset, r_info, addend = fields[0], fields[1], fields[2] if len(fields) > 2 else 0
+            symbol_index, kind = (r_info >> 32, r_info & 0xFFFFFFFF) if layout.is64 else (r_info >> 8, r_info & 0xFF)
+            name, _, symbol_type, shndx, _, _ = symbols[symbol_index]
+            if symbol_type == _STT_SECTION and 0 < shndx < len(sections):
+                name = string(names, sections[shndx][0])
+            target.append((r_offset, kind, addend, name))
+
+    definitions = {}
+    for name, binding, symbol_type, shndx, value, size in symbols:
+        if binding not in (_STB_WEAK, _STB_GNU_UNIQUE) or symbol_type not in (_STT_FUNC, _STT_OBJECT):
+            continue
+        if shndx == _SHN_UNDEF or shndx >= _SHN_LORESERVE or shndx >= len(sections):
+            continue
+        header = sections[shndx]
+        body = bytes(size) if header[1] == _SHT_NOBITS else data[header[4] + value : header[4] + value + size]
+        digest = hashlib.sha256(body)
+        for r_offset, kind, addend, target in sorted(relocations.get(shndx, ())):
+            if value <= r_offset < value + size:
+                digest.update(f"\0{r_offset - value}\0{kind}\0{addend}\0{target}".encode("utf-8"))
+        definitions[name] = digest.hexdigest()
+    return definitions
@@ -0,0 +1,330 @@
+from __future__ import annotations
+
+import fnmatch
+import hashlib
+import json
+import os
+import shlex
+import shutil
+import subprocess
+import tempfile
+import time
+from concurrent.futures import ThreadPoolExecutor
+from dataclasses import dataclass, field
+from pathlib import Path
+
+from ..platformio.config import load_platformio_envs
+
+CACHE_ROOT_ENV = "ASTRA_SUPPORT_CACHE_DIR"
+DEFAULT_CACHE_ROOT = Path.home() / ".astra-support" / "native-cache"
+ARCHIVE_NAME = "astra_shared"
+NATIVE_PLATFORMS = {"native", "*"}
+# Defined by PlatformIO for every source of a `pio test` build.
+TEST_DEFINES = ("PIO_UNIT_TESTING", "UNIT_TEST")
+
+_CPP_SUFFIXES = {".cpp", ".cc", ".cxx"}
+_C_SUFFIXES = {".c"}
+_HEADER_SUFFIXES = {".h", ".hh", ".hpp", ".hxx", ".inl", ".ipp", ".tpp"}
+_DEFAULT_SRC_FILTER = ["+<*>", "-<.git/>", "-<.svn/>"]
+
+
+@dataclass(frozen=True)
+class NativeLibrary:
+    """One installed library of the test env, as PlatformIO would build it."""
+
+    name: str
+    root: Path
+    src_dir: Path
+    include_dirs: tuple[Path, ...]
+    sources: tuple[Path, ...]
+
+
+@dataclass
+class SharedBuild:
+    """A prebuilt static library holding the env's library sources.
+
+    Test folders link against `archive` and ignore `libraries`, so PlatformIO
+    only compiles the project and test sources per folder.
+    """
+
+    archive: Path
+    key: str
+    libraries: list[NativeLibrary]
+    include_dirs: list[Path] = field(default_factory=list)
+    cached: bool = False
+
+    def build_flags(self) -> list[str]:
+        flags = [f"-I{path}" for path in self.include_dirs]
+        flags += [f"-L{self.archive.parent}", f"-l{ARCHIVE_NAME}"]
+        return flags
+
+    def lib_ignore(self) -> list[str]:
+        return [library.name for library in self.libraries]
+
+
+def cache_root() -> Path:
+    override = os.getenv(CACHE_ROOT_ENV)
+    return Path(override).expanduser() if override else DEFAULT_CACHE_ROOT
+
+
+def libdeps_dir(project_root: Path, env_name: str) -> Path:
+    return project_root / ".pio" / "libdeps" / env_name
+
+
+def find_native_libraries(libdeps: Path) -> list[NativeLibrary]:
+    """Installed libraries under `libdeps` that can build for the native platform."""
+    if not libdeps.is_dir():
+        return []
+    libraries = []
+    for root in sorted(path for path in libdeps.iterdir() if path.is_dir() and not path.name.startswith(".")):
+        library = _load_library(root)
+        if library is not None and library.sources:
+            libraries.append(library)
+    return libraries
+
+
+def env_build_flags(project_root: Path, env_name: str) -> list[str]:
+    """The env's build_flags plus PLATFORMIO_BUILD_FLAGS, without link-only flags."""
+    text = ""
+    for env in load_platformio_envs(project_root / "platformio.ini"):
+        if env.name == env_name:
+            text = env.values.get("build_flags", "")
+    text = f"{text} {os.getenv('PLATFORMIO_BUILD_FLAGS', '')}"
+    flags = []
+    for flag in shlex.split(text.replace("\n", " ")):
+        if "${" in flag or flag.startswith(("-l", "-L", "-Wl,")):
+            continue
+        flags.append(flag)
+    return flags
+
+
+def test_build_defines(platformio_version: str | None = None) -> list[str]:
+    """-D flags a `pio test` build compiles every source with, including the
+    library sources the archive replaces (e.g. SITLSocket's PIO_UNIT_TESTING paths)."""
+    defines = [f"-D{name}" for name in TEST_DEFINES]
+    parts = (platformio_version or "").split(".")
+    if len(parts) >= 3 and all(part.isdigit() for part in parts[:3]):
+        major, minor, patch = (int(part) for part in parts[:3])
+        defines.append(f"-DPLATFORMIO={major * 10000 + minor * 100 + patch}")
+    return defines
+
+
+def platformio_version(pio_cmd: list[str]) -> str | None:
+    """`pio --version` as "6.1.18", or None when it cannot be run."""
+    try:
+        result = subprocess.run([*pio_cmd, "--version"], stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+    except OSError:
+        return None
+    words = result.stdout.split()
+    return words[-1] if result.returncode == 0 and words else None
+
+
+def build_key(compiler: str, flags: list[str], libraries: list[NativeLibrary]) -> str:
+    """Hash of everything the archive depends on: compiler, flags and library files."""
+    digest = hashlib.sha256()
+    digest.update(_compiler_identity(compiler).encode("utf-8"))
+    digest.update("\0".join(flags).encode("utf-8"))
+    for library in libraries:
+        digest.update(f"\0lib\0{library.name}\0".encode("utf-8"))
+        for path in _library_files(library):
+            digest.update(path.relative_to(library.root).as_posix().encode("utf-8"))
+            digest.update(hashlib.sha256(path.read_bytes()).digest())
+    return digest.hexdigest()
+
+
+def prepare_shared_build(
+    project_root: Path,
+    env_name: str,
+    compiler: str,
+    *,
+    jobs: int | None = None,
+    platformio_version: str | None = None,
+) -> tuple[SharedBuild | None, str]:
+    """Returns the env's shared library archive, building it on a cache miss.
+
+    The archive lives under cache_root()/<key>, so every project and test
+    folder with the same compiler, flags and library sources reuses it. Sources
+    get the env's build_flags plus test_build_defines(), as in `pio test`. Returns
+    (None, log) when there is nothing to share or the build fails; callers then
+    build each folder the usual way.
+    """
+    libraries = find_native_libraries(libdeps_dir(project_root, env_name))
+    if not libraries:
+        return None, f"No installed libraries under {libdeps_dir(project_root, env_name)}"
+    flags = [*test_build_defines(platformio_version), *env_build_flags(project_root, env_name)]
+    include_dirs = _unique(path for library in libraries for path in library.include_dirs)
+    key = build_key(compiler, flags, libraries)
+    target_dir = cache_root() / key[:24]
+    archive = target_dir / f"lib{ARCHIVE_NAME}.a"
+    shared = SharedBuild(archive, key, libraries, include_dirs)
+    if archive.exists():
+        shared.cached = True
+        return shared, ""
+
+    target_dir.parent.mkdir(parents=True, exist_ok=True)
+    staging = Path(tempfile.mkdtemp(prefix=f".{key[:24]}-", dir=target_dir.parent))
+    try:
+        ok, log = _build_archive(compiler, flags, include_dirs, libraries, staging, jobs)
+        if not ok:
+            return None, log
+        try:
+            staging.rename(target_dir)
+        except OSError:
+            if not archive.exists():  # another run finished first otherwise
+                raise
+        return shared, log
+    finally:
+        shutil.rmtree(staging, ignore_errors=True)
+
+
+def _build_archive(
+    compiler: str,
+    flags: list[str],
+    include_dirs: list[Path],
+    libraries: list[NativeLibrary],
+    out_dir: Path,
+    jobs: int | None,
+) -> tuple[bool, str]:
+    includes = [f"-I{path}" for path in include_dirs]
+    commands = []
+    for library in libraries:
+        for index, source in enumerate(library.sources):
+            obj = out_dir / f"{library.name}.{index}.{source.stem}.o"
+            if source.suffix in _C_SUFFIXES:
+                cmd = [_c_compiler(compiler), *[f for f in flags if not f.startswith("-std=c++")]]
+            else:
+                cmd = [compiler, *flags]
+            commands.append((obj, [*cmd, *includes, f"-I{library.src_dir}", "-c", str(source), "-o", str(obj)]))
+
+    def compile_one(item):
+        obj, cmd = item
+        result = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+        return result.returncode, result.stdout
+
+    with ThreadPoolExecutor(max_workers=max(1, jobs or os.cpu_count() or 1)) as executor:
+        results = list(executor.map(compile_one, commands))
+    failed = [output for code, output in results if code != 0]
+    if failed:
+        return False, "\n".join(failed)
+
+    archiver = shutil.which("ar") or shutil.which("gcc-ar")
+    if archiver is None:
+        return False, "No archiver (ar) found on PATH."
+    result = subprocess.run(
+        [archiver, "rcs", str(out_dir / f"lib{ARCHIVE_NAME}.a"), *(str(obj) for obj, _ in commands)],
+        stdout=subprocess.PIPE,
+        stderr=subprocess.STDOUT,
+        text=True,
+    )
+    for obj, _ in commands:
+        obj.unlink(missing_ok=True)
+    (out_dir / "build.json").write_text(
+        json.dumps(
+            {
+                "compiler": compiler,
+                "flags": flags,
+                "libraries": [library.name for library in libraries],
+                "sources": sum(len(library.sources) for library in libraries),
+                "created": time.strftime("%Y-%m-%dT%H:%M:%S"),
+            },
+            indent=2,
+        ),
+        encoding="utf-8",
+    )
+    return result.returncode == 0, result.stdout
+
+
+def _load_library(root: Path) -> NativeLibrary | None:
+    manifest: dict = {}
+    manifest_path = root / "library.json"
+    if manifest_path.exists():
+        try:
+            manifest = json.loads(manifest_path.read_text(encoding="utf-8"))
+        except (OSError, ValueError):
+            return None
+    elif not (root / "library.properties").exists() and not (root / "src").is_dir():
+        return None
+
+    platforms = manifest.get("platforms", "*")
+    if isinstance(platforms, str):
+        platforms = [item.strip() for item in platforms.split(",")]
+    if not NATIVE_PLATFORMS.intersection(platforms):
+        return None
+
+    build = manifest.get("build", {})
+    src_dir = root / build.get("srcDir", "src")
+    if not src_dir.is_dir():
+        src_dir = root
+    include_dirs = [src_dir]
+    include_dir = root / build.get("includeDir", "include")
+    if include_dir.is_dir():
+        include_dirs.insert(0, include_dir)
+    src_filter = build.get("srcFilter", _DEFAULT_SRC_FILTER)
+    if isinstance(src_filter, str):
+        src_filter = src_filter.split()
+    sources = tuple(
+        path
+        for path in _filter_sources(src_dir, src_filter)
+        if path.suffix in _CPP_SUFFIXES | _C_SUFFIXES
+    )
+    return NativeLibrary(manifest.get("name", root.name), root, src_dir, tuple(include_dirs), sources)
+
+
+def _filter_sources(src_dir: Path, src_filter: list[str]) -> list[Path]:
+    """Applies PlatformIO `+<glob>` / `-<glob>` filters, in order, to files under src_dir."""
+    files = sorted(path for path in src_dir.rglob("*") if path.is_file())
+    relative = {path: path.relative_to(src_dir).as_posix() for path in files}
+    selected: set[Path] = set()
+    for item in src_filter:
+        item = item.strip()
+        if len(item) < 4 or item[0] not in "+-" or item[1] != "<" or item[-1] != ">":
+            continue
+        pattern = item[2:-1]
+        matched = {path for path, rel in relative.items() if _filter_matches(rel, pattern)}
+        selected = selected | matched if item[0] == "+" else selected - matched
+    return [path for path in files if path in selected]
+
+
+def _filter_matches(rel: str, pattern: str) -> bool:
+    if pattern.endswith("/"):
+        return rel.startswith(pattern) or fnmatch.fnmatch(rel, pattern + "*")
+    if fnmatch.fnmatch(rel, pattern):
+        return True
+    # A pattern naming a directory selects everything below it.
+    parts = rel.split("/")
+    return any(fnmatch.fnmatch("/".join(parts[:depth]), pattern) for depth in range(1, len(parts)))
+
+
+def _library_files(library: NativeLibrary) -> list[Path]:
+    files = set(library.sources)
+    for directory in library.include_dirs:
+        files.update(path for path in directory.rglob("*") if path.is_file() and path.suffix in _HEADER_SUFFIXES)
+    return sorted(files)
+
+
+def _compiler_identity(compiler: str) -> str:
+    try:
+        result = subprocess.run([compiler, "--version"], stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+        version = result.stdout
+    except OSError:
+        version = ""
+    return f"{shutil.which(compiler) or compiler}\n{version}"
+
+
+def _c_compiler(compiler: str) -> str:
+    name = Path(compiler).name
+    if "g++" in name:
+        candidate = str(Path(compiler).with_name(name.replace("g++", "gcc")))
+        if shutil.which(candidate):
+            return candidate
+    if "clang++" in name:
+        return compiler.replace("clang++", "clang")
+    return compiler
+
+
+def _unique(paths) -> list[Path]:
+    seen: list[Path] = []
+    for path in paths:
+        if path not in seen:
+            seen.append(path)
+    return seen
@@ -6,15 +6,36 @@ import time
 from dataclasses import dataclass, field
 from pathlib import Path
 
-from ..platformio.config import env_platform_map, env_names, filter_envs, select_build_envs, select_test_env
+from ..platformio.config import (
+    env_names,
+    env_platform_map,
+    filter_envs,
+    load_platformio_envs,
+    select_build_envs,
+    select_test_env,
+)
 from ..prereqs import check_toolchain
-from .analyze import STATUS_PASS, STATUS_SYSTEM_ERR, analyze_output, parse_test_counts
+from .affected import DEPFILE_FLAG, DependencyGraph, changed_since, collect_dependencies, context_key
+from .aggregate import (
+    AGGREGATE_SUITE,
+    AggregatePlan,
+    generate_aggregate,
+    inline_clashes,
+    suite_results,
+    symbol_clashes,
+    wrapper_stem,
+)
+from .analyze import STATUS_PASS, STATUS_SYSTEM_ERR, STATUS_TEST_FAIL, analyze_output, parse_test_counts
 from .executor import run_parallel_with_retries
 from .models import RunResult, TestRunResult
+from .native_cache import SharedBuild, libdeps_dir, platformio_version, prepare_shared_build
 from .report import ProgressReporter, print_result, print_stage, print_summary
+from .timings import TimingHistory, balance_shards, longest_first
 
 
 MAX_RETRIES = 3
+# Aggregate builds repeated after dropping clashing folders, each one a full link.
+AGGREGATE_CLASH_REBUILDS = 2
 
 
 @dataclass
@@ -25,6 +46,10 @@ class TestRunnerOptions:
     no_builds: bool = False
     no_tests: bool = False
     clean: bool = False
+    shared_cache: bool = True
+    aggregate: bool = False
+    run_all: bool = False
+    since: str | None = None
     envs: list[str] | None = None
     default_args: list[str] = field(default_factory=list)
 
@@ -39,6 +64,10 @@ class RunnerContext:
     build_envs: list[str]
     platforms: dict[str, str]
     test_env: str | None
+    timings: TimingHistory
+    dependencies: DependencyGraph
+    cpp_compiler: str | None = None
+    shared_build: SharedBuild | None = None
 
 
 def run_tests(options: TestRunnerOptions) -> int:
@@ -65,6 +94,14 @@ def run_tests(options: TestRunnerOptions) -> int:
             print(error)
         return 2
 
+    changed: set[Path] = set()
+    if options.since and not options.run_all and not options.no_tests:
+        try:
+            changed = changed_since(project_root, options.since)
+        except ValueError as exc:
+            print(f"Cannot list changes since {options.since}: {exc}")
+            return 2
+
     ctx = RunnerContext(
         project_root=project_root,
         pio_cmd=toolchain.platformio_cmd or ["pio"],
@@ -74,6 +111,9 @@ def run_tests(options: TestRunnerOptions) -> int:
         build_envs=build_envs,
         platforms=platforms,
         test_env=test_env,
+        timings=TimingHistory.load(project_root),
+        dependencies=DependencyGraph.load(project_root),
+        cpp_compiler=toolchain.cpp_compiler,
     )
 
     clean_results: list[RunResult] = []
@@ -108,11 +148,12 @@ def run_tests(options: TestRunnerOptions) -> int:
     if not options.no_builds:
         print_stage("build")
         build_results = _run_pool(
-            ctx.build_envs,
+            longest_first(ctx.build_envs, lambda env: ctx.timings.estimate("build", env, env)),
             lambda env: _run_build_env(ctx, env),
             progress=progress,
             stage_name="build",
         )
+        _record_timings(ctx, "build", build_results, env_of_result=True)
         for result in build_results:
             print_result(result.name, result.status, result.duration, log=result.log)
 
@@ -123,17 +164,47 @@ def run_tests(options: TestRunnerOptions) -> int:
         elif not ctx.test_dir.exists():
             print(f"Test directory not found: {ctx.test_dir}")
         else:
-            folders = sorted(path.name for path in ctx.test_dir.iterdir() if path.is_dir())
-            test_results = _run_pool(
+            folders = longest_first(
+                (path.name for path in ctx.test_dir.iterdir() if path.is_dir()),
+                lambda folder: ctx.timings.estimate("test", ctx.test_env, folder),
+            )
+            # Before the affected check: a header only library sources include leaves no
+            # folder depfile entry, but it changes the shared archive's key.
+            if options.shared_cache and will_test_native and len(folders) > 1:
+                ctx.shared_build = _prepare_shared_build(ctx)
+            context = context_key(
+                ctx.project_root,
+                ctx.test_env,
+                os.getenv("PLATFORMIO_BUILD_FLAGS", ""),
+                ctx.shared_build.key if ctx.shared_build is not None else "",
+            )
+            if not (options.run_all or options.clean):
+                folders, unaffected = ctx.dependencies.affected(folders, ctx.test_dir, context, changed)
+                if unaffected:
+                    print(f"{len(unaffected)} test folder(s) unaffected by changes since their last run (--all runs them)")
+            ctx.dependencies.context = context
+            if options.aggregate and will_test_native and len(folders) > 1:
+                test_results, folders = _run_aggregate(ctx, folders, progress)
+            folder_results = _run_pool(
                 folders,
                 lambda folder: _run_test_folder(ctx, folder),
                 progress=progress,
                 stage_name="test",
             )
+            _record_timings(ctx, "test", folder_results)
+            for result in folder_results:
+                files = collect_dependencies(ctx.parallel_build_base / result.name, ctx.project_root)
+                ctx.dependencies.update(result.name, files | _shared_sources(ctx), result.status)
+            test_results += folder_results
             for result in test_results:
                 extra = f"[{result.test_count} cases]" if result.test_count is not None else ""
                 print_result(result.name, result.status, result.duration, extra=extra, log=result.log)
 
+    for history in (ctx.timings, ctx.dependencies):
+        try:
+            history.save()
+        except OSError as exc:
+            print(f"Could not save {history.path}: {exc}")
     print_summary(clean_results, install_results, build_results, test_results)
     failures = [result for result in [*clean_results, *install_results, *build_results, *test_results] if result.status != STATUS_PASS]
     return 1 if failures else 0
@@ -158,6 +229,21 @@ def _run_pool(items, worker, *, progress: ProgressReporter, stage_name: str):
         progress.stop()
 
 
+def _record_timings(ctx: RunnerContext, stage: str, results, *, env_of_result: bool = False) -> None:
+    # Compile and system errors stop early, so their durations say nothing about a full run.
+    for result in results:
+        if result.status in (STATUS_PASS, STATUS_TEST_FAIL):
+            env = result.name if env_of_result else ctx.test_env or ""
+            ctx.timings.record(stage, env, result.name, result.duration)
+
+
+def _shared_sources(ctx: RunnerContext) -> set[Path]:
+    # Objects in the shared archive leave no depfiles in the folder's build dir.
+    if ctx.shared_build is None:
+        return set()
+    return {path.resolve() for library in ctx.shared_build.libraries for path in library.sources}
+
+
 def _platforms_for_envs(envs: list[str], mapping: dict[str, str]) -> list[str]:
     ordered: list[str] = []
     for env in envs:
@@ -211,11 +297,162 @@ def _run_build_env(ctx: RunnerContext, env_name: str) -> RunResult:
     return RunResult(env_name, status, code, log, duration)
 
 
+def _prepare_shared_build(ctx: RunnerContext) -> SharedBuild | None:
+    """Builds (or reuses) the library archive every native test folder links against.
+    Any failure falls back to PlatformIO building the libraries in each folder."""
+    start = time.time()
+    env_name = ctx.test_env or ""
+    if ctx.cpp_compiler is None:
+        return None
+    if not libdeps_dir(ctx.project_root, env_name).is_dir():
+        code, output, _ = _run_command(ctx, [*ctx.pio_cmd, "pkg", "install", "-e", env_name])
+        if code != 0:
+            print_result("shared libraries", STATUS_SYSTEM_ERR, time.time() - start, log=analyze_output(output, code)[1])
+            return None
+    try:
+        shared, log = prepare_shared_build(
+            ctx.project_root, env_name, ctx.cpp_compiler, platformio_version=platformio_version(ctx.pio_cmd)
+        )
+    except OSError as exc:
+        shared, log = None, str(exc)
+    if shared is None:
+        status, log = analyze_output(log, 1)
+        print_result("shared libraries", status, time.time() - start, extra="(building per folder)", log=log)
+        return None
+    names = ", ".join(shared.lib_ignore())
+    extra = f"[{'cached' if shared.cached else 'built'} {shared.key[:12]}: {names}]"
+    print_result("shared libraries", STATUS_PASS, time.time() - start, extra=extra)
+    return shared
+
+
 def _run_test_folder(ctx: RunnerContext, folder_name: str) -> TestRunResult:
     unique_build_path = ctx.parallel_build_base / folder_name
     env = os.environ.copy()
     env["PLATFORMIO_BUILD_DIR"] = str(unique_build_path)
-    code, output, duration = _run_command(ctx, [*ctx.pio_cmd, "test", "-e", ctx.test_env or "", "-f", folder_name], env=env)
+    cmd = [*ctx.pio_cmd, "test", "-e", ctx.test_env or "", "-f", folder_name]
+    flags = [DEPFILE_FLAG]
+    if ctx.shared_build is not None:
+        flags += ctx.shared_build.build_flags()
+        cmd += ["-O", f"lib_ignore={', '.join(_env_lib_ignore(ctx) + ctx.shared_build.lib_ignore())}"]
+    env["PLATFORMIO_BUILD_FLAGS"] = " ".join([env.get("PLATFORMIO_BUILD_FLAGS", ""), *flags]).strip()
+    code, output, duration = _run_command(ctx, cmd, env=env)
     status, log = analyze_output(output, code)
     test_count, passed_count, failed_count = parse_test_counts(output)
     return TestRunResult(folder_name, status, code, log, duration, test_count, passed_count, failed_count)
+
+
+def _run_aggregate(
+    ctx: RunnerContext, folders: list[str], progress: ProgressReporter
+) -> tuple[list[TestRunResult], list[str]]:
+    """Builds every aggregatable folder into one program and runs it in shards.
+
+    Returns the per-folder results and the folders still to run one by one:
+    those the plan skipped, or all of them when the aggregate build fails.
+    Folders that define the same global, or the same inline definition
+    differently, are dropped and the rest built again, up to
+    AGGREGATE_CLASH_REBUILDS times.
+    """
+    start = time.time()
+    out_dir = ctx.parallel_build_base / "_aggregate" / "test"
+    build_dir = ctx.parallel_build_base / "_aggregate" / "build"
+    skip: dict[str, str] = {}
+    for _ in range(AGGREGATE_CLASH_REBUILDS + 1):
+        plan = generate_aggregate(ctx.test_dir, folders, out_dir, skip=skip)
+        if len(plan.suites) < 2:
+            code, output, clashes = 0, "", {}
+            break
+        code, output = _build_aggregate(ctx, plan, build_dir)
+        if code != 0:
+            clashes = symbol_clashes(output, plan.wrappers)
+        else:
+            objects = [path for path in build_dir.rglob("*.o") if wrapper_stem(path.name) in plan.wrappers]
+            clashes = inline_clashes(objects, plan.wrappers)
+        if not clashes:
+            break
+        skip.update(clashes)
+    remaining = [folder for folder in folders if folder not in plan.suites]
+    for folder, reason in plan.skipped.items():
+        progress.write(f"aggregate: {folder} runs on its own ({reason})")
+    if len(plan.suites) < 2:
+        return [], folders
+    if clashes is None:
+        progress.write("aggregate: objects are not ELF, so inline clashes cannot be checked; running folders one by one")
+        return [], folders
+    if clashes and code == 0:
+        progress.write("aggregate: folders still clash after rebuilding; running folders one by one")
+        return [], folders
+
+    program = build_dir / (ctx.test_env or "") / ("program.exe" if os.name == "nt" else "program")
+    if code != 0 or not program.exists():
+        status, log = analyze_output(output, code or 1)
+        print_result("aggregate build", status, time.time() - start, extra="(running folders one by one)", log=log)
+        return [], folders
+    print_result("aggregate build", STATUS_PASS, time.time() - start, extra=f"[{len(plan.suites)} suites]")
+
+    shards = balance_shards(
+        plan.suites,
+        lambda suite: ctx.timings.estimate("suite", ctx.test_env, suite),
+        max(1, (os.cpu_count() or 1) - 1),
+    )
+    runs = _run_pool(
+        [tuple(shard) for shard in shards],
+        lambda shard: _run_aggregate_shard(ctx, program, shard),
+        progress=progress,
+        stage_name="test",
+    )
+    output = "\n".join(run.log for run in runs)
+    runner_log = "\n".join(run.log for run in runs if run.code not in (0, 1))
+    results = suite_results(plan.suites, output, runner_log)
+    _record_timings(ctx, "suite", results)
+    _record_aggregate_dependencies(ctx, plan.wrappers, build_dir, results)
+    return results, remaining
+
+
+def _build_aggregate(ctx: RunnerContext, plan: AggregatePlan, build_dir: Path) -> tuple[int, str]:
+    env = os.environ.copy()
+    env["PLATFORMIO_TEST_DIR"] = str(plan.test_dir)
+    env["PLATFORMIO_BUILD_DIR"] = str(build_dir)
+    flags = [f"-I{ctx.test_dir}", DEPFILE_FLAG]
+    cmd = [*ctx.pio_cmd, "test", "-e", ctx.test_env or "", "-f", AGGREGATE_SUITE, "--without-testing"]
+    if ctx.shared_build is not None:
+        flags += ctx.shared_build.build_flags()
+        cmd += ["-O", f"lib_ignore={', '.join(_env_lib_ignore(ctx) + ctx.shared_build.lib_ignore())}"]
+    env["PLATFORMIO_BUILD_FLAGS"] = " ".join([env.get("PLATFORMIO_BUILD_FLAGS", ""), *flags]).strip()
+    code, output, _ = _run_command(ctx, cmd, env=env)
+    return code, output
+
+
+def _record_aggregate_dependencies(ctx: RunnerContext, wrappers: dict[str, str], build_dir: Path, results) -> None:
+    """Suite wrappers' depfiles belong to their folder; every other object
+    (runner, project and library sources) is shared by all suites."""
+    by_folder: dict[str, list[Path]] = {}
+    shared: list[Path] = []
+    for depfile in build_dir.rglob("*.d"):
+        folder = wrappers.get(wrapper_stem(depfile.name))
+        if folder is not None:
+            by_folder.setdefault(folder, []).append(depfile)
+        elif AGGREGATE_SUITE not in depfile.parts:
+            shared.append(depfile)
+    common = collect_dependencies(build_dir, ctx.project_root, depfiles=shared) | _shared_sources(ctx)
+    for result in results:
+        files = collect_dependencies(build_dir, ctx.project_root, depfiles=by_folder.get(result.name, []))
+        ctx.dependencies.update(result.name, files | common, result.status)
+
+
+def _run_aggregate_shard(ctx: RunnerContext, program: Path, suites: tuple[str, ...]) -> RunResult:
+    cmd = [str(program)]
+    for suite in suites:
+        cmd += ["--suite", suite]
+    code, output, duration = _run_command(ctx, cmd)
+    # The raw output is kept: suite_results splits it per folder.
+    return RunResult(", ".join(suites), STATUS_PASS if code == 0 else STATUS_TEST_FAIL, code, output, duration)
+
+
+def _env_lib_ignore(ctx: RunnerContext) -> list[str]:
+    # -O replaces the option, so keep what platformio.ini already ignores.
+    for env in load_platformio_envs(ctx.project_root / "platformio.ini"):
+        if env.name == ctx.test_env:
+            value = env.values.get("lib_ignore", "")
+            return [name.strip() for name in value.replace("\n", ",").split(",") if name.strip()]
+    return []
+
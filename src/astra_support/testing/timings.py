@@ -0,0 +1,97 @@
+from __future__ import annotations
+
+import json
+import os
+import tempfile
+from pathlib import Path
+from typing import Callable, Iterable, TypeVar
+
+TIMINGS_PATH = Path(".pio") / "astra-support" / "timings.json"
+TIMINGS_VERSION = 1
+# Weight of the newest run in the smoothed duration.
+SMOOTHING = 0.5
+
+ItemT = TypeVar("ItemT")
+
+
+class TimingHistory:
+    """Smoothed durations of earlier runs, keyed by stage, env and item name.
+
+    Stored in the project under TIMINGS_PATH so schedules follow the project's
+    own history; a missing or unreadable file just means no history yet.
+    """
+
+    def __init__(self, path: Path, entries: dict[str, float] | None = None):
+        self.path = path
+        self.entries = dict(entries or {})
+
+    @classmethod
+    def load(cls, project_root: Path) -> TimingHistory:
+        path = project_root / TIMINGS_PATH
+        try:
+            data = json.loads(path.read_text(encoding="utf-8"))
+        except (OSError, ValueError):
+            return cls(path)
+        if not isinstance(data, dict) or data.get("version") != TIMINGS_VERSION:
+            return cls(path)
+        entries = {
+            key: float(value)
+            for key, value in data.get("durations", {}).items()
+            if isinstance(value, (int, float)) and value >= 0
+        }
+        return cls(path, entries)
+
+    def estimate(self, stage: str, env: str, name: str) -> float | None:
+        return self.entries.get(_key(stage, env, name))
+
+    def record(self, stage: str, env: str, name: str, duration: float) -> None:
+        key = _key(stage, env, name)
+        previous = self.entries.get(key)
+        self.entries[key] = duration if previous is None else SMOOTHING * duration + (1 - SMOOTHING) * previous
+
+    def save(self) -> None:
+        self.path.parent.mkdir(parents=True, exist_ok=True)
+        payload = {"version": TIMINGS_VERSION, "durations": dict(sorted(self.entries.items()))}
+        handle, temp_name = tempfile.mkstemp(prefix=".timings-", dir=self.path.parent)
+        try:
+            with os.fdopen(handle, "w", encoding="utf-8") as stream:
+                json.dump(payload, stream, indent=2)
+            os.replace(temp_name, self.path)
+        except BaseException:
+            Path(temp_name).unlink(missing_ok=True)
+            raise
+
+
+def longest_first(items: Iterable[ItemT], estimate: Callable[[ItemT], float | None]) -> list[ItemT]:
+    """Items in longest-processing-time-first order.
+
+    Items without history go first: they may be slow, and starting them early
+    costs nothing when they are not. Ties keep name order.
+    """
+    known = {item: estimate(item) for item in items}
+    return sorted(sorted(known, key=str), key=lambda item: (known[item] is not None, -(known[item] or 0.0)))
+
+
+def balance_shards(
+    items: Iterable[ItemT], estimate: Callable[[ItemT], float | None], shards: int
+) -> list[list[ItemT]]:
+    """Greedy LPT split of items into at most `shards` groups of similar total time.
+
+    Each item, longest first, goes to the group with the least work so far.
+    Items without history count as the mean of the known ones.
+    """
+    ordered = longest_first(items, estimate)
+    known = [value for value in (estimate(item) for item in ordered) if value is not None]
+    fallback = sum(known) / len(known) if known else 1.0
+    groups: list[list[ItemT]] = [[] for _ in range(max(1, min(shards, len(ordered))))]
+    loads = [0.0] * len(groups)
+    for item in ordered:
+        value = estimate(item)
+        target = loads.index(min(loads))
+        groups[target].append(item)
+        loads[target] += fallback if value is None else value
+    return [group for group in groups if group]
+
+
+def _key(stage: str, env: str, name: str) -> str:
+    return f"{stage}/{env}/{name}"
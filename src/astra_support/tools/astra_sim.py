@@ -3,21 +3,29 @@ from __future__ import annotations
 from ..sim.data_sources import (
     CSVSim,
     DataSource,
+    MergedCSVSim,
     NetworkStreamSim,
     NoisySim,
+    PacketBlock,
     PacketData,
     PadDelaySim,
     PhysicsSim,
     RotatedSim,
+    monte_carlo_runs,
+    read_blocks,
 )
 
 __all__ = [
     "PacketData",
+    "PacketBlock",
     "DataSource",
     "PhysicsSim",
     "CSVSim",
+    "MergedCSVSim",
     "NetworkStreamSim",
     "PadDelaySim",
     "RotatedSim",
     "NoisySim",
+    "read_blocks",
+    "monte_carlo_runs",
 ]
@@ -0,0 +1,138 @@
+from __future__ import annotations
+
+import os
+import shutil
+import subprocess
+import tempfile
+import unittest
+from pathlib import Path
+from types import SimpleNamespace
+from unittest import mock
+
+from astra_support.testing import affected, runner
+from astra_support.testing.analyze import STATUS_PASS, STATUS_TEST_FAIL
+from astra_support.testing.native_cache import SharedBuild
+
+
+def _write(path: Path, text: str) -> Path:
+    path.parent.mkdir(parents=True, exist_ok=True)
+    path.write_text(text, encoding="utf-8")
+    return path.resolve()
+
+
+class AffectedTests(unittest.TestCase):
+    def setUp(self):
+        self._tmp = tempfile.TemporaryDirectory()
+        self.addCleanup(self._tmp.cleanup)
+        self.root = Path(self._tmp.name).resolve()
+        _write(self.root / "platformio.ini", "[env:native]\nplatform = native\n")
+        self.nav = _write(self.root / "test" / "test_nav" / "test_main.cpp", "int main() { return 0; }\n")
+        self.radio = _write(self.root / "test" / "test_radio" / "test_main.cpp", "int main() { return 0; }\n")
+        self.filter_h = _write(self.root / "src" / "filter.h", "#pragma once\n")
+        self.radio_h = _write(self.root / "src" / "radio.h", "#pragma once\n")
+
+    def test_parse_depfile(self):
+        text = "build/x.o: src/a\\ b.cpp \\\n  C:\\lib\\c.h /abs/d.h\n\nsrc/a\\ b.h:\n"
+
+        self.assertEqual(affected.parse_depfile(text), ["src/a b.cpp", "C:\\lib\\c.h", "/abs/d.h"])
+
+    def test_only_folders_depending_on_a_change_are_affected(self):
+        graph = affected.DependencyGraph(self.root / affected.DEPS_PATH, "ctx")
+        graph.update("test_nav", {self.nav, self.filter_h}, STATUS_PASS)
+        graph.update("test_radio", {self.radio, self.radio_h}, STATUS_PASS)
+        folders = ["test_nav", "test_radio", "test_new"]
+        test_dir = self.root / "test"
+
+        self.assertEqual(graph.affected(folders, test_dir, "ctx"), (["test_new"], ["test_nav", "test_radio"]))
+        self.assertEqual(graph.affected(folders, test_dir, "other")[0], folders)
+        self.assertEqual(graph.affected(folders, test_dir, "ctx", {self.radio_h})[0], ["test_radio", "test_new"])
+
+        os.utime(self.filter_h, ns=(0, 0))
+        _write(self.root / "test" / "test_radio" / "extra.cpp", "")
+        self.assertEqual(graph.affected(folders, test_dir, "ctx")[0], folders)
+
+        graph.update("test_nav", {self.nav, self.filter_h}, STATUS_TEST_FAIL)
+        graph.save()
+        loaded = affected.DependencyGraph.load(self.root)
+        self.assertEqual(loaded.folders["test_radio"].files, graph.folders["test_radio"].files)
+        self.assertIn("test_nav", loaded.affected(["test_nav"], test_dir, "ctx")[0])
+
+    @unittest.skipUnless(shutil.which("git"), "needs git")
+    def test_changed_since_lists_modified_and_untracked_files(self):
+        def git(*args):
+            subprocess.run(["git", *args], cwd=self.root, check=True, capture_output=True)
+
+        git("init", "-q")
+        git("-c", "user.name=t", "-c", "user.email=t@t", "commit", "-q", "--allow-empty", "-m", "base")
+        git("add", "src/filter.h")
+        git("-c", "user.name=t", "-c", "user.email=t@t", "commit", "-q", "-m", "filter")
+        _write(self.filter_h, "#pragma once\n// changed\n")
+
+        changed = affected.changed_since(self.root, "HEAD")
+
+        self.assertIn(self.filter_h, changed)
+        self.assertIn(self.radio_h, changed)  # untracked
+        self.assertNotIn(self.root / "src", changed)
+        with self.assertRaises(ValueError):
+            affected.changed_since(self.root, "no-such-ref")
+
+    def test_runner_skips_folders_unaffected_since_last_run(self):
+        ran: list[str] = []
+
+        def fake_run(ctx, cmd, env=None):
+            folder = cmd[cmd.index("-f") + 1]
+            ran.append(folder)
+            self.assertIn(affected.DEPFILE_FLAG, env["PLATFORMIO_BUILD_FLAGS"])
+            source, header = (self.nav, self.filter_h) if folder == "test_nav" else (self.radio, self.radio_h)
+            _write(Path(env["PLATFORMIO_BUILD_DIR"]) / "native" / "test_main.d", f"test_main.o: {source} {header}\n")
+            return 0, "1 test cases: 1 succeeded", 0.1
+
+        toolchain = SimpleNamespace(errors=[], platformio_cmd=["pio"], cpp_compiler=None)
+        options = runner.TestRunnerOptions(self.root, no_progress=True, no_install=True, no_builds=True)
+        with mock.patch.object(runner, "check_toolchain", return_value=toolchain), mock.patch.object(
+            runner, "_run_command", fake_run
+        ), mock.patch("builtins.print"):
+            runner.run_tests(options)
+            self.assertEqual(sorted(ran), ["test_nav", "test_radio"])
+
+            ran.clear()
+            _write(self.filter_h, "#pragma once\n// a bigger change\n")
+            runner.run_tests(options)
+            self.assertEqual(ran, ["test_nav"])
+
+            ran.clear()
+            options.run_all = True
+            runner.run_tests(options)
+            self.assertEqual(sorted(ran), ["test_nav", "test_radio"])
+
+    def test_shared_archive_change_affects_every_folder(self):
+        ran: list[str] = []
+
+        def fake_run(ctx, cmd, env=None):
+            folder = cmd[cmd.index("-f") + 1]
+            ran.append(folder)
+            source = self.nav if folder == "test_nav" else self.radio
+            _write(Path(env["PLATFORMIO_BUILD_DIR"]) / "native" / "test_main.d", f"test_main.o: {source}\n")
+            return 0, "1 test cases: 1 succeeded", 0.1
+
+        # A header only the library sources include changes the archive key and nothing else.
+        shared = SharedBuild(self.root / "libastra.a", "key-1", [])
+        toolchain = SimpleNamespace(errors=[], platformio_cmd=["pio"], cpp_compiler="g++")
+        options = runner.TestRunnerOptions(
+            self.root, no_progress=True, no_install=True, no_builds=True, shared_cache=True
+        )
+        with mock.patch.object(runner, "check_toolchain", return_value=toolchain), mock.patch.object(
+            runner, "_run_command", fake_run
+        ), mock.patch.object(runner, "_prepare_shared_build", lambda ctx: shared), mock.patch("builtins.print"):
+            runner.run_tests(options)
+            ran.clear()
+            runner.run_tests(options)
+            self.assertEqual(ran, [])
+
+            shared.key = "key-2"
+            runner.run_tests(options)
+            self.assertEqual(sorted(ran), ["test_nav", "test_radio"])
+
+
+if __name__ == "__main__":
+    unittest.main()
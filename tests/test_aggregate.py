@@ -0,0 +1,247 @@
+from __future__ import annotations
+
+import shutil
+import subprocess
+import tempfile
+import unittest
+from pathlib import Path
+
+from astra_support.testing import aggregate
+from astra_support.testing.analyze import STATUS_PASS, STATUS_SYSTEM_ERR, STATUS_TEST_FAIL
+
+# Just enough of Unity for the generated program to compile and report.
+UNITY_STUB = """\
+#ifndef UNITY_H
+#define UNITY_H
+#include <stdio.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+void setUp(void);
+void tearDown(void);
+void UnityDefaultTestRun(void (*fn)(void));
+#ifdef __cplusplus
+}
+#endif
+static int unity_tests, unity_failures;
+#define UNITY_BEGIN() (unity_tests = 0, unity_failures = 0)
+#define UNITY_END() (printf("%d Tests %d Failures 0 Ignored\\n", unity_tests, unity_failures), unity_failures)
+#define RUN_TEST(fn) (unity_tests++, UnityDefaultTestRun(fn))
+#define TEST_ASSERT_EQUAL(expected, actual) \\
+    do { if ((expected) != (actual)) { unity_failures++; printf("%s:%d:%s:FAIL: Expected %d\\n", __FILE__, __LINE__, __func__, (expected)); } } while (0)
+#endif
+"""
+
+# As in Unity, setUp and tearDown are called from the library, not the suite.
+UNITY_SOURCE = """\
+#include <unity.h>
+void UnityDefaultTestRun(void (*fn)(void)) { setUp(); fn(); tearDown(); }
+"""
+
+PASSING = """\
+#include <unity.h>
+#include "helper.h"
+int counter = 0;
+static int set_ups = 0;
+void setUp(void) { set_ups++; }
+void tearDown(void) {}
+static void test_helper(void) { TEST_ASSERT_EQUAL(3, helper_value() + set_ups - 1); }
+static void test_counter(void) { TEST_ASSERT_EQUAL(0, counter++); }
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_helper);
+    RUN_TEST(test_counter);
+    UNITY_END();
+}
+"""
+
+FAILING = """\
+#include <unity.h>
+static int counter = 0;
+void astraSuiteReset() { counter = 0; }
+static void test_fails(void) { TEST_ASSERT_EQUAL(1, counter); }
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_fails);
+    return UNITY_END();
+}
+"""
+
+
+# Non-static names the aggregate does not rename; two folders defining them cannot link together.
+CLASHING = """\
+#include <unity.h>
+int init_calls = 0;
+void test_init(void) { init_calls++; }
+static void test_runs(void) { test_init(); TEST_ASSERT_EQUAL(1, init_calls); }
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_runs);
+    return UNITY_END();
+}
+"""
+
+# Same-named in-class members link silently and the linker keeps one body for both suites.
+# shared_count() comes from a header outside the test folders and is the same everywhere.
+FAKE_SENSOR = """\
+#include <unity.h>
+#include "../../lib/shared.h"
+struct FakeSensor {{ int value() {{ return {body}; }} }};
+static void test_value(void) {{ FakeSensor sensor; TEST_ASSERT_EQUAL({expected}, sensor.value()); }}
+static void test_shared(void) {{ TEST_ASSERT_EQUAL(1, shared_count()); }}
+int main() {{
+    UNITY_BEGIN();
+    RUN_TEST(test_value);
+    RUN_TEST(test_shared);
+    return UNITY_END();
+}}
+"""
+
+
+def _write(path: Path, text: str) -> None:
+    path.parent.mkdir(parents=True, exist_ok=True)
+    path.write_text(text, encoding="utf-8")
+
+
+class AggregateTests(unittest.TestCase):
+    def setUp(self):
+        self._tmp = tempfile.TemporaryDirectory()
+        self.addCleanup(self._tmp.cleanup)
+        self.root = Path(self._tmp.name)
+        self.test_dir = self.root / "test"
+        _write(self.test_dir / "test_passing" / "test_main.cpp", PASSING)
+        _write(self.test_dir / "test_passing" / "helper.h", "inline int helper_value() { return 3; }\n")
+        _write(self.test_dir / "test_failing" / "test_main.cpp", FAILING)
+        _write(self.test_dir / "test_nomain" / "test_main.cpp", "void setup() {}\nvoid loop() {}\n")
+
+    def test_plan_skips_folders_without_main(self):
+        plan = aggregate.generate_aggregate(
+            self.test_dir, ["test_passing", "test_failing", "test_nomain"], self.root / "out"
+        )
+
+        self.assertEqual(plan.suites, ["test_failing", "test_passing"])
+        self.assertEqual(plan.skipped, {"test_nomain": "no main()"})
+        patched = list((self.root / "out" / aggregate.AGGREGATE_SUITE / "patched").iterdir())
+        self.assertEqual([path.name for path in patched], ["test_passing_test_main.inc"])
+        self.assertIn("return 0;", patched[0].read_text(encoding="utf-8"))
+
+    def test_split_output_marks_unfinished_suites(self):
+        output = (
+            "::astra-suite-begin test_a\n1 Tests 0 Failures 0 Ignored\n::astra-suite-end test_a 0 1500\n"
+            "::astra-suite-begin test_b\ncrashed here\n"
+        )
+
+        results = {result.name: result for result in aggregate.suite_results(["test_a", "test_b", "test_c"], output)}
+
+        self.assertEqual((results["test_a"].status, results["test_a"].test_count), (STATUS_PASS, 1))
+        self.assertEqual(results["test_a"].duration, 1.5)
+        self.assertEqual(results["test_b"].status, STATUS_SYSTEM_ERR)
+        self.assertEqual(results["test_c"].status, STATUS_SYSTEM_ERR)
+
+    def test_symbol_clashes_name_the_folders_from_linker_output(self):
+        wrappers = {"astra_suite_test_a_0_test_main": "test_a", "astra_suite_test_b_0_test_main": "test_b"}
+        gnu_ld = (
+            "/usr/bin/ld: .pio/build/native/test/astra_suite_test_b_0_test_main.cpp.o: in function `test_init()':\n"
+            "test_main.cpp:(.text+0x0): multiple definition of `test_init()'; "
+            ".pio/build/native/test/astra_suite_test_a_0_test_main.cpp.o:test_main.cpp:(.text+0x0): first defined here\n"
+            "collect2: error: ld returned 1 exit status\n"
+        )
+        lld = (
+            "ld.lld: error: duplicate symbol: init_calls\n"
+            ">>> defined at test_main.cpp\n>>>            astra_suite_test_a_0_test_main.o:(init_calls)\n"
+            ">>> defined at test_main.cpp\n>>>            astra_suite_test_b_0_test_main.o:(.bss+0x0)\n"
+        )
+
+        self.assertEqual(set(aggregate.symbol_clashes(gnu_ld, wrappers)), {"test_a", "test_b"})
+        self.assertIn("test_init()", aggregate.symbol_clashes(gnu_ld, wrappers)["test_a"])
+        self.assertIn("init_calls", aggregate.symbol_clashes(lld, wrappers)["test_b"])
+        self.assertEqual(aggregate.symbol_clashes("undefined reference to `x'\n", wrappers), {})
+        self.assertEqual(aggregate.wrapper_stem("build/astra_suite_test_a_0_test_main.cpp.d"), "astra_suite_test_a_0_test_main")
+
+    def _build(self, plan: aggregate.AggregatePlan) -> tuple[subprocess.CompletedProcess, Path]:
+        suite_dir = plan.test_dir / aggregate.AGGREGATE_SUITE
+        _write(self.root / "unity" / "unity.h", UNITY_STUB)
+        _write(self.root / "unity" / "unity.cpp", UNITY_SOURCE)
+        program = self.root / "program"
+        objects = []
+        for source in [*sorted(suite_dir.glob("*.cpp")), self.root / "unity" / "unity.cpp"]:
+            # Named like PlatformIO's objects, which the clash parser maps back to folders.
+            target = self.root / "objects" / f"{source.name}.o"
+            target.parent.mkdir(exist_ok=True)
+            subprocess.run(["g++", "-std=c++17", f"-I{self.root / 'unity'}", "-c", str(source), "-o", str(target)], check=True)
+            objects.append(str(target))
+        build = subprocess.run(
+            ["g++", *objects, "-o", str(program)], stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True
+        )
+        return build, program
+
+    @unittest.skipUnless(shutil.which("g++"), "needs g++")
+    def test_folders_sharing_a_global_run_on_their_own(self):
+        _write(self.test_dir / "test_clash_a" / "test_main.cpp", CLASHING)
+        _write(self.test_dir / "test_clash_b" / "test_main.cpp", CLASHING)
+        folders = ["test_passing", "test_clash_a", "test_clash_b"]
+        plan = aggregate.generate_aggregate(self.test_dir, folders, self.root / "out")
+
+        build, _ = self._build(plan)
+        self.assertNotEqual(build.returncode, 0)
+        clashes = aggregate.symbol_clashes(build.stdout, plan.wrappers)
+        self.assertEqual(set(clashes), {"test_clash_a", "test_clash_b"}, build.stdout)
+
+        plan = aggregate.generate_aggregate(self.test_dir, folders, self.root / "out", skip=clashes)
+        build, program = self._build(plan)
+        self.assertEqual(build.returncode, 0, build.stdout)
+        self.assertEqual(plan.suites, ["test_passing"])
+        self.assertEqual(set(plan.skipped), {"test_clash_a", "test_clash_b"})
+
+    @unittest.skipUnless(shutil.which("g++"), "needs g++")
+    def test_folders_defining_an_inline_member_differently_run_on_their_own(self):
+        _write(self.root / "lib" / "shared.h", "inline int shared_count() { static int calls; return ++calls; }\n")
+        _write(self.test_dir / "test_a" / "test_main.cpp", FAKE_SENSOR.format(body="1", expected=1))
+        _write(self.test_dir / "test_b" / "test_main.cpp", FAKE_SENSOR.format(body="1 / 2", expected=0))
+        folders = ["test_passing", "test_a", "test_b"]
+        plan = aggregate.generate_aggregate(self.test_dir, folders, self.root / "out")
+
+        build, program = self._build(plan)
+        self.assertEqual(build.returncode, 0, build.stdout)
+        runs = [subprocess.run([str(program), "--suite", suite], stdout=subprocess.PIPE) for suite in ("test_a", "test_b")]
+        self.assertEqual(sorted(run.returncode for run in runs), [0, 1])
+        clashes = aggregate.inline_clashes(sorted((self.root / "objects").glob("*.o")), plan.wrappers)
+        self.assertEqual(set(clashes), {"test_a", "test_b"})
+        self.assertIn("value", clashes["test_a"])
+
+        plan = aggregate.generate_aggregate(self.test_dir, folders, self.root / "out", skip=clashes)
+        build, program = self._build(plan)
+        self.assertEqual(build.returncode, 0, build.stdout)
+        self.assertEqual(plan.suites, ["test_passing"])
+        self.assertEqual(aggregate.inline_clashes(sorted((self.root / "objects").glob("*.o")), plan.wrappers), {})
+
+    @unittest.skipUnless(shutil.which("g++"), "needs g++")
+    def test_inline_definitions_from_a_shared_header_do_not_clash(self):
+        _write(self.root / "lib" / "shared.h", "inline int shared_count() { static int calls; return ++calls; }\n")
+        _write(self.test_dir / "test_a" / "test_main.cpp", FAKE_SENSOR.format(body="1", expected=1))
+        _write(self.test_dir / "test_b" / "test_main.cpp", FAKE_SENSOR.format(body="1", expected=1))
+        plan = aggregate.generate_aggregate(self.test_dir, ["test_a", "test_b"], self.root / "out")
+
+        build, _ = self._build(plan)
+        self.assertEqual(build.returncode, 0, build.stdout)
+        self.assertEqual(aggregate.inline_clashes(sorted((self.root / "objects").glob("*.o")), plan.wrappers), {})
+
+    @unittest.skipUnless(shutil.which("g++"), "needs g++")
+    def test_program_runs_suites_in_shards(self):
+        plan = aggregate.generate_aggregate(self.test_dir, ["test_passing", "test_failing"], self.root / "out")
+        build, program = self._build(plan)
+        self.assertEqual(build.returncode, 0, build.stdout)
+
+        listed = subprocess.run([str(program), "--list"], stdout=subprocess.PIPE, text=True).stdout
+        self.assertEqual(listed.split(), ["test_failing", "test_passing"])
+        shards = [subprocess.run([str(program), "--shard", f"{i}/2"], stdout=subprocess.PIPE, text=True) for i in range(2)]
+        self.assertEqual([run.returncode for run in shards], [1, 0])
+
+        results = {r.name: r for r in aggregate.suite_results(plan.suites, "\n".join(run.stdout for run in shards))}
+        self.assertEqual(results["test_failing"].status, STATUS_TEST_FAIL)
+        self.assertIn("test_fails:FAIL", results["test_failing"].log)
+        self.assertEqual((results["test_passing"].status, results["test_passing"].test_count), (STATUS_PASS, 2))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -22,6 +22,15 @@ class CliTests(unittest.TestCase):
         self.assertEqual(args.mode, "sitl")
         self.assertEqual(args.source, "physics")
 
+    def test_sim_link_command_parses(self):
+        parser = cli.build_parser()
+        args = parser.parse_args(["sim", "link", "--bandwidth", "57600", "--loss", "0.02", "--seed", "3"])
+        self.assertEqual(args.sim_command, "link")
+        self.assertEqual(args.a_port, 5601)
+        self.assertEqual(args.bandwidth, 57600.0)
+        self.assertEqual(args.seed, 3)
+        self.assertIs(args.func, cli.sim_cmd.link)
+
     def test_compat_sitl_does_not_mutate_namespace(self):
         args = argparse.Namespace(
             project=".",
@@ -0,0 +1,100 @@
+from __future__ import annotations
+
+import math
+import tempfile
+import unittest
+from pathlib import Path
+
+import numpy as np
+
+from astra_support.sim import columnar
+
+
+class ColumnarTests(unittest.TestCase):
+    def test_round_trips_decimal_float_and_string_columns(self):
+        columns = {
+            "State - Time (s)": [0.0, 0.271, 0.542, 0.813],
+            "State - Flight Stage": [0, 0, 1, 2],
+            "State - PZ (m)": [0.831, -150.869, math.nan, 12.5],
+            "MAX-M10S - Time": ["00:00:00", "13:23:53", "13:23:53", "13:23:54"],
+        }
+
+        with tempfile.TemporaryDirectory() as tmpdir:
+            path = Path(tmpdir) / "telem.acol"
+            columnar.write_columnar_log(path, columns)
+            loaded = columnar.read_columnar_log(path)
+
+        self.assertEqual(list(loaded), list(columns))
+        np.testing.assert_array_equal(loaded["State - Time (s)"], columns["State - Time (s)"])
+        self.assertEqual(loaded["State - Flight Stage"].dtype, np.int64)
+        np.testing.assert_array_equal(loaded["State - Flight Stage"], [0, 0, 1, 2])
+        np.testing.assert_array_equal(loaded["State - PZ (m)"], columns["State - PZ (m)"])
+        self.assertEqual(list(loaded["MAX-M10S - Time"]), columns["MAX-M10S - Time"])
+
+    def test_reads_hand_encoded_native_block(self):
+        # Header with one column "t", then a two-row decimal block at scale 3:
+        # 1.250 -> 1250 (zigzag 2500), 1.300 -> delta 50 (zigzag 100).
+        payload = bytes([0xC4, 0x13, 0x64])
+        raw = b"ASTRACOL" + bytes([1, 1, 1]) + b"t" + bytes([2, 1, 3, len(payload)]) + payload
+
+        with tempfile.TemporaryDirectory() as tmpdir:
+            path = Path(tmpdir) / "native.acol"
+            path.write_bytes(raw)
+            loaded = columnar.read_columnar_log(path)
+
+        np.testing.assert_allclose(loaded["t"], [1.25, 1.3])
+
+    def test_truncated_tail_keeps_complete_blocks(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            path = Path(tmpdir) / "crashed.acol"
+            with columnar.ColumnarLogWriter(path, ["t", "name"], block_rows=2) as writer:
+                for index in range(5):
+                    writer.append_row([index * 0.5, f"row{index}"])
+            raw = path.read_bytes()
+            lengths = set()
+            for cut in range(1, 12):
+                path.write_bytes(raw[:-cut])
+                loaded = columnar.read_columnar_log(path)
+                np.testing.assert_array_equal(loaded["t"], [0.0, 0.5, 1.0, 1.5][: len(loaded["t"])])
+                lengths.add(len(loaded["t"]))
+
+            self.assertEqual(lengths, {4})
+
+    def test_empty_file_has_no_columns(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            path = Path(tmpdir) / "never_logged.acol"
+            path.write_bytes(b"")
+
+            self.assertEqual(columnar.read_columnar_log(path), {})
+
+    def test_truncated_header_has_no_columns(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            path = Path(tmpdir) / "cut_header.acol"
+            with columnar.ColumnarLogWriter(path, ["time_s", "altitude_m"]):
+                pass
+            raw = path.read_bytes()
+            for cut in range(1, len(raw)):
+                path.write_bytes(raw[:cut])
+                self.assertEqual(columnar.read_columnar_log(path), {}, cut)
+
+            path.write_bytes(raw)
+            self.assertEqual(list(columnar.read_columnar_log(path)), ["time_s", "altitude_m"])
+
+    def test_negative_zero_keeps_its_sign(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            path = Path(tmpdir) / "signed_zero.acol"
+            columnar.write_columnar_log(path, {"v": [0.5, -0.0, 1.0]})
+            loaded = columnar.read_columnar_log(path)
+
+        np.testing.assert_array_equal(np.signbit(loaded["v"]), [False, True, False])
+
+    def test_blocks_widen_integer_column_to_float(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            path = Path(tmpdir) / "widen.acol"
+            with columnar.ColumnarLogWriter(path, ["v"], block_rows=2) as writer:
+                for value in (1, 2, 2.5, 3):
+                    writer.append_row([value])
+            loaded = columnar.read_columnar_log(path)
+
+        self.assertEqual(loaded["v"].dtype, np.float64)
+        np.testing.assert_array_equal(loaded["v"], [1.0, 2.0, 2.5, 3.0])
@@ -0,0 +1,134 @@
+from __future__ import annotations
+
+import contextlib
+import hashlib
+import io
+import os
+import tempfile
+import unittest
+from pathlib import Path
+
+import numpy as np
+
+from astra_support.sim import dataset_cache
+from astra_support.sim.sources import repo_root
+
+
+def _load(path: Path, **kwargs) -> dataset_cache.Dataset:
+    with contextlib.redirect_stdout(io.StringIO()):
+        return dataset_cache.load_dataset(path, **kwargs)
+
+
+class MatchColumnsTests(unittest.TestCase):
+    def test_unit_conversions_follow_header_names(self):
+        found = dataset_cache.match_columns(["# Time (s)", "Altitude (ft)", "Acc Z (g)", "Gyro X (deg/s)", "Temp (F)"])
+
+        self.assertEqual(found["time"].index, 0)
+        self.assertAlmostEqual(found["alt"].scale, 0.3048)
+        self.assertAlmostEqual(found["acc_z"].scale, 9.80665)
+        self.assertAlmostEqual(found["gyro_x"].scale, np.pi / 180.0)
+        temp = found["temp"]
+        self.assertEqual(dataset_cache.convert_units(212.0, temp.scale, temp.offset, temp.divisor), 100.0)
+
+    def test_fahrenheit_rounds_like_the_per_cell_formula(self):
+        readings = [71.3, 68.07, 55.55, -3.9, 101.21]
+        text = "time,altitude,Temp (F)\n" + "".join(f"{index},0,{value}\n" for index, value in enumerate(readings))
+
+        dataset = dataset_cache.parse_csv(text)
+
+        self.assertEqual(list(dataset.columns["temp"]), [(value - 32.0) * 5.0 / 9.0 for value in readings])
+
+
+class ParseCsvTests(unittest.TestCase):
+    def test_openrocket_rows_gain_gravity_and_defaults(self):
+        dataset = dataset_cache.parse_csv(
+            "# Time (s),Altitude (ft),Vertical acceleration (m/s²)\n0,0,0\n0.1,10,50\n"
+        )
+
+        self.assertTrue(dataset.is_openrocket)
+        np.testing.assert_allclose(dataset.columns["truth_alt"], [0.0, 3.048])
+        np.testing.assert_allclose(dataset.columns["acc_z"], [9.81, 59.81])
+        np.testing.assert_allclose(dataset.columns["lat"], [45.0, 45.0])
+        np.testing.assert_allclose(dataset.columns["gps_alt"], dataset.columns["truth_alt"])
+
+    def test_non_numeric_rows_are_dropped_and_short_rows_take_defaults(self):
+        dataset = dataset_cache.parse_csv("time,altitude,temp\n0,1,20\nbad,2,21\n0.2,3\n\n# note\n0.3,4,22\n")
+
+        np.testing.assert_allclose(dataset.columns["time"], [0.0, 0.2, 0.3])
+        np.testing.assert_allclose(dataset.columns["temp"], [20.0, 25.0, 22.0])
+
+    def test_missing_header_raises(self):
+        with self.assertRaises(ValueError):
+            dataset_cache.parse_csv("a,b\n1,2\n")
+
+
+class CacheTests(unittest.TestCase):
+    def test_second_load_maps_the_cache(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            csv_path = Path(tmpdir) / "demo.csv"
+            csv_path.write_text("time,altitude\n0,1\n0.5,2\n", encoding="utf-8")
+
+            first = _load(csv_path)
+            second = _load(csv_path)
+
+            self.assertIsNotNone(first.cache_path)
+            self.assertEqual(second.cache_path, first.cache_path)
+            self.assertIsNone(second.header_map)  # not re-parsed
+            self.assertIsInstance(second.columns["time"].base, np.memmap)
+            for name in dataset_cache.COLUMNS:
+                np.testing.assert_array_equal(first.columns[name], second.columns[name])
+
+    @unittest.skipIf(os.name == "nt", "POSIX permissions")
+    def test_cache_file_gets_umask_permissions(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            csv_path = Path(tmpdir) / "demo.csv"
+            csv_path.write_text("time,altitude\n0,1\n", encoding="utf-8")
+            previous = os.umask(0o022)
+            try:
+                cache_path = _load(csv_path).cache_path
+            finally:
+                os.umask(previous)
+
+            self.assertEqual(cache_path.stat().st_mode & 0o777, 0o644)
+
+    def test_changed_content_rebuilds_and_removes_stale_cache(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            csv_path = Path(tmpdir) / "demo.csv"
+            csv_path.write_text("time,altitude\n0,1\n", encoding="utf-8")
+            old = _load(csv_path).cache_path
+
+            csv_path.write_text("time,altitude\n0,7\n", encoding="utf-8")
+            new = _load(csv_path)
+
+            self.assertNotEqual(new.cache_path, old)
+            self.assertFalse(old.exists())
+            self.assertEqual(list(Path(tmpdir).glob("*.astracache")), [new.cache_path])
+            np.testing.assert_allclose(new.columns["truth_alt"], [7.0])
+
+    def test_corrupt_cache_is_rebuilt(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            csv_path = Path(tmpdir) / "demo.csv"
+            csv_path.write_text("time,altitude\n0,1\n", encoding="utf-8")
+            cache_path = _load(csv_path).cache_path
+            cache_path.write_bytes(b"ASTRADSC")
+
+            reloaded = _load(csv_path)
+
+            np.testing.assert_allclose(reloaded.columns["truth_alt"], [1.0])
+            self.assertGreater(cache_path.stat().st_size, 64)
+
+
+class ManifestTests(unittest.TestCase):
+    def test_bundled_manifest_hashes_match_files(self):
+        manifest = repo_root() / "datasets" / "astra-rocket" / "manifest.yaml"
+        entries = dataset_cache.read_manifest(manifest)
+
+        self.assertTrue(entries)
+        for entry in entries:
+            path = manifest.parent / entry["path"]
+            self.assertEqual(entry.get("sha256"), hashlib.sha256(path.read_bytes()).hexdigest(), entry["id"])
+            self.assertEqual(dataset_cache.manifest_sha256(path), entry["sha256"])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -2,10 +2,26 @@ from __future__ import annotations
 
 import csv
 import tempfile
+import math
 import unittest
 from pathlib import Path
 
-from astra_support.sim.logging import write_sim_log
+import numpy as np
+
+from astra_support.sim.columnar import read_columnar_log
+from astra_support.sim.history import HistoryStore, derive_series_rate
+from astra_support.sim.logging import SimLogWriter, write_sim_log
+
+
+def _record(index: int) -> dict[str, object]:
+    return {
+        "time": index * 0.5,
+        "sim_alt": float(index * index),
+        "sensor_alt_agl_m": float(index),
+        "sim_acc_mps2": float("nan"),
+        "sensor_acc_z_mps2": 9.81,
+        "fc_values": [str(index), "COAST"],
+    }
 
 
 class LoggingTests(unittest.TestCase):
@@ -35,3 +51,76 @@ class LoggingTests(unittest.TestCase):
         self.assertEqual(float(rows[1][4]), 1.0)
         self.assertEqual(float(rows[1][5]), 0.9)
         self.assertEqual(rows[1][6], "A")
+
+    def test_sim_log_writer_flushes_chunks_during_the_run(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            log_path = Path(tmpdir) / "sim.csv"
+            writer = SimLogWriter(log_path, ["FC_Time", "FC_Stage"], chunk_rows=4)
+            for index in range(10):
+                writer.append(_record(index))
+            on_disk_before_close = log_path.read_text(encoding="utf-8").splitlines()
+            writer.close()
+            with log_path.open("r", encoding="utf-8", newline="") as handle:
+                rows = list(csv.reader(handle))
+
+        self.assertEqual(len(on_disk_before_close), 1 + 8)
+        self.assertEqual(len(rows), 1 + 10)
+        # The first row takes the second row's velocity; acceleration is derived from velocity.
+        self.assertEqual([float(row[3]) for row in rows[1:4]], [2.0, 2.0, 6.0])
+        self.assertEqual([float(row[4]) for row in rows[1:4]], [0.0, 0.0, 8.0])
+        self.assertEqual(rows[-1][6:], ["9", "COAST"])
+
+    def test_sim_log_writer_columnar_format(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            log_path = Path(tmpdir) / "sim.astracol"
+            with SimLogWriter(log_path, [], fmt="columnar", chunk_rows=3) as writer:
+                for index in range(5):
+                    writer.append(_record(index))
+            columns = read_columnar_log(log_path)
+
+        self.assertEqual(list(columns["Sim_Time"]), [0.0, 0.5, 1.0, 1.5, 2.0])
+        self.assertEqual(list(columns["Sim_Vel_Z_mps"]), [2.0, 2.0, 6.0, 10.0, 14.0])
+        self.assertEqual(list(columns["FC_Raw_Data"]), [f"{index},COAST" for index in range(5)])
+
+
+class HistoryStoreTests(unittest.TestCase):
+    def test_store_stays_bounded_and_spans_the_run(self):
+        store = HistoryStore(capacity=100, chunk_rows=16)
+        for index in range(10000):
+            store.append({"time": float(index), "fc_stage": "BOOST" if index == 4321 else "COAST"}, keep=index == 4321)
+
+        self.assertEqual(store.count, 10000)
+        self.assertLess(len(store), 100)
+        self.assertEqual(store["time"][0], 0.0)
+        self.assertGreater(store["time"][-1], 9800.0)
+        self.assertIn(4321.0, store["time"])
+        self.assertTrue(np.all(np.diff(store["time"]) > 0))
+        self.assertEqual(store["fc_stage"][list(store["time"]).index(4321.0)], "BOOST")
+
+    def test_forced_rows_are_thinned_once_they_crowd_the_store(self):
+        store = HistoryStore(capacity=8, chunk_rows=4)
+        for index in range(20):
+            store.append({"time": float(index), "fc_stage": "BOOST" if index % 2 else "COAST"}, keep=True)
+
+        self.assertEqual(store.count, 20)
+        self.assertLess(len(store), 8)
+        self.assertEqual(store["time"][0], 0.0)
+        self.assertTrue(np.all(np.diff(store["time"]) > 0))
+
+    def test_columns_are_typed_with_nan_for_missing_values(self):
+        store = HistoryStore()
+        store.append({"time": 0.0, "sim_alt": 5, "fc_alt": None, "fc_stage": "unknown"})
+        store.append({"time": 0.5, "sim_alt": 7.5, "fc_alt": 2.0, "fc_stage": "BOOST"})
+
+        self.assertEqual(store["time"].dtype, np.float64)
+        self.assertEqual(list(store["sim_alt"]), [5.0, 7.5])
+        self.assertTrue(math.isnan(store["fc_alt"][0]))
+        self.assertTrue(math.isnan(store["fc_mach"][1]))
+        self.assertEqual(list(store["fc_stage"]), ["", "BOOST"])
+        self.assertEqual(store.stages, ["BOOST"])
+
+    def test_derive_series_rate(self):
+        rate = derive_series_rate([0.0, 1.0, 1.0, 3.0], [0.0, 2.0, 5.0, float("nan")])
+
+        self.assertEqual(rate[:2].tolist(), [2.0, 2.0])
+        self.assertTrue(np.isnan(rate[2:]).all())  # zero dt, then a missing sample
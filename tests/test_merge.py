@@ -0,0 +1,83 @@
+from __future__ import annotations
+
+import contextlib
+import io
+import tempfile
+import unittest
+from pathlib import Path
+
+from astra_support.sim import data_sources, merge
+from astra_support.sim.sources import repo_root, source_kind
+
+
+def _write(path: Path, text: str) -> Path:
+    path.write_text(text, encoding="utf-8")
+    return path
+
+
+class MergeStreamTests(unittest.TestCase):
+    def test_union_of_timestamps_with_hold_and_linear_columns(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            fast = _write(Path(tmpdir) / "fast.csv", "t,a\n0,0\n1,10\n2,20\n3,30\n")
+            slow = _write(Path(tmpdir) / "slow.csv", "t,b,c\n0,100,5\n2,200,7\n")
+            samples = list(
+                merge.merge_streams(
+                    [
+                        merge.MergeInput(fast, (merge.ColumnSpec("acc_z", "a"),), "t"),
+                        merge.MergeInput(
+                            slow,
+                            (merge.ColumnSpec("pres", "b"), merge.ColumnSpec("temp", "c", method=merge.HOLD)),
+                            "t",
+                        ),
+                    ]
+                )
+            )
+
+        self.assertEqual([sample.time for sample in samples], [0.0, 1.0, 2.0, 3.0])
+        self.assertEqual([sample.values["pres"] for sample in samples], [100.0, 150.0, 200.0, 200.0])
+        self.assertEqual([sample.values["temp"] for sample in samples], [5.0, 5.0, 7.0, 7.0])
+        self.assertEqual(samples[1].fresh, {"acc_z"})
+        self.assertEqual(samples[2].fresh, {"acc_z", "pres", "temp"})
+
+    def test_first_input_owns_shared_keys_and_bad_rows_are_skipped(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            first = _write(Path(tmpdir) / "first.csv", "t,a\n0,1\nx,9\n1,,\n")
+            second = _write(Path(tmpdir) / "second.csv", "t,a\n0.5,99\n")
+            samples = list(
+                merge.merge_streams(
+                    [
+                        merge.MergeInput(first, (merge.ColumnSpec("acc_z", "a", method=merge.HOLD),), "t"),
+                        merge.MergeInput(second, (merge.ColumnSpec("acc_z", "a"),), "t"),
+                    ]
+                )
+            )
+
+        # `second` has nothing left to provide, so it does not contribute timestamps.
+        self.assertEqual([(sample.time, sample.values["acc_z"]) for sample in samples], [(0.0, 1.0), (1.0, 1.0)])
+
+
+class MergedCSVSimTests(unittest.TestCase):
+    def test_blue_raven_flight_replays_at_both_rates(self):
+        raw = repo_root() / "datasets" / "astra-rocket" / "raw"
+        with contextlib.redirect_stdout(io.StringIO()):
+            sim = data_sources.MergedCSVSim([str(raw / "BR_HR_JAN.csv"), str(raw / "BR_LR_JAN.csv")])
+            first = sim.get_next_packet()
+            times = [first.timestamp]
+            fresh_imu = 0
+            while not sim.is_finished():
+                times.append(sim.get_next_packet().timestamp)
+                fresh_imu += "acc_z" in sim.fresh
+
+        self.assertEqual(times, sorted(times))
+        self.assertAlmostEqual(first.accel[2], 9.80665)  # 1 g along the rocket axis
+        self.assertAlmostEqual(times[0], -2.028)
+        self.assertAlmostEqual(times[-1], 72.78)
+        self.assertEqual(fresh_imu, 1322)
+
+    def test_plus_joined_sources_select_merge(self):
+        self.assertEqual(source_kind("BR_HR_JAN+BR_LR_JAN"), "merge")
+        self.assertEqual(source_kind("NyxORK"), "csv")
+
+
+if __name__ == "__main__":
+    unittest.main()
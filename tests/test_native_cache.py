@@ -0,0 +1,102 @@
+from __future__ import annotations
+
+import json
+import os
+import shutil
+import tempfile
+import unittest
+from pathlib import Path
+from unittest import mock
+
+from astra_support.testing import native_cache
+
+
+def _write(path: Path, text: str) -> None:
+    path.parent.mkdir(parents=True, exist_ok=True)
+    path.write_text(text, encoding="utf-8")
+
+
+def _make_project(root: Path) -> None:
+    _write(root / "platformio.ini", "[env:native]\nplatform = native\nbuild_flags =\n  -std=c++17\n  -DNATIVE=1\n  -lm\n")
+    libdeps = root / ".pio" / "libdeps" / "native"
+    _write(
+        libdeps / "Core" / "library.json",
+        json.dumps({"name": "CoreLib", "platforms": "native", "build": {"srcFilter": ["+<*>", "-<skip/>"]}}),
+    )
+    _write(libdeps / "Core" / "src" / "core.h", "int core_value();\n")
+    _write(
+        libdeps / "Core" / "src" / "core.cpp",
+        '#include "core.h"\n#ifndef PIO_UNIT_TESTING\n#error built without the pio test defines\n#endif\n'
+        "int core_value() { return NATIVE; }\n",
+    )
+    _write(libdeps / "Core" / "src" / "skip" / "broken.cpp", "this does not compile\n")
+    # Uses CoreLib's header, as native-support uses the Astra library's.
+    _write(libdeps / "User" / "library.properties", "name=User\n")
+    _write(libdeps / "User" / "src" / "user.cpp", '#include "core.h"\nint user_value() { return core_value() + 1; }\n')
+    _write(libdeps / "Board" / "library.json", json.dumps({"name": "BoardOnly", "platforms": "teensy"}))
+    _write(libdeps / "Board" / "src" / "board.cpp", "#error not for native\n")
+
+
+class NativeCacheTests(unittest.TestCase):
+    def setUp(self):
+        self._tmp = tempfile.TemporaryDirectory()
+        self.root = Path(self._tmp.name) / "project"
+        _make_project(self.root)
+        self.cache = Path(self._tmp.name) / "cache"
+        patcher = mock.patch.dict(os.environ, {native_cache.CACHE_ROOT_ENV: str(self.cache)})
+        patcher.start()
+        os.environ.pop("PLATFORMIO_BUILD_FLAGS", None)
+        self.addCleanup(patcher.stop)
+        self.addCleanup(self._tmp.cleanup)
+
+    def test_finds_native_libraries_with_their_source_filters(self):
+        libraries = native_cache.find_native_libraries(native_cache.libdeps_dir(self.root, "native"))
+
+        self.assertEqual([library.name for library in libraries], ["CoreLib", "User"])
+        self.assertEqual([path.name for path in libraries[0].sources], ["core.cpp"])
+        self.assertEqual(native_cache.env_build_flags(self.root, "native"), ["-std=c++17", "-DNATIVE=1"])
+
+    def test_key_follows_headers_and_flags(self):
+        libraries = native_cache.find_native_libraries(native_cache.libdeps_dir(self.root, "native"))
+        key = native_cache.build_key("g++", ["-DNATIVE=1"], libraries)
+
+        self.assertEqual(key, native_cache.build_key("g++", ["-DNATIVE=1"], libraries))
+        self.assertNotEqual(key, native_cache.build_key("g++", ["-DNATIVE=2"], libraries))
+        _write(libraries[0].src_dir / "core.h", "int core_value(); // changed\n")
+        self.assertNotEqual(key, native_cache.build_key("g++", ["-DNATIVE=1"], libraries))
+
+    def test_sources_get_the_pio_test_defines(self):
+        self.assertEqual(
+            native_cache.test_build_defines("6.1.18"), ["-DPIO_UNIT_TESTING", "-DUNIT_TEST", "-DPLATFORMIO=60118"]
+        )
+        self.assertEqual(native_cache.test_build_defines(None), ["-DPIO_UNIT_TESTING", "-DUNIT_TEST"])
+
+    @unittest.skipUnless(shutil.which("g++") and shutil.which("ar"), "needs g++ and ar")
+    def test_archive_is_built_once_and_reused(self):
+        shared, log = native_cache.prepare_shared_build(self.root, "native", "g++")
+        self.assertIsNotNone(shared, log)
+        self.assertFalse(shared.cached)
+        self.assertTrue(shared.archive.is_file())
+        self.assertEqual(shared.lib_ignore(), ["CoreLib", "User"])
+        self.assertIn(f"-l{native_cache.ARCHIVE_NAME}", shared.build_flags())  # core.cpp saw PIO_UNIT_TESTING
+
+        again, _ = native_cache.prepare_shared_build(self.root, "native", "g++")
+        self.assertTrue(again.cached)
+        self.assertEqual(again.archive, shared.archive)
+
+        newer, _ = native_cache.prepare_shared_build(self.root, "native", "g++", platformio_version="6.1.18")
+        self.assertNotEqual(newer.key, shared.key)
+
+    @unittest.skipUnless(shutil.which("g++") and shutil.which("ar"), "needs g++ and ar")
+    def test_compile_error_falls_back(self):
+        _write(self.root / ".pio" / "libdeps" / "native" / "User" / "src" / "bad.cpp", "int broken(\n")
+
+        shared, log = native_cache.prepare_shared_build(self.root, "native", "g++")
+
+        self.assertIsNone(shared)
+        self.assertIn("bad.cpp", log)
+        self.assertEqual([path.name for path in self.cache.iterdir()], [])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -4,6 +4,8 @@ import math
 import unittest
 from unittest import mock
 
+import numpy as np
+
 from astra_support.sim import plotting
 
 
@@ -39,3 +41,64 @@ class PlottingTests(unittest.TestCase):
         control_labels = [line.get_label() for line in fig.axes[-1].get_lines() if not line.get_label().startswith("_")]
         self.assertEqual(control_labels, ["Flap cmd", "Flap actual"])
         plotting.plt.close(fig)
+
+    def test_long_history_is_drawn_with_a_bounded_point_count(self):
+        time_values = np.arange(200000) * 0.001
+        stages = np.where(time_values < 123.4567, "BOOST", "COAST").astype(object)
+        history = {
+            "time": time_values,
+            "sim_alt": np.sin(time_values),
+            "fc_stage": stages,
+            "fc_flap_cmd_deg": np.where(time_values < 50.0, np.nan, 1.0),
+        }
+
+        with mock.patch.object(plotting.plt, "show"):
+            plotting.plot_history(history, source_name="long")
+
+        fig = plotting.plt.gcf()
+        budget = plotting.plot_points(fig)
+        altitude = fig.axes[0].get_lines()[0]
+        self.assertLessEqual(len(altitude.get_xdata()), budget + 2)
+        self.assertTrue(np.isin(time_values[123457], altitude.get_xdata()))  # first COAST sample
+        flap_x = next(line for line in fig.axes[-1].get_lines() if line.get_label() == "Flap cmd").get_xdata()
+        self.assertGreaterEqual(np.nanmin(flap_x), 50.0)
+        plotting.plt.close(fig)
+
+    def test_lttb_keeps_endpoints_and_peaks(self):
+        x = np.arange(10000, dtype=float)
+        y = np.zeros_like(x)
+        y[4321] = 100.0
+        y[8765] = -50.0
+
+        indices = plotting.lttb_indices(x, y, 100)
+
+        self.assertEqual(len(indices), 100)
+        self.assertEqual(indices[0], 0)
+        self.assertEqual(indices[-1], 9999)
+        self.assertIn(4321, indices)
+        self.assertIn(8765, indices)
+        self.assertTrue(np.all(np.diff(indices) > 0))
+
+    def test_decimation_keeps_gaps_for_missing_samples(self):
+        x = np.arange(1000, dtype=float)
+        y = np.where((x > 400) & (x < 600), np.nan, x)
+
+        dx, dy = plotting.decimate_series(x, y, 50)
+
+        self.assertEqual(int(np.isnan(dy).sum()), 1)
+        gap = int(np.flatnonzero(np.isnan(dy))[0])
+        self.assertLessEqual(dx[gap - 1], 400.0)
+        self.assertGreaterEqual(dx[gap + 1], 600.0)
+
+    def test_live_plot_stays_bounded(self):
+        with mock.patch.object(plotting.plt, "show"):
+            live = plotting.LivePlot(source_name="live", max_points=400, refresh_rows=100, draw_interval_s=math.inf)
+        for index in range(20000):
+            live.append({"time": index * 0.01, "sim_alt": float(index % 700), "fc_stage": "BOOST" if index < 5000 else "COAST"})
+        live.refresh()
+
+        self.assertLessEqual(max(len(line.get_xdata()) for line in live.lines), 400)
+        self.assertEqual(live.lines[0].get_xdata()[-1], 199.99)
+        stage_lines = [line for line in live.axes[0].get_lines() if line not in live.lines]
+        self.assertEqual([line.get_xdata()[0] for line in stage_lines], [0.0, 50.0])
+        live.close()
@@ -0,0 +1,156 @@
+from __future__ import annotations
+
+import random
+import socket
+import time
+import unittest
+
+from astra_support.sim.radio_link import GilbertElliott, LatencyHistogram, LinkImpairments, RadioLinkBroker
+
+
+class GilbertElliottTests(unittest.TestCase):
+    def test_seeded_channel_is_reproducible(self):
+        impairments = LinkImpairments(loss=0.05, burst_enter=0.1, burst_exit=0.3)
+        first = GilbertElliott(impairments, random.Random(7))
+        second = GilbertElliott(impairments, random.Random(7))
+        self.assertEqual([first.drop() for _ in range(500)], [second.drop() for _ in range(500)])
+
+    def test_bursts_cluster_losses(self):
+        channel = GilbertElliott(LinkImpairments(burst_enter=0.02, burst_exit=0.2), random.Random(3))
+        drops = [channel.drop() for _ in range(5000)]
+        runs = sum(1 for i in range(1, len(drops)) if drops[i] and drops[i - 1])
+        self.assertGreater(sum(drops), 0)
+        self.assertGreater(runs, sum(drops) // 2)
+
+
+class LatencyHistogramTests(unittest.TestCase):
+    def test_summary_stays_close_and_removal_adjusts_it(self):
+        histogram = LatencyHistogram()
+        values = [0.001 * i for i in range(1, 1001)]
+        for value in values:
+            histogram.add(value)
+
+        self.assertEqual(histogram.count, 1000)
+        self.assertAlmostEqual(histogram.mean(), sum(values) / 1000)
+        self.assertEqual(histogram.max_s, 1.0)
+        self.assertAlmostEqual(histogram.percentile(0.95), 0.951, delta=0.951 * 0.05)
+
+        histogram.add(5.0)
+        histogram.remove(5.0)
+        histogram.remove(0.5)
+        self.assertEqual(histogram.count, 999)
+        self.assertAlmostEqual(histogram.mean(), (sum(values) - 0.5) / 999)
+        self.assertEqual(histogram.max_s, 1.0)
+        histogram.remove(1.0)
+        self.assertAlmostEqual(histogram.max_s, 0.999, delta=0.999 * 0.05)
+
+    def test_max_packet_below_one_is_rejected(self):
+        with self.assertRaises(ValueError):
+            LinkImpairments(max_packet=0)
+
+
+class RadioLinkBrokerTests(unittest.TestCase):
+    def _connect(self, broker: RadioLinkBroker) -> tuple[socket.socket, socket.socket]:
+        a_port, b_port = broker.ports
+        side_a = socket.create_connection(("127.0.0.1", a_port), timeout=2.0)
+        side_b = socket.create_connection(("127.0.0.1", b_port), timeout=2.0)
+        deadline = time.monotonic() + 2.0
+        while not (broker.connected("a") and broker.connected("b")) and time.monotonic() < deadline:
+            time.sleep(0.01)
+        self.addCleanup(side_a.close)
+        self.addCleanup(side_b.close)
+        return side_a, side_b
+
+    def _read_lines(self, conn: socket.socket, count: int) -> list[bytes]:
+        data = b""
+        while data.count(b"\n") < count:
+            chunk = conn.recv(4096)
+            if not chunk:
+                break
+            data += chunk
+        return data.splitlines()
+
+    def test_forwards_lines_both_ways_in_order(self):
+        broker = RadioLinkBroker("127.0.0.1", 0, 0, seed=1).start()
+        self.addCleanup(broker.stop)
+        side_a, side_b = self._connect(broker)
+
+        side_a.sendall(b"".join(f"TELEM/{i}\n".encode() for i in range(50)))
+        side_b.sendall(b"CMD/ARM\n")
+
+        self.assertEqual(self._read_lines(side_b, 50), [f"TELEM/{i}".encode() for i in range(50)])
+        self.assertEqual(self._read_lines(side_a, 1), [b"CMD/ARM"])
+        stats = broker.stats()
+        self.assertEqual(stats["a->b"]["packets_delivered"], 50)
+        self.assertEqual(stats["b->a"]["packets_delivered"], 1)
+
+    def test_bandwidth_and_latency_delay_delivery(self):
+        impairments = LinkImpairments(bandwidth_bps=20000, latency_s=0.05)
+        broker = RadioLinkBroker("127.0.0.1", 0, 0, a_to_b=impairments).start()
+        self.addCleanup(broker.stop)
+        side_a, side_b = self._connect(broker)
+
+        payload = b"".join(b"x" * 99 + b"\n" for _ in range(10))  # 1000 bytes = 0.5 s at 20 kbit/s
+        started = time.monotonic()
+        side_a.sendall(payload)
+        self._read_lines(side_b, 10)
+        elapsed = time.monotonic() - started
+
+        self.assertGreaterEqual(elapsed, 0.5)
+        self.assertGreaterEqual(broker.stats()["a->b"]["latency_max_ms"], 500.0)
+
+    def test_loss_is_counted_and_seeded(self):
+        impairments = LinkImpairments(loss=0.3)
+        delivered = []
+        for _ in range(2):
+            broker = RadioLinkBroker("127.0.0.1", 0, 0, a_to_b=impairments, seed=42).start()
+            self.addCleanup(broker.stop)
+            side_a, side_b = self._connect(broker)
+            side_a.sendall(b"".join(f"{i}\n".encode() for i in range(200)))
+            deadline = time.monotonic() + 2.0
+            stats = broker.stats()["a->b"]
+            while stats["packets_lost"] + stats["packets_delivered"] < 200 and time.monotonic() < deadline:
+                time.sleep(0.01)
+                stats = broker.stats()["a->b"]
+            lines = self._read_lines(side_b, stats["packets_delivered"])
+            self.assertEqual(stats["packets_lost"] + stats["packets_delivered"], 200)
+            self.assertGreater(stats["packets_lost"], 20)
+            delivered.append(lines)
+        self.assertEqual(delivered[0], delivered[1])
+
+    def test_partial_packet_is_sent_after_idle_timeout(self):
+        broker = RadioLinkBroker("127.0.0.1", 0, 0, a_to_b=LinkImpairments(idle_flush_s=0.05)).start()
+        self.addCleanup(broker.stop)
+        side_a, side_b = self._connect(broker)
+
+        started = time.monotonic()
+        side_a.sendall(b"> ")
+
+        self.assertEqual(side_b.recv(16), b"> ")
+        self.assertGreaterEqual(time.monotonic() - started, 0.05)
+        self.assertEqual(broker.stats()["a->b"]["packets_delivered"], 1)
+
+    def test_side_that_stops_reading_does_not_stall_the_other_direction(self):
+        broker = RadioLinkBroker("127.0.0.1", 0, 0).start()
+        self.addCleanup(broker.stop)
+        a_port, b_port = broker.ports
+        side_a = socket.create_connection(("127.0.0.1", a_port), timeout=5.0)
+        self.addCleanup(side_a.close)
+        side_b = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        self.addCleanup(side_b.close)
+        side_b.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 4096)
+        side_b.settimeout(5.0)
+        side_b.connect(("127.0.0.1", b_port))
+        deadline = time.monotonic() + 2.0
+        while not (broker.connected("a") and broker.connected("b")) and time.monotonic() < deadline:
+            time.sleep(0.01)
+
+        # Far more than side B's socket buffers hold; B never reads it.
+        side_a.sendall((b"x" * 254 + b"\n") * 32768)
+        side_b.sendall(b"CMD/ARM\n")
+
+        self.assertEqual(self._read_lines(side_a, 1), [b"CMD/ARM"])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,83 @@
+from __future__ import annotations
+
+import unittest
+
+import numpy as np
+
+from astra_support.sim import data_sources, session
+from astra_support.sim.sensor_rates import SensorScheduler, parse_sensor_rates
+
+
+def _packet(timestamp: float) -> data_sources.PacketData:
+    return data_sources.PacketData(
+        timestamp=timestamp,
+        accel=np.array([0.0, 0.0, 9.81]),
+        gyro=np.zeros(3),
+        mag=np.array([20.0, 0.0, 40.0]),
+        pressure=1013.25,
+        temp=25.0,
+        lat=45.0,
+        lon=-122.0,
+        alt=10.0,
+        fix=1,
+        sats=8,
+        heading=0.0,
+    )
+
+
+class SensorRateTests(unittest.TestCase):
+    def test_parse_sensor_rates(self):
+        self.assertIsNone(parse_sensor_rates(None))
+        self.assertEqual(parse_sensor_rates("default"), {"imu": 1000.0, "baro": 50.0, "gps": 10.0})
+        self.assertEqual(parse_sensor_rates("baro=25, gps=0"), {"imu": 1000.0, "baro": 25.0, "gps": 0.0})
+        with self.assertRaises(ValueError):
+            parse_sensor_rates("lidar=5")
+
+    def test_each_sensor_is_sent_at_its_own_rate(self):
+        scheduler = SensorScheduler({"imu": 1000.0, "baro": 50.0, "gps": 10.0})
+        for step in range(1000):  # one second of a 1 kHz source
+            scheduler.due(step * 0.001)
+
+        self.assertEqual(scheduler.sent, {"imu": 1000, "baro": 50, "gps": 10})
+
+    def test_slow_source_sends_fast_sensors_every_packet(self):
+        scheduler = SensorScheduler({"imu": 1000.0, "gps": 10.0})
+        due = [scheduler.due(step * 0.02) for step in range(10)]
+
+        self.assertTrue(all("imu" in kinds for kinds in due))
+        self.assertEqual(sum("gps" in kinds for kinds in due), 2)
+
+    def test_held_values_are_not_resent(self):
+        scheduler = SensorScheduler({"imu": 1000.0, "baro": 1000.0, "gps": 1000.0})
+        sampled = frozenset({"acc_z", "pres"})
+
+        lines = scheduler.lines(_packet(0.0), fresh=frozenset({"pres"}), sampled=sampled)
+
+        # The source never samples GPS, so it is still sent at its own rate.
+        self.assertEqual([line.split(",")[0] for line in lines], ["HITL/BARO/0.000", "HITL/GPS/0.000"])
+
+    def test_sensor_lines_split_the_combined_line(self):
+        packet = _packet(1.5)
+        combined = packet.to_hitl_string()[5:-1].split(",")
+        imu = packet.to_sensor_string("imu")[9:-1].split(",")
+        baro = packet.to_sensor_string("baro")[10:-1].split(",")
+        gps = packet.to_sensor_string("gps")[9:-1].split(",")
+
+        self.assertEqual(imu, combined[:10])
+        self.assertEqual(baro, combined[:1] + combined[10:12])
+        self.assertEqual(gps, combined[:1] + combined[12:])
+
+    def test_sample_freshness_is_found_through_wrappers(self):
+        class Merged:
+            fresh = frozenset({"acc_z"})
+            sampled = frozenset({"acc_z", "pres"})
+
+        wrapped = data_sources.RotatedSim.__new__(data_sources.RotatedSim)
+        wrapped.source = Merged()
+
+        self.assertEqual(session._sample_freshness(wrapped), (Merged.fresh, Merged.sampled))
+        self.assertEqual(session._sample_freshness(object()), (None, frozenset()))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -3,12 +3,45 @@ from __future__ import annotations
 import math
 import tempfile
 import unittest
+from collections import deque
 from pathlib import Path
 from types import SimpleNamespace
 from unittest import mock
 
+import numpy as np
+
 from astra_support.sim import data_sources
 from astra_support.sim import session
+from astra_support.sim.telemetry import frame_sequenced, split_sequence
+
+
+def _sitl_args(**overrides) -> SimpleNamespace:
+    values = dict(
+        mode="sitl",
+        host="localhost",
+        tcp_port=5555,
+        project=".",
+        source="airbrake",
+        no_auto_start=False,
+        sitl_exe=None,
+        sitl_log=None,
+        show_sitl_output=False,
+        build=False,
+        header_probe="CMD/HEADER\n",
+        ready_token="",
+        ready_probe="",
+        target_apogee=None,
+        no_plot=True,
+        rotate=False,
+        rotation=None,
+        noise=True,
+        accel_noise=0.05,
+        gyro_noise=0.01,
+        mag_noise=0.5,
+        baro_noise=0.5,
+    )
+    values.update(overrides)
+    return SimpleNamespace(**values)
 
 
 class SessionTests(unittest.TestCase):
@@ -17,30 +50,7 @@ class SessionTests(unittest.TestCase):
             def is_finished(self):
                 return True
 
-        args = SimpleNamespace(
-            mode="sitl",
-            host="localhost",
-            tcp_port=5555,
-            project=".",
-            source="airbrake",
-            no_auto_start=False,
-            sitl_exe=None,
-            sitl_log=None,
-            show_sitl_output=False,
-            build=False,
-            header_probe="CMD/HEADER\n",
-            ready_token="",
-            ready_probe="",
-            target_apogee=None,
-            no_plot=True,
-            rotate=False,
-            rotation=None,
-            noise=True,
-            accel_noise=0.05,
-            gyro_noise=0.01,
-            mag_noise=0.5,
-            baro_noise=0.5,
-        )
+        args = _sitl_args()
 
         with tempfile.TemporaryDirectory() as tmpdir:
             project_root = Path(tmpdir)
@@ -53,7 +63,7 @@ class SessionTests(unittest.TestCase):
                 mock.patch.object(session, "TCPLink"),
                 mock.patch.object(session, "_start_sitl_if_needed"),
                 mock.patch.object(session, "_handshake", return_value=({}, ["Time"])),
-                mock.patch.object(session, "write_sim_log"),
+                mock.patch.object(session, "SimLogWriter"),
                 mock.patch.object(session, "plot_history"),
                 mock.patch.object(session.time, "strftime", return_value="20260101_000000"),
                 mock.patch.object(session.data_sources, "NoisySim", side_effect=lambda sim, **_: sim) as noisy_sim,
@@ -62,6 +72,62 @@ class SessionTests(unittest.TestCase):
 
         noisy_sim.assert_called_once()
 
+    def test_lockstep_sends_one_sensor_line_per_reply(self):
+        def packet(timestamp):
+            return data_sources.PacketData(
+                timestamp, np.zeros(3), np.zeros(3), np.zeros(3), 1013.25, 20.0, 45.0, -75.0, 0.0, 1, 8, 0.0
+            )
+
+        class TwoPacketSim:
+            def __init__(self):
+                self.packets = deque([packet(0.0), packet(0.001)])
+
+            def is_finished(self):
+                return not self.packets
+
+            def get_next_packet(self):
+                return self.packets.popleft()
+
+        class ReplyPerLineLink:
+            def __init__(self):
+                self.sent: list[str] = []
+                self.replies: deque[str] = deque()
+
+            def send(self, data):
+                self.sent.append(data.decode("utf-8"))
+                self.replies.append(f"TELEM/S{len(self.sent)}")
+
+            def read_line(self, timeout=None):
+                return self.replies.popleft() if self.replies else ""
+
+            def wait_for_connection(self, **_):
+                pass
+
+            def close(self):
+                pass
+
+        link = ReplyPerLineLink()
+        args = _sitl_args(noise=False, sensor_rates="default", real_time=False, time_scale=1.0)
+        with tempfile.TemporaryDirectory() as tmpdir:
+            with (
+                mock.patch.object(session, "configure_console_output"),
+                mock.patch.object(session, "_build_native_if_requested"),
+                mock.patch.object(session, "load_custom_sim_hooks", return_value=(object(), None)),
+                mock.patch.object(session, "_create_custom_sim", return_value=TwoPacketSim()),
+                mock.patch.object(session, "TCPLink", return_value=link),
+                mock.patch.object(session, "_start_sitl_if_needed", return_value=None),
+                mock.patch.object(session, "_handshake", return_value=({"Stage": 0}, ["Stage"])),
+                mock.patch.object(session, "SimLogWriter") as log_writer,
+                mock.patch.object(session.time, "strftime", return_value="20260101_000000"),
+                mock.patch("builtins.print"),
+            ):
+                self.assertEqual(session.run_simulation(args, Path(tmpdir)), 0)
+
+        self.assertEqual([line.count("\n") for line in link.sent], [1, 1, 1, 1])
+        self.assertEqual([line.split("/")[1] for line in link.sent], ["IMU", "BARO", "GPS", "IMU"])
+        records = [call.args[0] for call in log_writer.return_value.append.call_args_list]
+        self.assertEqual([record["fc_stage"] for record in records], ["S3", "S4"])
+
     def test_apply_sim_wrappers_wraps_csv_source_with_noise(self):
         args = SimpleNamespace(
             source="airbrake.csv",
@@ -137,7 +203,7 @@ class SessionTests(unittest.TestCase):
                 mock.patch.object(session, "TCPLink", FakeTCPLink),
                 mock.patch.object(session, "_start_sitl_if_needed", side_effect=lambda *a, **k: events.append("start-sitl") or FakeSitl()),
                 mock.patch.object(session, "_handshake", return_value=({}, ["Time"])),
-                mock.patch.object(session, "write_sim_log"),
+                mock.patch.object(session, "SimLogWriter"),
                 mock.patch.object(session, "plot_history"),
                 mock.patch.object(session.time, "strftime", return_value="20260101_000000"),
             ):
@@ -200,3 +266,24 @@ class SessionTests(unittest.TestCase):
         record = session._record_packet(packet, {}, [])
 
         self.assertAlmostEqual(record["sensor_alt_agl_m"], 123.45, places=6)
+
+    def test_sequence_envelope_round_trips(self):
+        self.assertEqual(frame_sequenced("HITL/1.000\n", 42), "@42|HITL/1.000\n")
+        self.assertEqual(split_sequence("@42|TELEM/1.0,2"), (42, "TELEM/1.0,2"))
+        self.assertEqual(split_sequence("TELEM/1.0,2"), (None, "TELEM/1.0,2"))
+        self.assertEqual(split_sequence("@x|TELEM/1.0"), (None, "@x|TELEM/1.0"))
+
+    def test_match_responses_lockstep_pairs_oldest_packet(self):
+        in_flight = deque([(1, "p1")])
+        self.assertEqual(session._match_responses(in_flight, None, "TELEM/a", sequenced=False), [("p1", "TELEM/a")])
+        self.assertFalse(in_flight)
+
+    def test_match_responses_window_retires_skipped_packets_without_fc_fields(self):
+        in_flight = deque([(1, "p1"), (2, "p2"), (3, "p3"), (4, "p4")])
+
+        matched = session._match_responses(in_flight, 3, "TELEM/c", sequenced=True)
+
+        self.assertEqual(matched, [("p1", ""), ("p2", ""), ("p3", "TELEM/c")])
+        self.assertEqual(list(in_flight), [(4, "p4")])
+        self.assertEqual(session._match_responses(in_flight, 2, "TELEM/stale", sequenced=True), [])
+        self.assertEqual(session._match_responses(in_flight, None, "", sequenced=True), [("p4", "")])
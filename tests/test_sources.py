@@ -70,3 +70,60 @@ class SourceTests(unittest.TestCase):
 
         self.assertAlmostEqual(packet.alt, 500.0, places=6)
         self.assertAlmostEqual(data_sources.pressure_to_msl_altitude(packet.pressure), 100.0, places=6)
+
+    def _write_flight(self, tmpdir: str) -> Path:
+        csv_path = Path(tmpdir) / "flight.csv"
+        rows = ["time,altitude,accel_x,accel_y,accel_z,gyro_x,gyro_y,gyro_z"]
+        for index in range(500):
+            t = index * 0.01
+            rows.append(f"{t},{t * t * 10},{0.1 * index},0.2,9.81,0.01,{-0.02 * index},0.3")
+        csv_path.write_text("\n".join(rows) + "\n", encoding="utf-8")
+        return csv_path
+
+    def test_csv_blocks_match_packets(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            csv_path = self._write_flight(tmpdir)
+            by_packet = data_sources.CSVSim(str(csv_path), use_cache=False)
+            packets = [by_packet.get_next_packet() for _ in range(500)]
+            blocks = list(data_sources.read_blocks(data_sources.CSVSim(str(csv_path), use_cache=False), rows=128))
+
+        self.assertEqual([len(block) for block in blocks], [128, 128, 128, 116])
+        merged = data_sources.PacketBlock.concatenate(blocks)
+        self.assertEqual(merged.accel.shape, (500, 3))
+        for expected, actual in zip(packets, merged.packets()):
+            self.assertEqual(actual.to_hitl_string(), expected.to_hitl_string())
+            self.assertEqual(actual.truth_alt, expected.truth_alt)
+
+    def test_wrapped_blocks_match_wrapped_packets(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            csv_path = self._write_flight(tmpdir)
+
+            def wrapped():
+                source = data_sources.RotatedSim(data_sources.CSVSim(str(csv_path), use_cache=False), rotation_deg=[90, 0, 270])
+                return data_sources.NoisySim(source, seed=7)
+
+            by_packet = wrapped()
+            packets = [by_packet.get_next_packet() for _ in range(500)]
+            block = data_sources.PacketBlock.concatenate(data_sources.read_blocks(wrapped(), rows=300))
+
+        self.assertEqual(len(block), 500)
+        for index in (0, 299, 300, 499):
+            np.testing.assert_allclose(block.accel[index], packets[index].accel, atol=1e-12)
+            np.testing.assert_allclose(block.gyro[index], packets[index].gyro, atol=1e-12)
+            np.testing.assert_allclose(block.mag[index], packets[index].mag, atol=1e-12)
+            self.assertAlmostEqual(block.pressure[index], packets[index].pressure, places=9)
+
+    def test_monte_carlo_runs_are_reproducible_per_seed(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            csv_path = self._write_flight(tmpdir)
+
+            def create(seed):
+                return data_sources.NoisySim(data_sources.CSVSim(str(csv_path), use_cache=False), seed=seed)
+
+            runs = dict(data_sources.monte_carlo_runs(create, [1, 2, 1], rows=200))
+            again = dict(data_sources.monte_carlo_runs(create, [1], rows=64))
+
+        self.assertEqual(sorted(runs), [1, 2])
+        np.testing.assert_array_equal(runs[1].accel, again[1].accel)
+        self.assertFalse(np.array_equal(runs[1].accel, runs[2].accel))
+
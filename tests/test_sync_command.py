@@ -27,6 +27,8 @@ class SyncCommandTests(unittest.TestCase):
             self.assertEqual(exit_code, 0)
             self.assertTrue((root / ".astra-support.yml").exists())
             self.assertTrue((root / ".github" / "workflows" / "run_astra_support.yml").exists())
+            self.assertTrue((root / "scripts" / "astra_native_pch.py").exists())
+            self.assertIn("post:scripts/astra_native_pch.py", (root / "platformio.ini").read_text(encoding="utf-8"))
 
     def test_sync_appends_requested_platformio_env(self):
         with tempfile.TemporaryDirectory() as tmpdir:
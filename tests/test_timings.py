@@ -0,0 +1,45 @@
+from __future__ import annotations
+
+import tempfile
+import unittest
+from pathlib import Path
+
+from astra_support.testing.timings import TIMINGS_PATH, TimingHistory, balance_shards, longest_first
+
+
+class TimingTests(unittest.TestCase):
+    def test_history_round_trips_and_smooths(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            root = Path(tmpdir)
+            self.assertEqual(TimingHistory.load(root).entries, {})
+
+            history = TimingHistory.load(root)
+            history.record("test", "native", "test_nav", 10.0)
+            history.record("test", "native", "test_nav", 20.0)
+            history.save()
+
+            loaded = TimingHistory.load(root)
+            self.assertEqual(loaded.estimate("test", "native", "test_nav"), 15.0)
+            self.assertIsNone(loaded.estimate("test", "teensy41", "test_nav"))
+
+            (root / TIMINGS_PATH).write_text("not json", encoding="utf-8")
+            self.assertEqual(TimingHistory.load(root).entries, {})
+
+    def test_longest_first_puts_unknown_items_first(self):
+        known = {"test_a": 1.0, "test_b": 30.0, "test_c": 5.0}
+
+        ordered = longest_first(["test_a", "test_b", "test_c", "test_new", "test_d"], known.get)
+
+        self.assertEqual(ordered, ["test_d", "test_new", "test_b", "test_c", "test_a"])
+
+    def test_shards_balance_to_the_slowest_item(self):
+        known = {"slow": 40.0, "a": 10.0, "b": 10.0, "c": 10.0, "d": 10.0}
+
+        shards = balance_shards(known, known.get, 2)
+
+        self.assertEqual(shards, [["slow"], ["a", "b", "c", "d"]])
+        self.assertEqual(balance_shards(["x"], known.get, 4), [["x"]])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,48 @@
+from __future__ import annotations
+
+import socket
+import time
+import unittest
+
+from astra_support.sim.transport import TCPLink
+
+
+class TCPLinkTests(unittest.TestCase):
+    def setUp(self):
+        self.link = TCPLink(host="127.0.0.1", port=0, auto_accept=False)
+        self.addCleanup(self.link.close)
+        port = self.link.server.getsockname()[1]
+        self.client = socket.create_connection(("127.0.0.1", port), timeout=2.0)
+        self.addCleanup(self.client.close)
+        self.link.wait_for_connection(connect_timeout_s=2.0)
+
+    def test_drains_every_buffered_line_from_one_wakeup(self):
+        self.client.sendall(b"TELEM/1\nTELEM/2\r\nTELEM/3\npartial")
+
+        lines = [self.link.read_line(timeout=1.0) for _ in range(3)]
+
+        self.assertEqual(lines, ["TELEM/1", "TELEM/2", "TELEM/3"])
+        self.assertIsNone(self.link.read_line())
+        self.client.sendall(b" line\n")
+        self.assertEqual(self.link.read_line(timeout=1.0), "partial line")
+
+    def test_read_line_waits_until_data_or_deadline(self):
+        started = time.monotonic()
+        self.assertIsNone(self.link.read_line(timeout=0.05))
+        self.assertGreaterEqual(time.monotonic() - started, 0.05)
+
+        self.client.sendall(b"AB OK\n")
+        started = time.monotonic()
+        self.assertEqual(self.link.read_line(timeout=1.0), "AB OK")
+        self.assertLess(time.monotonic() - started, 0.5)
+
+    def test_peer_close_raises_after_queued_lines(self):
+        self.client.sendall(b"TELEM/last\n")
+        self.client.close()
+        self.assertEqual(self.link.read_line(timeout=1.0), "TELEM/last")
+        with self.assertRaises(ConnectionError):
+            self.link.read_line(timeout=1.0)
+
+
+if __name__ == "__main__":
+    unittest.main()